@@ -166,8 +166,11 @@ backend_client_rm(clicon_handle        h,
     ce_prev = &c0; /* this points to stack and is not real backpointer */
     for (c = *ce_prev; c; c = c->ce_next){
 	if (c == ce){
+	    if (ce->ce_conn){
+		clicon_conn_free(ce->ce_conn);
+		ce->ce_conn = NULL;
+	    }
 	    if (ce->ce_s){
-		event_unreg_fd(ce->ce_s, from_client);
 		close(ce->ce_s);
 		ce->ce_s = 0;
 	    }
@@ -198,22 +201,69 @@ netconf_db_find(cxobj *xn,
     return db;
 }
 
+/*! Get the subtree filter of a netconf get or get-config request
+ * @param[in]  xfilter  Filter element of request
+ * @retval     xfilter  Subtree filter, see xml_subtree_filter()
+ * @retval     NULL     Not a subtree filter, eg xpath
+ */
+static cxobj *
+netconf_filter_subtree(cxobj *xfilter)
+{
+    char *ftype;
+
+    if ((ftype = xml_find_value(xfilter, "type")) != NULL &&
+	strcmp(ftype, "subtree") == 0)
+	return xfilter;
+    return NULL;
+}
+
+/*! Start to print a reply directly to the reply message of a client
+ * What is in cbret, ie replies to earlier operations of the same message, is
+ * written to the sink first.
+ * @param[out] cbret Return xml value cligen buffer, reset
+ * @param[in]  cs    Output sink of reply message
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+from_client_reply_stream(cbuf        *cbret,
+			 clicon_sink *cs)
+{
+    if (cbuf_len(cbret)){
+	if (clicon_sink_write(cs, cbuf_get(cbret), cbuf_len(cbret)) < 0)
+	    return -1;
+	cbuf_reset(cbret);
+    }
+    return 0;
+}
+
 /*! Internal message: get-config
  * 
+ * The data is printed directly to the reply message, which is sent in chunks
+ * if large, without assembling it in memory.
+ * The filter is either an xpath (select attribute) or a subtree filter, which
+ * is also evaluated here so that only the matching content is sent.
  * @param[in]  h     Clicon handle
  * @param[in]  xe    Netconf request xml tree   
- * @param[out] cbret Return xml value cligen buffer
+ * @param[out] cbret Return xml value cligen buffer, for errors
+ * @param[in]  cs    Output sink of reply message
  */
 static int
 from_client_get_config(clicon_handle h,
 		       cxobj        *xe,
-		       cbuf         *cbret)
+		       cbuf         *cbret,
+		       clicon_sink  *cs)
 {
     int    retval = -1;
     char  *db;
     cxobj *xfilter;
+    cxobj *xsubtree = NULL;
     char  *selector = "/";
     cxobj *xret = NULL;
+    cxobj *xt = NULL;
+    cxobj **xvec = NULL;
+    size_t xlen;
+    int    ret;
     
     if ((db = netconf_db_find(xe, "source")) == NULL){
 	clicon_err(OE_XML, 0, "db not found");
@@ -229,10 +279,29 @@ from_client_get_config(clicon_handle h,
 	goto ok;
     }
 
-    if ((xfilter = xml_find(xe, "filter")) != NULL)
+    if ((xfilter = xml_find(xe, "filter")) != NULL &&
+	(xsubtree = netconf_filter_subtree(xfilter)) == NULL)
 	if ((selector = xml_find_value(xfilter, "select"))==NULL)
 	    selector="/";
-    if (xmldb_get(h, db, selector, 1, &xret) < 0){
+    /* Print directly from a snapshot of the datastore if it is in yang 
+     * order, otherwise get an ordered copy */
+    if (xml_child_sort){
+	if ((ret = xmldb_snapshot(h, db, &xt)) == 0){
+	    if (xsubtree)
+		ret = xml_subtree_filter(xt, xsubtree, clicon_dbspec_yang(h),
+					 &xvec, &xlen);
+	    else
+		ret = xpath_vec(xt, selector, &xvec, &xlen);
+	    if (ret < 0){
+		xmldb_release(h, db, xt);
+		xt = NULL;
+	    }
+	}
+    }
+    else if ((ret = xmldb_get(h, db, selector, 1, &xret)) == 0 && xsubtree)
+	ret = xml_subtree_filter(xret, xsubtree, clicon_dbspec_yang(h),
+				 &xvec, &xlen);
+    if (ret < 0){
 	cprintf(cbret, "<rpc-reply><rpc-error>"
 		"<error-tag>operation-failed</error-tag>"
 		"<error-type>application</error-type>"
@@ -241,19 +310,31 @@ from_client_get_config(clicon_handle h,
 		"</rpc-error></rpc-reply>");
 	goto ok;
     }
-    cprintf(cbret, "<rpc-reply>");
-    if (xret==NULL)
-	cprintf(cbret, "<data/>");
-    else{
-	if (xml_name_set(xret, "data") < 0)
-	    goto done;
-	if (clicon_xml2cbuf(cbret, xret, 0, 0) < 0)
-	    goto done;
-    }
-    cprintf(cbret, "</rpc-reply>");
+    if (xret != NULL && xml_name_set(xret, "data") < 0)
+	goto done;
+    if (from_client_reply_stream(cbret, cs) < 0 ||
+	clicon_sink_puts(cs, "<rpc-reply>") < 0)
+	ret = -1;
+    else if (xt != NULL)
+	ret = clicon_xml2sink_view(cs, xt, "data", xvec, xlen, 1, 0);
+    else if (xret==NULL)
+	ret = clicon_sink_puts(cs, "<data/>");
+    else if (xsubtree)
+	ret = clicon_xml2sink_view(cs, xret, "data", xvec, xlen, 1, 0);
+    else
+	ret = clicon_xml2sink(cs, xret, 0, 0);
+    if (ret == 0)
+	ret = clicon_sink_puts(cs, "</rpc-reply>");
+    /* Write errors are reported when the reply message is closed */
+    if (ret < 0 && clicon_sink_errno(cs) == 0)
+	goto done;
  ok:
     retval = 0;
  done:
+    if (xvec)
+	free(xvec);
+    if (xt)
+	xmldb_release(h, db, xt);
     if (xret)
 	xml_free(xret);
     return retval;
@@ -263,21 +344,27 @@ from_client_get_config(clicon_handle h,
  * 
  * @param[in]  h     Clicon handle
  * @param[in]  xe    Netconf request xml tree   
- * @param[out] cbret Return xml value cligen buffer
+ * @param[out] cbret Return xml value cligen buffer, for errors
+ * @param[in]  cs    Output sink of reply message
  * @see from_client_get_config
  */
 static int
 from_client_get(clicon_handle h,
 		cxobj        *xe,
-		cbuf         *cbret)
+		cbuf         *cbret,
+		clicon_sink  *cs)
 {
     int    retval = -1;
     cxobj *xfilter;
+    cxobj *xsubtree = NULL;
     char  *selector = "/";
     cxobj *xret = NULL;
+    cxobj **xvec = NULL;
+    size_t xlen;
     int    ret;
     
-    if ((xfilter = xml_find(xe, "filter")) != NULL)
+    if ((xfilter = xml_find(xe, "filter")) != NULL &&
+	(xsubtree = netconf_filter_subtree(xfilter)) == NULL)
 	if ((selector = xml_find_value(xfilter, "select"))==NULL)
 	    selector="/";
     /* Get config */
@@ -296,16 +383,33 @@ from_client_get(clicon_handle h,
     if ((ret = backend_statedata_call(h, selector, xret)) < 0)
 	goto done;
     if (ret == 0){ /* OK */
-	cprintf(cbret, "<rpc-reply>");
-	if (xret==NULL)
-	    cprintf(cbret, "<data/>");
-	else{
-	    if (xml_name_set(xret, "data") < 0)
-		goto done;
-	    if (clicon_xml2cbuf(cbret, xret, 0, 0) < 0)
-		goto done;
+	if (xret != NULL && xml_name_set(xret, "data") < 0)
+	    goto done;
+	if (xsubtree &&
+	    xml_subtree_filter(xret, xsubtree, clicon_dbspec_yang(h),
+			       &xvec, &xlen) < 0){
+	    cprintf(cbret, "<rpc-reply><rpc-error>"
+		    "<error-tag>operation-failed</error-tag>"
+		    "<error-type>application</error-type>"
+		    "<error-severity>error</error-severity>"
+		    "<error-info>read-registry</error-info>"
+		    "</rpc-error></rpc-reply>");
+	    goto ok;
 	}
-	cprintf(cbret, "</rpc-reply>");
+	if (from_client_reply_stream(cbret, cs) < 0 ||
+	    clicon_sink_puts(cs, "<rpc-reply>") < 0)
+	    ret = -1;
+	else if (xret==NULL)
+	    ret = clicon_sink_puts(cs, "<data/>");
+	else if (xsubtree)
+	    ret = clicon_xml2sink_view(cs, xret, "data", xvec, xlen, 0, 0);
+	else
+	    ret = clicon_xml2sink(cs, xret, 0, 0);
+	if (ret == 0)
+	    ret = clicon_sink_puts(cs, "</rpc-reply>");
+	/* Write errors are reported when the reply message is closed */
+	if (ret < 0 && clicon_sink_errno(cs) == 0)
+	    goto done;
     }
     else { /* 1 Error from callback */
 	cprintf(cbret, "<rpc-reply><rpc-error>"
@@ -319,6 +423,8 @@ from_client_get(clicon_handle h,
  ok:
     retval = 0;
  done:
+    if (xvec)
+	free(xvec);
     if (xret)
 	xml_free(xret);
     return retval;
@@ -905,6 +1011,7 @@ from_client_msg(clicon_handle        h,
     char                *name = NULL;
     char                *db;
     cbuf                *cbret = NULL; /* return message */
+    clicon_sink         *cs = NULL;    /* reply message, see cbret */
     int                  pid;
     int                  ret;
 
@@ -916,6 +1023,8 @@ from_client_msg(clicon_handle        h,
 	clicon_err(OE_XML, errno, "cbuf_new");
 	goto done;
     }
+    if ((cs = clicon_conn_sink(ce->ce_conn)) == NULL)
+	goto done;
     if (clicon_msg_decode(msg, &xt) < 0){
 	cprintf(cbret, "<rpc-reply><rpc-error>"
 		"<error-tag>operation-failed</error-tag>"
@@ -940,7 +1049,7 @@ from_client_msg(clicon_handle        h,
     while ((xe = xml_child_each(x, xe, CX_ELMNT)) != NULL) {
 	name = xml_name(xe);
 	if (strcmp(name, "get-config") == 0){
-	    if (from_client_get_config(h, xe, cbret) <0)
+	    if (from_client_get_config(h, xe, cbret, cs) <0)
 		goto done;
 	}
 	else if (strcmp(name, "edit-config") == 0){
@@ -964,7 +1073,7 @@ from_client_msg(clicon_handle        h,
 		goto done;
 	}
 	else if (strcmp(name, "get") == 0){
-	    if (from_client_get(h, xe, cbret) < 0)
+	    if (from_client_get(h, xe, cbret, cs) < 0)
 		goto done;
 	}
 	else if (strcmp(name, "close-session") == 0){
@@ -1028,7 +1137,7 @@ from_client_msg(clicon_handle        h,
 	}
     }
  reply:
-    if (cbuf_len(cbret) == 0)
+    if (cbuf_len(cbret) == 0 && clicon_sink_len(cs) == 0)
 	cprintf(cbret, "<rpc-reply><rpc-error>"
 		"<error-tag>operation-failed</error-tag>"
 		"<error-type>rpc</error-type>"
@@ -1036,7 +1145,12 @@ from_client_msg(clicon_handle        h,
 		"<error-message>Internal error %s</error-message>"
 		"</rpc-error></rpc-reply>",clicon_err_reason);
     clicon_debug(1, "%s cbret:%s", __FUNCTION__, cbuf_get(cbret));
-    if (send_msg_reply(ce->ce_s, cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
+    /* Send the reply, or the rest of it if it is streamed */
+    ret = clicon_sink_write(cs, cbuf_get(cbret), cbuf_len(cbret));
+    if (clicon_sink_close(cs) < 0)
+	ret = -1;
+    cs = NULL;
+    if (ret < 0){
 	switch (errno){
 	case EPIPE:
 	    /* man (2) write: 
@@ -1060,6 +1174,8 @@ from_client_msg(clicon_handle        h,
 	xml_free(xt);
     if (cbret)
 	cbuf_free(cbret);
+    if (cs)
+	clicon_sink_free(cs);
     /* Sanity: log if clicon_err() is not called ! */
     if (retval < 0 && clicon_errno < 0) 
 	clicon_log(LOG_NOTICE, "%s: Internal error: No clicon_err call on error (message: %s)",
@@ -1068,35 +1184,41 @@ from_client_msg(clicon_handle        h,
     return retval;// -1 here terminates backend
 }
 
-/*! An internal clicon message has arrived from a client. Receive and dispatch.
- * @param[in]   s    Socket where message arrived. read from this.
+/*! An internal clicon message has arrived from a client. Dispatch.
+ * @param[in]   cc   Connection to client, messages are received and replies
+ *                   sent without blocking, see clicon_conn_new
+ * @param[in]   msg  Message, freed by caller
  * @param[in]   arg  Client entry (from).
  * @retval      0    OK
  * @retval      -1   Error Terminates backend and is never called). Instead errors are
  *                   propagated back to client.
  */
 int
-from_client(int   s, 
-	    void* arg)
+from_client(clicon_conn       *cc,
+	    struct clicon_msg *msg,
+	    void              *arg)
 {
     int                  retval = -1;
-    struct clicon_msg   *msg = NULL;
     struct client_entry *ce = (struct client_entry *)arg;
     clicon_handle        h = ce->ce_handle;
-    int                  eof;
 
-    // assert(s == ce->ce_s);
-    if (clicon_msg_rcv(ce->ce_s, &msg, &eof) < 0)
+    if (from_client_msg(h, ce, msg) < 0)
 	goto done;
-    if (eof)
-	backend_client_rm(h, ce); 
-    else
-	if (from_client_msg(h, ce, msg) < 0)
-	    goto done;
     retval = 0;
   done:
     clicon_debug(1, "%s retval=%d", __FUNCTION__, retval);
-    if (msg)
-	free(msg);
     return retval; /* -1 here terminates backend */
 }
+
+/*! A client has closed its connection, or the connection has failed
+ * @param[in]   cc   Connection to client
+ * @param[in]   arg  Client entry (from).
+ */
+int
+from_client_close(clicon_conn *cc,
+		  void        *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+
+    return backend_client_rm(ce->ce_handle, ce);
+}
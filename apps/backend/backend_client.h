@@ -35,6 +35,13 @@
 #ifndef _BACKEND_CLIENT_H_
 #define _BACKEND_CLIENT_H_
 
+/*
+ * Constants
+ */
+/* Max notification output queued to a client. A subscriber that does not read
+ * its notifications is closed when more is queued. */
+#define CE_NOTIFY_MAX (16*1024*1024)
+
 /*
  * Types
  */ 
@@ -46,6 +53,7 @@ struct client_entry{
     struct client_entry   *ce_next;  /* The clients linked list */
     struct sockaddr        ce_addr;  /* The clients (UNIX domain) address */
     int                    ce_s;     /* stream socket to client */
+    clicon_conn           *ce_conn;  /* Non-blocking messages on ce_s */
     int                    ce_nr;    /* Client number (for dbg/tracing) */
     int                    ce_stat_in; /* Nr of received msgs from client */
     int                    ce_stat_out;/* Nr of sent msgs to client */
@@ -70,6 +78,7 @@ struct client_subscription{
  * Prototypes
  */ 
 int backend_client_rm(clicon_handle h, struct client_entry *ce);
-int from_client(int fd, void *arg);
+int from_client(clicon_conn *cc, struct clicon_msg *msg, void *arg);
+int from_client_close(clicon_conn *cc, void *arg);
 
 #endif  /* _BACKEND_CLIENT_H_ */
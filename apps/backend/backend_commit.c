@@ -79,23 +79,34 @@
  *    string regexp checked.
  * See also db_lv_set() where defaults are also filled in. The case here for defaults
  * are if code comes via XML/NETCONF.
- * @param   yspec   Yang spec
- * @param   td      Transaction data
+ * @param   yspec       Yang spec
+ * @param   td          Transaction data
+ * @param   incremental Differences computed from modified nodes only, source 
+ *                      is not re-validated
  */
 static int
 generic_validate(yang_spec          *yspec,
-		 transaction_data_t *td)
+		 transaction_data_t *td,
+		 int                 incremental)
 {
     int             retval = -1;
     cxobj          *x1;
     cxobj          *x2;
     yang_stmt      *ys;
     int             i;
+    struct leafref_index *li = NULL;
 
-    /* All entries */
-    if (xml_apply(td->td_target, CX_ELMNT, 
-		  (xml_applyfn_t*)xml_yang_validate_all, NULL) < 0)
+    /* Leafref targets are looked up in an index of the target tree, 
+     * instead of evaluating the path of each leafref */
+    if ((li = leafref_index_new()) == NULL)
 	goto done;
+    /* All entries. If entries were only added to an already validated source,
+     * no references elsewhere can break, so it is enough to check the added
+     * entries below. */
+    if (!incremental || td->td_dlen || td->td_clen)
+	if (xml_apply(td->td_target, CX_ELMNT, 
+		      (xml_applyfn_t*)xml_yang_validate_all, li) < 0)
+	    goto done;
 
     /* changed entries */
     for (i=0; i<td->td_clen; i++){
@@ -120,9 +131,15 @@ generic_validate(yang_spec          *yspec,
 	if (xml_apply0(x2, CX_ELMNT, 
 		      (xml_applyfn_t*)xml_yang_validate_add, NULL) < 0)
 	    goto done;
+	if (incremental && !td->td_dlen && !td->td_clen &&
+	    xml_apply0(x2, CX_ELMNT, 
+		       (xml_applyfn_t*)xml_yang_validate_all, li) < 0)
+	    goto done;
     }
     retval = 0;
  done:
+    if (li)
+	leafref_index_free(li);
     return retval;
 }
 
@@ -142,6 +159,7 @@ validate_common(clicon_handle       h,
     yang_spec  *yspec;
     int         i;
     cxobj      *xn;
+    cxobj      *xd = NULL; /* Modified nodes of candidate */
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
 	clicon_err(OE_FATAL, 0, "No DB_SPEC");
@@ -153,17 +171,22 @@ validate_common(clicon_handle       h,
     if (xmldb_get(h, candidate, "/", 1, &td->td_target) < 0)
 	goto done;
 
-    /* 3. Compute differences */
-    if (xml_diff(yspec, 
-		 td->td_src,
-		 td->td_target,
-		 &td->td_dvec,      /* removed: only in running */
-		 &td->td_dlen,
-		 &td->td_avec,      /* added: only in candidate */
-		 &td->td_alen,
-		 &td->td_scvec,     /* changed: original values */
-		 &td->td_tcvec,     /* changed: wanted values */
-		 &td->td_clen) < 0)
+    /* 3. Compute differences. If the datastore knows which nodes of the
+     * candidate have been modified since it was copied from running, only 
+     * compare those. Otherwise compare the complete trees */
+    if (xmldb_dirty(h, candidate, "running", &xd) < 0)
+	goto done;
+    if (xml_diff_dirty(yspec, 
+		       td->td_src,
+		       td->td_target,
+		       xd,                /* if NULL, full xml_diff */
+		       &td->td_dvec,      /* removed: only in running */
+		       &td->td_dlen,
+		       &td->td_avec,      /* added: only in candidate */
+		       &td->td_alen,
+		       &td->td_scvec,     /* changed: original values */
+		       &td->td_tcvec,     /* changed: wanted values */
+		       &td->td_clen) < 0)
 	goto done;
     if (debug>1)
 	transaction_print(stderr, td);
@@ -194,7 +217,7 @@ validate_common(clicon_handle       h,
 	goto done;
 
     /* 5. Make generic validation on all new or changed data. */
-    if (generic_validate(yspec, td) < 0)
+    if (generic_validate(yspec, td, xd != NULL) < 0)
 	goto done;
 
     /* 6. Call plugin transaction validate callbacks */
@@ -206,6 +229,8 @@ validate_common(clicon_handle       h,
 	goto done;
     retval = 0;
  done:
+    if (xd)
+	xml_free(xd);
     return retval;
 }
 
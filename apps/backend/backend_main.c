@@ -496,6 +496,7 @@ main(int argc, char **argv)
     char         *xmldb_plugin;
     int           xml_cache;
     int           xml_pretty;
+    int           xml_journal;
     char         *xml_format;
 
     /* In the startup, logs to stderr & syslog and debug flag set later */
@@ -703,6 +704,9 @@ main(int argc, char **argv)
     if ((xml_pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY")) >= 0)
 	if (xmldb_setopt(h, "pretty", (void*)(intptr_t)xml_pretty) < 0)
 	    goto done;
+    if ((xml_journal = clicon_option_bool(h, "CLICON_XMLDB_JOURNAL")) > 0)
+	if (xmldb_setopt(h, "journal", (void*)(intptr_t)xml_journal) < 0)
+	    goto done;
     /* If startup mode is not defined, eg via OPTION or -s, assume old method */
     startup_mode = clicon_startup_mode(h);
     if (startup_mode == -1){ 	
@@ -100,7 +100,7 @@ config_socket_init_ipv4(clicon_handle h, char *dst)
 	goto err;
     }
     clicon_debug(1, "Listen on server socket at %s:%hu", dst, port);
-    if (listen(s, 5) < 0){
+    if (listen(s, SOMAXCONN) < 0){
 	clicon_err(OE_UNIX, errno, "%s: listen", __FUNCTION__);
 	goto err;
     }
@@ -163,7 +163,7 @@ config_socket_init_unix(clicon_handle h, char *sock)
 	goto err;
     }
     clicon_debug(1, "Listen on server socket at %s", addr.sun_path);
-    if (listen(s, 5) < 0){
+    if (listen(s, SOMAXCONN) < 0){
 	clicon_err(OE_UNIX, errno, "%s: listen", __FUNCTION__);
 	goto err;
     }
@@ -263,9 +263,11 @@ backend_accept_client(int   fd,
     ce->ce_s = s;
 
     /*
-     * Here we register callbacks for actual data socket 
+     * Here we register callbacks for actual data socket. It is non-blocking
+     * so that a slow client does not block other clients.
      */
-    if (event_reg_fd(s, from_client, (void*)ce, "local netconf client socket") < 0)
+    if ((ce->ce_conn = clicon_conn_new(s, from_client, from_client_close, 
+				       (void*)ce)) == NULL)
 	goto done;
     retval = 0;
  done:
@@ -114,6 +114,30 @@ backend_handle_exit(clicon_handle h)
     return 0;
 }
 
+/*! Send a notification to a client without blocking
+ * The notification is queued if the client is not reading. A client with more
+ * than CE_NOTIFY_MAX queued is closed, instead of queuing without limit.
+ * @param[in]  ce      Client entry
+ * @param[in]  level   Event level
+ * @param[in]  event   Notification as text
+ * @retval     0       OK, sent or queued, or client is closed
+ * @retval    -1       Error
+ */
+static int
+backend_notify_client(struct client_entry *ce,
+		      int                  level,
+		      char                *event)
+{
+    if (ce->ce_conn == NULL)
+	return 0;
+    if (clicon_conn_outlen(ce->ce_conn) > CE_NOTIFY_MAX){
+	clicon_log(LOG_WARNING, "client %d does not read notifications, closing",
+		   ce->ce_nr);
+	return clicon_conn_shutdown(ce->ce_conn);
+    }
+    return clicon_conn_notify(ce->ce_conn, level, event);
+}
+
 /*! Notify event and distribute to all registered clients
  * 
  * @param[in]  h       Clicon handle
@@ -146,18 +170,10 @@ backend_notify(clicon_handle h,
 	for (su = ce->ce_subscription; su; su = su->su_next)
 	    if (strcmp(su->su_stream, stream) == 0){
 		if (strlen(su->su_filter)==0 || fnmatch(su->su_filter, event, 0) == 0){
-		    if (send_msg_notify(ce->ce_s, level, event) < 0){
+		    if (backend_notify_client(ce, level, event) < 0){
 			if (errno == ECONNRESET || errno == EPIPE){
+			    /* Client is removed when the close is handled */
 			    clicon_log(LOG_WARNING, "client %d reset", ce->ce_nr);
-#if 0
-			    /* We should remove here but removal is not possible
-			       from a client since backend_client is not linked.
-			       Maybe we should add it to the plugin, but it feels
-			       "safe" that you cant remove a client.
-			       Instead, the client is (hopefully) removed elsewhere?
-			    */
-			    backend_client_rm(h, ce);
-#endif
 			    break;
 			}
 			goto done;
@@ -224,18 +240,10 @@ backend_notify_xml(clicon_handle h,
 			if (clicon_xml2cbuf(cb, x, 0, 0) < 0)
 			    goto done;
 		    }
-		    if (send_msg_notify(ce->ce_s, level, cbuf_get(cb)) < 0){
+		    if (backend_notify_client(ce, level, cbuf_get(cb)) < 0){
 			if (errno == ECONNRESET || errno == EPIPE){
+			    /* Client is removed when the close is handled */
 			    clicon_log(LOG_WARNING, "client %d reset", ce->ce_nr);
-#if 0
-			    /* We should remove here but removal is not possible
-			       from a client since backend_client is not linked.
-			       Maybe we should add it to the plugin, but it feels
-			       "safe" that you cant remove a client.
-			       Instead, the client is (hopefully) removed elsewhere?
-			    */
-			    backend_client_rm(h, ce);
-#endif
 			    break;
 			}
 			goto done;
@@ -317,6 +325,8 @@ backend_client_delete(clicon_handle        h,
     for (c = *ce_prev; c; c = c->ce_next){
 	if (c == ce){
 	    *ce_prev = c->ce_next;
+	    if (ce->ce_conn)
+		clicon_conn_free(ce->ce_conn);
 	    free(ce);
 	    break;
 	}
@@ -631,6 +631,7 @@ compare_xmls(cxobj *xc1,
 }
 
 /*! Compare two dbs using XML. Write to file and run diff
+ * Equal dbs, as given by their hashes, are not written and compared.
  * @param[in]   h     Clicon handle
  * @param[in]   cvv  
  * @param[in]   arg   arg: 0 as xml, 1: as text
@@ -645,6 +646,10 @@ compare_dbs(clicon_handle h,
     cxobj *xerr;
     int    retval = -1;
     int    astext;
+    uint32_t id1;
+    uint32_t id2;
+    unsigned char hash1[XML_HASH_LEN];
+    unsigned char hash2[XML_HASH_LEN];
 
     if (cvec_len(argv) > 1){
 	clicon_err(OE_PLUGIN, 0, "%s: Requires 0 or 1 element. If given: astext flag 0|1", __FUNCTION__);
@@ -654,19 +659,27 @@ compare_dbs(clicon_handle h,
 	astext = cv_int32_get(cvec_i(argv, 0));
     else
 	astext = 0;
-    if (clicon_rpc_get_config(h, "running", "/", &xc1) < 0)
+    /* Send both requests before reading the replies */
+    if (clicon_rpc_get_config_send(h, "running", "/", &id1) < 0)
+	goto done;
+    if (clicon_rpc_get_config_send(h, "candidate", "/", &id2) < 0)
+	goto done;
+    if (clicon_rpc_get_config_rcv(h, id1, &xc1) < 0)
+	goto done;
+    if (clicon_rpc_get_config_rcv(h, id2, &xc2) < 0)
 	goto done;
     if ((xerr = xpath_first(xc1, "/rpc-error")) != NULL){
 	clicon_rpc_generate_error("Get configuration", xerr);
 	goto done;
     }
-    if (clicon_rpc_get_config(h, "candidate", "/", &xc2) < 0)
-	goto done;
     if ((xerr = xpath_first(xc2, "/rpc-error")) != NULL){
 	clicon_rpc_generate_error("Get configuration", xerr);
 	goto done;
     }
-    if (compare_xmls(xc1, xc2, astext) < 0) /* astext? */
+    if (xml_hash(xc1, hash1) < 0 || xml_hash(xc2, hash2) < 0)
+	goto done;
+    if (memcmp(hash1, hash2, XML_HASH_LEN) != 0 &&
+	compare_xmls(xc1, xc2, astext) < 0) /* astext? */
 	goto done;
     retval = 0;
   done:
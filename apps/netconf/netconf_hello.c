@@ -79,14 +79,26 @@
 #include "netconf_lib.h"
 #include "netconf_hello.h"
 
+/* NETCONF 1.1 capability, use chunked framing if both peers have it (RFC 6242) */
+#define NETCONF_BASE_1_1 "urn:ietf:params:netconf:base:1.1"
+
+/* Set if our hello advertising base:1.1 has been created */
+static int hello_base11 = 0;
+
 static int
 netconf_hello(cxobj *xn)
 {
     cxobj *x;
+    char  *body;
 
     x = NULL;
     while ((x = xpath_each(xn, "//capability", x)) != NULL) {
-	//fprintf(stderr, "cap: %s\n", xml_body(x));
+	if ((body = xml_body(x)) != NULL &&
+	    strcmp(body, NETCONF_BASE_1_1) == 0 && hello_base11){
+	    /* The messages following the hellos are chunked */
+	    clicon_debug(1, "%s: chunked framing", __FUNCTION__);
+	    netconf_framing = NETCONF_FRAMING_CHUNKED;
+	}
     }
     return 0;
 }
@@ -105,6 +117,8 @@ netconf_hello_dispatch(cxobj *xn)
 /*
  * netconf_create_hello
  * create capability string (once)
+ * The hello is sent with end-of-message framing. Chunked framing is used
+ * after it if the peer also has the base:1.1 capability.
  */
 int
 netconf_create_hello(cbuf *xf,            /* msg buffer */
@@ -116,6 +130,7 @@ netconf_create_hello(cbuf *xf,            /* msg buffer */
     cprintf(xf, "<hello>");
     cprintf(xf, "<capabilities>");
     cprintf(xf, "<capability>urn:ietf:params:xml:ns:netconf:base:1.0</capability>\n");
+    cprintf(xf, "<capability>%s</capability>\n", NETCONF_BASE_1_1);
     cprintf(xf, "<capability>urn:ietf:params:xml:ns:netconf:capability:candidate:1:0</capability>\n");
     cprintf(xf, "<capability>urn:ietf:params:xml:ns:netconf:capability:validate:1.0</capability>\n");
    cprintf(xf, "<capability>urn:ietf:params:netconf:capability:xpath:1.0</capability>\n");
@@ -125,5 +140,6 @@ netconf_create_hello(cbuf *xf,            /* msg buffer */
     cprintf(xf, "<session-id>%lu</session-id>", 42+session_id);
     cprintf(xf, "</hello>");
     add_postamble(xf);
+    hello_base11++;
     return retval;
 }
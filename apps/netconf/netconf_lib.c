@@ -50,6 +50,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <syslog.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -69,6 +70,7 @@
  * Exported variables
  */
 enum transport_type    transport = NETCONF_SSH; /* XXX Remove SOAP support */
+enum framing_type      netconf_framing = NETCONF_FRAMING_EOM; /* Set by hello */
 int cc_closed = 0; /* XXX Please remove (or at least hide in handle) this global variable */
 
 int
@@ -83,14 +85,16 @@ add_preamble(cbuf *xf)
 /* 
  * add_postamble
  * add netconf xml postamble of message. That is, xml after the body of the message.
- * for soap this is the envelope stuff, for ssh this is ]]>]]>
+ * for soap this is the envelope stuff, for ssh this is ]]>]]> unless chunked
+ * framing is used.
  */
 int
 add_postamble(cbuf *xf)
 {
     switch (transport){
-    case NETCONF_SSH:
-	cprintf(xf, "]]>]]>");     /* Add RFC4742 end-of-message marker */
+    case NETCONF_SSH: /* Chunked framing is added by netconf_output */
+	if (netconf_framing == NETCONF_FRAMING_EOM)
+	    cprintf(xf, "]]>]]>");     /* Add RFC4742 end-of-message marker */
 	break;
     case NETCONF_SOAP:
 	cprintf(xf, "\n</soapenv:Body>" "</soapenv:Envelope>");
@@ -173,7 +177,40 @@ netconf_get_target(cxobj        *xn,
     
 }
 
+/*! Write all of buffers on socket
+ * @param[in]   s    Socket
+ * @param[in]   iov  Buffers, modified
+ * @param[in]   n    Number of buffers
+ */
+static int
+netconf_writev(int           s,
+	       struct iovec *iov,
+	       int           n)
+{
+    ssize_t len;
+
+    while (n){
+	if ((len = writev(s, iov, n)) < 0){
+	    if (errno == EINTR)
+		continue;
+	    return -1;
+	}
+	while (n && len >= iov->iov_len){
+	    len -= iov->iov_len;
+	    iov++;
+	    n--;
+	}
+	if (n){
+	    iov->iov_base = (char*)iov->iov_base + len;
+	    iov->iov_len -= len;
+	}
+    }
+    return 0;
+}
+
 /*! Send netconf message from cbuf on socket
+ * With chunked framing (RFC 6242), the message is sent as one chunk, otherwise
+ * the message ends with the end-of-message marker, see add_postamble.
  * @param[in]   s    
  * @param[in]   cb   Cligen buffer that contains the XML message
  * @param[in]   msg  Only for debug
@@ -186,6 +223,9 @@ netconf_output(int   s,
     char *buf = cbuf_get(xf);
     int   len = cbuf_len(xf);
     int   retval = -1;
+    struct iovec iov[3];
+    int   n;
+    char  hdr[16];
 
     clicon_debug(1, "SEND %s", msg);
     if (debug > 1){ /* XXX: below only works to stderr, clicon_debug may log to syslog */
@@ -196,13 +236,32 @@ netconf_output(int   s,
 	    xml_free(xt);
 	}
     }
-    if (write(s, buf, len) < 0){
+    if (transport == NETCONF_SSH && 
+	netconf_framing == NETCONF_FRAMING_CHUNKED){
+	if (len == 0) /* Chunk size must be at least 1 */
+	    goto ok;
+	snprintf(hdr, sizeof(hdr), "\n#%d\n", len);
+	iov[0].iov_base = hdr;
+	iov[0].iov_len = strlen(hdr);
+	iov[1].iov_base = buf;
+	iov[1].iov_len = len;
+	iov[2].iov_base = "\n##\n";
+	iov[2].iov_len = strlen("\n##\n");
+	n = 3;
+    }
+    else{
+	iov[0].iov_base = buf;
+	iov[0].iov_len = len;
+	n = 1;
+    }
+    if (netconf_writev(s, iov, n) < 0){
 	if (errno == EPIPE)
 	    ;
 	else
 	    clicon_log(LOG_ERR, "%s: write: %s", __FUNCTION__, strerror(errno));
 	goto done;
     }
+ ok:
     retval = 0;
   done:
     return retval;
@@ -49,6 +49,12 @@ enum transport_type{
     NETCONF_SOAP,  /* RFC 4743 */
 };
 
+/* Message framing of NETCONF over SSH, RFC 6242 */
+enum framing_type{
+    NETCONF_FRAMING_EOM,     /* End-of-message marker ]]>]]> (base:1.0) */
+    NETCONF_FRAMING_CHUNKED, /* Chunked framing (base:1.1) */
+};
+
 enum test_option{ /* edit-config */
     SET,
     TEST_THEN_SET,
@@ -64,6 +70,7 @@ enum error_option{ /* edit-config */
  * Variables
  */ 
 extern enum transport_type transport;
+extern enum framing_type netconf_framing;
 extern int cc_closed;
 
 /*
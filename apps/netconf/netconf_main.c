@@ -73,47 +73,59 @@
 /* Command line options to be passed to getopt(3) */
 #define NETCONF_OPTS "hDqf:d:Sy:"
 
+/* Bytes to read from input at a time */
+#define NETCONF_READLEN 65536
+
+/* Input from client not yet processed, see netconf_input_cb
+ * Messages are framed in place in the buffer and handed to the parser without
+ * copying.
+ */
+static struct {
+    char   *ni_buf;
+    size_t  ni_len;  /* Received bytes in ni_buf */
+    size_t  ni_max;  /* Allocated size of ni_buf */
+    size_t  ni_off;  /* Start of current message */
+    size_t  ni_pos;  /* EOM: no end marker before this. Chunked: next chunk 
+			header */
+    size_t  ni_body; /* Chunked: end of chunk data, which is moved to ni_off */
+} ni = {NULL, 0, 0, 0, 0, 0};
+
 /*! Process incoming packet 
  * @param[in]   h    Clicon handle
- * @param[in]   cb   Packet buffer
+ * @param[in]   str  Message, may be modified
  */
 static int
 process_incoming_packet(clicon_handle h, 
-			cbuf         *cb)
+			char         *str)
 {
-    char  *str;
-    char  *str0;
     cxobj *xreq = NULL; /* Request (in) */
     int    isrpc = 0;   /* either hello or rpc */
     cbuf  *cbret = NULL;
     cxobj *xret = NULL; /* Return (out) */
+    char  *reply = NULL; /* Return (out) forwarded from backend as string */
     cxobj *xrpc;
     cxobj *xc;
+    cxobj *xa;
 
     clicon_debug(1, "RECV");
-    clicon_debug(2, "%s: RCV: \"%s\"", __FUNCTION__, cbuf_get(cb));
-    if ((str0 = strdup(cbuf_get(cb))) == NULL){
-	clicon_log(LOG_ERR, "%s: strdup: %s", __FUNCTION__, strerror(errno));
-	return -1;
-    }
-    str = str0;
+    clicon_debug(2, "%s: RCV: \"%s\"", __FUNCTION__, str);
     /* Parse incoming XML message */
     if (xml_parse_string(str, NULL, &xreq) < 0){ 
-	if ((cbret = cbuf_new()) == NULL){
+	if ((cbret = cbuf_new()) != NULL){
+	    add_preamble(cbret);
 	    cprintf(cbret, "<rpc-reply><rpc-error>"
 		"<error-tag>operation-failed</error-tag>"
 		"<error-type>rpc</error-type>"
 		"<error-severity>error</error-severity>"
 		"<error-message>internal error</error-message>"
 		"</rpc-error></rpc-reply>");
-	    netconf_output(1, cb, "rpc-error");
+	    add_postamble(cbret);
+	    netconf_output(1, cbret, "rpc-error");
 	}
 	else
 	    clicon_log(LOG_ERR, "%s: cbuf_new", __FUNCTION__);
-	free(str0);
 	goto done;
     }
-    free(str0);
     if ((xrpc=xpath_first(xreq, "//rpc")) != NULL)
         isrpc++;
     else
@@ -128,11 +140,33 @@ process_incoming_packet(clicon_handle h,
 	    goto done;
     }
     else  /* rpc */
-	if (netconf_rpc_dispatch(h, xrpc, &xret) < 0){
+	if (netconf_rpc_dispatch(h, xrpc, &xret, &reply) < 0){
 	    goto done;
 	}
+	else if (reply != NULL &&
+		 strncmp(reply, "<rpc-reply", strlen("<rpc-reply")) == 0 &&
+		 reply[strlen("<rpc-reply")] != '\0' &&
+		 strchr(" />", reply[strlen("<rpc-reply")]) != NULL){
+	    /* Reply from backend is sent as it is, only the attributes of the
+	     * rpc (eg message-id) are inserted in its start tag */
+	    if ((cbret = cbuf_new()) != NULL){
+		add_preamble(cbret);
+		cprintf(cbret, "<rpc-reply");
+		xa = NULL;
+		while ((xa = xml_child_each(xrpc, xa, CX_ATTR)) != NULL)
+		    if (clicon_xml2cbuf(cbret, xa, 0, 0) < 0)
+			goto done;
+		cprintf(cbret, "%s", reply + strlen("<rpc-reply"));
+		add_postamble(cbret);
+		if (netconf_output(1, cbret, "rpc-reply") < 0)
+		    goto done;
+	    }
+	}
 	else{ /* there is a return message in xret */
-	    cxobj *xa, *xa2;
+	    cxobj *xa2;
+
+	    if (reply != NULL && xml_parse_string(reply, NULL, &xret) < 0)
+		goto done;
 	    assert(xret);
 
 	    if ((cbret = cbuf_new()) != NULL){
@@ -160,17 +194,102 @@ process_incoming_packet(clicon_handle h,
 	xml_free(xreq);
     if (xret)
 	xml_free(xret);
+    if (reply)
+	free(reply);
     if (cbret)
 	cbuf_free(cbret);
     return 0;
 }
 
-/*! Get netconf message: detect end-of-msg 
+/*! Get next message from received input, RFC 6242 framing
+ * With end-of-message framing, the input is scanned for ]]>]]> with memchr from
+ * where the previous scan ended. With chunked framing, the chunk headers give
+ * the lengths and the chunk data is moved together in the buffer as chunks 
+ * arrive.
+ * @param[out]  str   Message, null-terminated in input buffer
+ * @retval      1     Message returned
+ * @retval      0     Message not complete, need more data
+ * @retval     -1     Framing error
+ */
+static int
+netconf_frame(char **str)
+{
+    char    *buf = ni.ni_buf;
+    char    *end = ni.ni_buf + ni.ni_len;
+    char    *p;
+    char    *p1;
+    char    *p2;
+    uint64_t size;
+
+    if (netconf_framing == NETCONF_FRAMING_EOM){
+	p = buf + ni.ni_pos;
+	while ((p = memchr(p, ']', end-p)) != NULL){
+	    if (end - p < 6) /* Possibly start of marker */
+		break;
+	    if (memcmp(p, "]]>]]>", 6) == 0){
+		*str = buf + ni.ni_off;
+		*p = '\0';
+		/* Skip NULL chars (eg from terminals) */
+		if ((p1 = memchr(*str, '\0', p - *str)) != NULL){
+		    for (p2 = p1; p1 < p; p1++)
+			if (*p1)
+			    *p2++ = *p1;
+		    *p2 = '\0';
+		}
+		ni.ni_off = ni.ni_pos = ni.ni_body = p - buf + 6;
+		return 1;
+	    }
+	    p++;
+	}
+	ni.ni_pos = (p ? p : end) - buf;
+	return 0;
+    }
+    /* Chunked: chunk = LF HASH chunk-size LF chunk-data, 
+       end-of-chunks = LF HASH HASH LF */
+    while (1){
+	p = buf + ni.ni_pos;
+	if (end - p < 4)
+	    return 0;
+	if (p[0] != '\n' || p[1] != '#')
+	    goto err;
+	if (p[2] == '#'){
+	    if (p[3] != '\n')
+		goto err;
+	    if (ni.ni_body == ni.ni_off) /* No chunks */
+		goto err;
+	    buf[ni.ni_body] = '\0'; /* Overwrites first byte of header or before */
+	    *str = buf + ni.ni_off;
+	    ni.ni_off = ni.ni_pos = ni.ni_body = p - buf + 4;
+	    return 1;
+	}
+	if (p[2] < '1' || p[2] > '9')
+	    goto err;
+	size = 0;
+	for (p1 = p+2; p1 < end && *p1 >= '0' && *p1 <= '9'; p1++){
+	    size = size*10 + (*p1 - '0');
+	    if (size > 4294967295U)
+		goto err;
+	}
+	if (p1 == end)
+	    return 0;
+	if (*p1++ != '\n')
+	    goto err;
+	if (end - p1 < size)
+	    return 0;
+	memmove(buf + ni.ni_body, p1, size);
+	ni.ni_body += size;
+	ni.ni_pos = p1 + size - buf;
+    }
+ err:
+    clicon_log(LOG_WARNING, "%s: invalid chunked framing", __FUNCTION__);
+    return -1;
+}
+
+/*! Get netconf messages from input
  * @param[in]   s    Socket where input arrived. read from this.
  * @param[in]   arg  Clicon handle.
- * This routine continuously reads until no more data on s. There could
- * be risk of starvation, but the netconf client does little else than
- * read data so I do not see a danger of true starvation here.
+ * Input is read into a buffer and the messages in it are processed. The rest of
+ * a message is read when the event loop calls again.
  */
 static int
 netconf_input_cb(int   s, 
@@ -178,61 +297,62 @@ netconf_input_cb(int   s,
 {
     int           retval = -1;
     clicon_handle h = arg;
-    unsigned char buf[BUFSIZ];
-    int           i;
-    int           len;
-    cbuf         *cb=NULL;
-    int           xml_state = 0;
-    int           poll;
-
-    if ((cb = cbuf_new()) == NULL){
-	clicon_err(OE_XML, errno, "%s: cbuf_new", __FUNCTION__);
-	return retval;
-    }
-    memset(buf, 0, sizeof(buf));
-    while (1){
-	if ((len = read(s, buf, sizeof(buf))) < 0){
-	    if (errno == ECONNRESET)
-		len = 0; /* emulate EOF */
-	    else{
-		clicon_log(LOG_ERR, "%s: read: %s", __FUNCTION__, strerror(errno));
-		goto done;
-	    }
-	} /* read */
-	if (len == 0){ 	/* EOF */
-	    cc_closed++;
-	    close(s);
-	    retval = 0;
+    char         *buf;
+    size_t        max;
+    ssize_t       len;
+    char         *str;
+    int           ret;
+
+    if (ni.ni_max - ni.ni_len < NETCONF_READLEN + 1){
+	max = ni.ni_max?ni.ni_max:NETCONF_READLEN;
+	while (max - ni.ni_len < NETCONF_READLEN + 1)
+	    max *= 2;
+	if ((buf = realloc(ni.ni_buf, max)) == NULL){
+	    clicon_err(OE_UNIX, errno, "realloc");
 	    goto done;
 	}
-
-	for (i=0; i<len; i++){
-	    if (buf[i] == 0)
-		continue; /* Skip NULL chars (eg from terminals) */
-	    cprintf(cb, "%c", buf[i]);
-	    if (detect_endtag("]]>]]>",
-			      buf[i],
-			      &xml_state)) {
-		/* OK, we have an xml string from a client */
-		/* Remove trailer */
-		*(((char*)cbuf_get(cb)) + cbuf_len(cb) - strlen("]]>]]>")) = '\0';
-		if (process_incoming_packet(h, cb) < 0)
-		    goto done;
-		if (cc_closed)
-		    break;
-		cbuf_reset(cb);
-	    }
+	ni.ni_buf = buf;
+	ni.ni_max = max;
+    }
+    if ((len = read(s, ni.ni_buf + ni.ni_len, NETCONF_READLEN)) < 0){
+	if (errno == ECONNRESET)
+	    len = 0; /* emulate EOF */
+	else if (errno == EINTR || errno == EAGAIN)
+	    goto ok;
+	else{
+	    clicon_log(LOG_ERR, "%s: read: %s", __FUNCTION__, strerror(errno));
+	    goto done;
 	}
-	/* poll==1 if more, poll==0 if none */
-	if ((poll = event_poll(s)) < 0)
+    } /* read */
+    if (len == 0){ 	/* EOF */
+	cc_closed++;
+	close(s);
+	goto ok;
+    }
+    ni.ni_len += len;
+    while ((ret = netconf_frame(&str)) == 1){
+	/* OK, we have an xml string from a client */
+	if (process_incoming_packet(h, str) < 0)
 	    goto done;
-	if (poll == 0)
-	    break; /* No data to read */
-    } /* while */
+	if (cc_closed)
+	    break;
+    }
+    if (ret < 0){ /* Session is closed on framing errors, RFC 6242 */
+	cc_closed++;
+	close(s);
+	goto ok;
+    }
+    /* Move rest of input to start of buffer */
+    if (ni.ni_off){
+	memmove(ni.ni_buf, ni.ni_buf + ni.ni_off, ni.ni_len - ni.ni_off);
+	ni.ni_len -= ni.ni_off;
+	ni.ni_pos -= ni.ni_off;
+	ni.ni_body -= ni.ni_off;
+	ni.ni_off = 0;
+    }
+ ok:
     retval = 0;
   done:
-    if (cb)
-	cbuf_free(cb);
     if (cc_closed) 
 	retval = -1;
     return retval;
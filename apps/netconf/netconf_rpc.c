@@ -64,7 +64,6 @@
 
 #include "clixon_netconf.h"
 #include "netconf_lib.h"
-#include "netconf_filter.h"
 #include "netconf_plugin.h"
 #include "netconf_rpc.h"
 
@@ -78,8 +77,9 @@
  * @param[in]  h       Clicon handle
  * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
  * @param[out] xret    Return XML, error or OK
- * @note filter type subtree and xpath is supported, but xpath is preferred, and
- *              better performance and tested. Please use xpath.
+ * @param[out] reply   Reply from backend as string, if forwarded. Free w free
+ * @note filter type subtree and xpath is supported. Both are evaluated by the
+ *       backend, so only the selected data is sent from it.
  *
  *     <get-config> 
  *	 <source> 
@@ -92,9 +92,7 @@
  *	   <candidate/> | <running/> 
  *	 </source> 
  *	 <filter type="subtree"> 
- *	     <configuration> 
- *		 <!- - tag elements for each configuration element to return - -> 
- *	     </configuration> 
+ *	     <!- - tag elements for each configuration element to return - -> 
  *	 </filter> 
  *     </get-config> 
  *
@@ -103,7 +101,7 @@
  *      <filter type="xpath" select="//SenderTwampIpv4"/>
  *    </get-config></rpc>]]>]]>
  * Variants of the functions where x-axis is the variants of the <filter> clause
- * and y-axis is whether a <filter><configuration> or <filter select=""> is present.
+ * and y-axis is whether filter content or <filter select=""> is present.
  *                  | no filter | filter subnet | filter xpath |
  * -----------------+-----------+---------------+--------------+
  * no config        |           |               |              |
@@ -118,21 +116,20 @@
  * filter xpath + select all:
      <rpc><get-config><source><candidate/></source><filter type="xpath" select="/"/></get-config></rpc>]]>]]>
  * filter subtree + config:
-     <rpc><get-config><source><candidate/></source><filter type="subtree"><configuration><interfaces><interface><ipv4><enabled/></ipv4></interface></interfaces></configuration></filter></get-config></rpc>]]>]]>
+     <rpc><get-config><source><candidate/></source><filter type="subtree"><interfaces><interface><ipv4><enabled/></ipv4></interface></interfaces></filter></get-config></rpc>]]>]]>
  * filter xpath + select:
      <rpc><get-config><source><candidate/></source><filter type="xpath" select="/interfaces/interface/ipv4"/></get-config></rpc>]]>]]>
  */
 static int
 netconf_get_config(clicon_handle h, 
 		   cxobj        *xn, 
-		   cxobj       **xret)
+		   cxobj       **xret,
+		   char        **reply)
 {
      cxobj      *xfilter; /* filter */
      int         retval = -1;
      char       *source;
      char       *ftype = NULL;
-     cxobj      *xfilterconf; 
-     cxobj      *xconf;
 
      if ((source = netconf_get_target(xn, "source")) == NULL){
 	 xml_parse_va(xret, NULL, "<rpc-reply><rpc-error>"
@@ -146,32 +143,13 @@ netconf_get_config(clicon_handle h,
      /* ie <filter>...</filter> */
      if ((xfilter = xpath_first(xn, "filter")) != NULL) 
 	 ftype = xml_find_value(xfilter, "type");
-     if (ftype == NULL || strcmp(ftype, "xpath")==0){
-	 if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
+     /* Both xpath and subtree filters are evaluated by the backend */
+     if (ftype == NULL || strcmp(ftype, "xpath")==0 ||
+	 strcmp(ftype, "subtree")==0){
+	 /* Reply is passed through as string, not parsed */
+	 if (clicon_rpc_netconf_xml_raw(h, xml_parent(xn), reply) < 0)
 	     goto done;	
      }
-     else if (strcmp(ftype, "subtree")==0){
-	 /* Default rfc filter is subtree. I prefer xpath and use it internally.
-	    Get whole subtree and then filter aftwerwards. This is suboptimal.
-	    Therefore please use xpath.
-	  */
-	 if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
-	     goto done;	
-	 if (xfilter &&
-	     (xfilterconf = xpath_first(xfilter, "//configuration"))!= NULL &&
-	     (xconf = xpath_first(*xret, "/rpc-reply/data")) != NULL){
-	     /* xml_filter removes parts of xml tree not matching */
-	     if ((strcmp(xml_name(xfilterconf), xml_name(xconf))!=0) ||
-		 xml_filter(xfilterconf, xconf) < 0){
-		     xml_parse_va(xret, NULL, "<rpc-reply><rpc-error>"
-				      "<error-tag>operation-failed</error-tag>"
-				      "<error-type>applicatio</error-type>"
-				      "<error-severity>error</error-severity>"
-				      "<error-info>filtering</error-info>"
-				      "</rpc-error></rpc-reply>");
-	     }
-	 }
-     }
      else{
 	 xml_parse_va(xret, NULL, "<rpc-reply><rpc-error>"
 			  "<error-tag>operation-failed</error-tag>"
@@ -528,8 +506,8 @@ netconf_unlock(clicon_handle h,
  * @param[in]  h       Clicon handle
  * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
  * @param[out] xret    Return XML, error or OK
- * @note filter type subtree and xpath is supported, but xpath is preferred, and
- *              better performance and tested. Please use xpath.
+ * @param[out] reply   Reply from backend as string, if forwarded. Free w free
+ * @note filter type subtree and xpath is supported, see netconf_get_config
  *
  * @example
  *    <rpc><get><filter type="xpath" select="//SenderTwampIpv4"/>
@@ -538,43 +516,23 @@ netconf_unlock(clicon_handle h,
 static int
 netconf_get(clicon_handle h, 
 	    cxobj        *xn, 
-	    cxobj       **xret)
+	    cxobj       **xret,
+	    char        **reply)
 {
      cxobj      *xfilter; /* filter */
      int         retval = -1;
      char       *ftype = NULL;
-     cxobj      *xfilterconf; 
-     cxobj      *xconf;
 
        /* ie <filter>...</filter> */
      if ((xfilter = xpath_first(xn, "filter")) != NULL) 
 	 ftype = xml_find_value(xfilter, "type");
-     if (ftype == NULL || strcmp(ftype, "xpath")==0){
-	 if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
+     /* Both xpath and subtree filters are evaluated by the backend */
+     if (ftype == NULL || strcmp(ftype, "xpath")==0 ||
+	 strcmp(ftype, "subtree")==0){
+	 /* Reply is passed through as string, not parsed */
+	 if (clicon_rpc_netconf_xml_raw(h, xml_parent(xn), reply) < 0)
 	     goto done;	
      }
-     else if (strcmp(ftype, "subtree")==0){
-	 /* Default rfc filter is subtree. I prefer xpath and use it internally.
-	    Get whole subtree and then filter aftwerwards. This is suboptimal.
-	    Therefore please use xpath.
-	  */
-	 if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
-	     goto done;	
-	 if (xfilter &&
-	     (xfilterconf = xpath_first(xfilter, "//configuration"))!= NULL &&
-	     (xconf = xpath_first(*xret, "/rpc-reply/data")) != NULL){
-	     /* xml_filter removes parts of xml tree not matching */
-	     if ((strcmp(xml_name(xfilterconf), xml_name(xconf))!=0) ||
-		 xml_filter(xfilterconf, xconf) < 0){
-		 xml_parse_va(xret, NULL, "<rpc-reply><rpc-error>"
-				      "<error-tag>operation-failed</error-tag>"
-				      "<error-type>applicatio</error-type>"
-				      "<error-severity>error</error-severity>"
-				      "<error-info>filtering</error-info>"
-				      "</rpc-error></rpc-reply>");
-	     }
-	 }
-     }
      else{
 	 xml_parse_va(xret, NULL, "<rpc-reply><rpc-error>"
 			  "<error-tag>operation-failed</error-tag>"
@@ -942,13 +900,17 @@ netconf_application_rpc(clicon_handle h,
  * @param[in]  h       clicon handle
  * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
  * @param[out] xret    Return XML, error or OK
+ * @param[out] reply   Reply from backend as string, instead of xret. Free w free
  * @retval     0       OK, can also be netconf error 
  * @retval    -1       Error, fatal
+ * @note Replies of get and get-config are forwarded from the backend as strings
+ *       in reply, without building a tree. Other replies are returned in xret.
  */
 int
 netconf_rpc_dispatch(clicon_handle h,
 		     cxobj        *xn, 
-		     cxobj       **xret)
+		     cxobj       **xret,
+		     char        **reply)
 {
     int         retval = -1;
     cxobj      *xe;
@@ -962,7 +924,7 @@ netconf_rpc_dispatch(clicon_handle h,
     xe = NULL;
     while ((xe = xml_child_each(xn, xe, CX_ELMNT)) != NULL) {
 	if (strcmp(xml_name(xe), "get-config") == 0){
-	    if (netconf_get_config(h, xe, xret) < 0)
+	    if (netconf_get_config(h, xe, xret, reply) < 0)
 		goto done;
 	}
 	else if (strcmp(xml_name(xe), "edit-config") == 0){
@@ -986,7 +948,7 @@ netconf_rpc_dispatch(clicon_handle h,
 		goto done;
 	}
 	else if (strcmp(xml_name(xe), "get") == 0){
-	    if (netconf_get(h, xe, xret) < 0)
+	    if (netconf_get(h, xe, xret, reply) < 0)
 		goto done;
 	}
 	else if (strcmp(xml_name(xe), "close-session") == 0){
@@ -43,6 +43,7 @@
 int 
 netconf_rpc_dispatch(clicon_handle h,
 		     cxobj        *xn, 
-		     cxobj       **xret);
+		     cxobj       **xret,
+		     char        **reply);
 
 #endif  /* _NETCONF_RPC_H_ */
@@ -281,6 +281,31 @@ clicon_debug_xml(int    dbglevel,
     return retval;
 }
 
+/*! Output sink callback writing to a fastcgi stream, see restconf_sink */
+static int
+restconf_sink_write(void  *arg,
+		    char  *buf,
+		    size_t len)
+{
+    if (FCGX_PutStr(buf, len, (FCGX_Stream*)arg) != len){
+	clicon_err(OE_CFG, errno, "FCGX_PutStr");
+	return -1;
+    }
+    return 0;
+}
+
+/*! Create an output sink writing to the reply of a fastcgi request
+ * Used to print a large reply, eg of a GET, without building it in memory.
+ * @param[in]  r    Fastcgi request handle
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ */
+clicon_sink *
+restconf_sink(FCGX_Request *r)
+{
+    return clicon_sink_fn(restconf_sink_write, r->out);
+}
+
 /*!
  * @param[in]  r        Fastcgi request handle
  */
@@ -55,6 +55,7 @@ int internal_server_error(FCGX_Request *r);
 int notimplemented(FCGX_Request *r);
 
 int clicon_debug_xml(int dbglevel, char *str, cxobj *cx);
+clicon_sink *restconf_sink(FCGX_Request *r);
 int test(FCGX_Request *r, int dbg);
 cbuf *readdata(FCGX_Request *r);
 
@@ -188,6 +188,28 @@ api_data_get_err(clicon_handle h,
     return retval;
 }
 
+/*! Check if an entity tag is in the If-None-Match field of a request
+ * @param[in]  match    If-None-Match field, eg "*" or a list of quoted tags
+ * @param[in]  etag     Hash of the reply, see api_data_get2()
+ * @param[in]  use_xml  Encoding of the reply is XML, otherwise JSON
+ * @retval     1        Match, also weak tags match as in RFC 7232
+ * @retval     0        No match
+ */
+static int
+api_data_etag_match(char *match,
+		    char *etag,
+		    int   use_xml)
+{
+    char tag[64];
+
+    while (*match == ' ')
+	match++;
+    if (strcmp(match, "*") == 0)
+	return 1;
+    snprintf(tag, sizeof(tag), "\"%s-%s\"", etag, use_xml?"xml":"json");
+    return strstr(match, tag) != NULL;
+}
+
 /*! Generic GET (both HEAD and GET)
  * According to restconf 
  * @param[in]  h      Clixon handle
@@ -210,6 +232,9 @@ api_data_get_err(clicon_handle h,
  * list or list object identifies more than one instance, and XML
  * encoding is used in the response, then an error response containing a
  * "400 Bad Request" status-line MUST be returned by the server.
+ * The response has a strong ETag, the SHA-1 of the reply of the backend and the
+ * encoding. If it matches If-None-Match of the request, "304 Not Modified" is
+ * returned without the data (RFC 8040 Section 3.4.1.2).
  * Netconf: <get-config>, <get>                        
  */
 static int
@@ -223,7 +248,7 @@ api_data_get2(clicon_handle h,
     int        retval = -1;
     cbuf      *cbpath = NULL;
     char      *path;
-    cbuf      *cbx = NULL;
+    clicon_sink *cs = NULL;
     yang_spec *yspec;
     cxobj     *xret = NULL;
     cxobj     *xerr;
@@ -234,6 +259,11 @@ api_data_get2(clicon_handle h,
     int        pretty;
     int        i;
     cxobj     *x;
+    char      *reply = NULL;
+    char      *data = NULL;
+    size_t     datalen = 0;
+    char      *etag = NULL;
+    char      *match;
 
     clicon_debug(1, "%s", __FUNCTION__);
     pretty = clicon_option_bool(h, "CLICON_RESTCONF_PRETTY");
@@ -252,42 +282,62 @@ api_data_get2(clicon_handle h,
     }
     path = cbuf_get(cbpath);
     clicon_debug(1, "%s path:%s", __FUNCTION__, path);
-    if (clicon_rpc_get(h, path, &xret) < 0){
+    if (clicon_rpc_get_raw(h, path, &reply) < 0){
 	notfound(r);
 	goto ok;
     }
-    /* We get return via netconf which is complete tree from root 
-     * We need to cut that tree to only the object.
+    clicon_debug(1, "%s reply:%s", __FUNCTION__, reply);
+    /* The data root in XML is the data of the reply as it is, so it is copied
+     * to the output without building a tree. Otherwise, or if the reply is an
+     * error, the reply is parsed.
      */
-#if 1 /* DEBUG */
-    {
-	cbuf *cb = cbuf_new();
-	clicon_xml2cbuf(cb, xret, 0, 0);
-	clicon_debug(1, "%s xret:%s", __FUNCTION__, cbuf_get(cb));
-	cbuf_free(cb);
-    }
-#endif
-    /* Check if error return */
-    if ((xerr = xpath_first(xret, "/rpc-error")) != NULL){
-	if (api_data_get_err(h, r, xerr) < 0)
-	    goto done;
-	goto ok;
+    if (!(use_xml && !pretty && (path==NULL || strcmp(path,"/")==0) &&
+	  clicon_rpc_reply_data(reply, &data, &datalen) == 1)){
+	data = NULL;
+	if (clicon_rpc_get_parse(h, reply, &xret) < 0){
+	    notfound(r);
+	    goto ok;
+	}
+	/* We get return via netconf which is complete tree from root 
+	 * We need to cut that tree to only the object.
+	 */
+	/* Check if error return */
+	if ((xerr = xpath_first(xret, "/rpc-error")) != NULL){
+	    if (api_data_get_err(h, r, xerr) < 0)
+		goto done;
+	    goto ok;
+	}
     }
     /* Normal return, no error */
-    if ((cbx = cbuf_new()) == NULL)
+    if ((etag = clicon_sha1hex(reply)) == NULL)
 	goto done;
+    if ((match = FCGX_GetParam("HTTP_IF_NONE_MATCH", r->envp)) != NULL &&
+	api_data_etag_match(match, etag, use_xml)){
+	FCGX_FPrintF(r->out, "Status: 304\r\n"); /* 304 not modified */
+	FCGX_FPrintF(r->out, "ETag: \"%s-%s\"\r\n", etag, use_xml?"xml":"json");
+	FCGX_FPrintF(r->out, "\r\n");
+	goto ok;
+    }
     FCGX_SetExitStatus(200, r->out); /* OK */
     FCGX_FPrintF(r->out, "Content-Type: application/yang-data+%s\r\n", use_xml?"xml":"json");
+    FCGX_FPrintF(r->out, "ETag: \"%s-%s\"\r\n", etag, use_xml?"xml":"json");
     FCGX_FPrintF(r->out, "\r\n");
     if (head)
 	goto ok;
-    if (path==NULL || strcmp(path,"/")==0){ /* Special case: data root */
+    /* Print reply directly to the fastcgi stream, not via an intermediate buffer */
+    if ((cs = restconf_sink(r)) == NULL)
+	goto done;
+    if (data != NULL){ /* Data root from reply string */
+	if (clicon_sink_write(cs, data, datalen) < 0)
+	    goto done;
+    }
+    else if (path==NULL || strcmp(path,"/")==0){ /* Special case: data root */
 	if (use_xml){
-	    if (clicon_xml2cbuf(cbx, xret, 0, pretty) < 0) /* Dont print top object?  */
+	    if (clicon_xml2sink(cs, xret, 0, pretty) < 0) /* Dont print top object?  */
 		goto done;
 	}
 	else{
-	    if (xml2json_cbuf(cbx, xret, pretty) < 0)
+	    if (xml2json_sink(cs, xret, pretty) < 0)
 		goto done;
 	}
     }
@@ -298,28 +348,34 @@ api_data_get2(clicon_handle h,
 	if (use_xml){
 	    for (i=0; i<xlen; i++){
 		x = xvec[i];
-		if (clicon_xml2cbuf(cbx, x, 0, pretty) < 0) /* Dont print top object?  */
+		if (clicon_xml2sink(cs, x, 0, pretty) < 0) /* Dont print top object?  */
 		    goto done;
 	    }
 	}
 	else
-	    if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty) < 0)
+	    if (xml2json_sink_vec(cs, xvec, xlen, pretty) < 0)
 		goto done;
     }
-
-    clicon_debug(1, "%s cbuf:%s", __FUNCTION__, cbuf_get(cbx));
-    FCGX_FPrintF(r->out, "%s", cbx?cbuf_get(cbx):"");
+    if (clicon_sink_close(cs) < 0){
+	cs = NULL;
+	goto done;
+    }
+    cs = NULL;
     FCGX_FPrintF(r->out, "\r\n\r\n");
  ok:
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
-    if (cbx)
-        cbuf_free(cbx);
+    if (cs)
+	clicon_sink_free(cs);
     if (cbpath)
 	cbuf_free(cbpath);
     if (xret)
 	xml_free(xret);
+    if (reply)
+	free(reply);
+    if (etag)
+	free(etag);
     if (xvec)
 	free(xvec);
     return retval;
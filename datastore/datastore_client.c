@@ -71,7 +71,7 @@ sudo ./datastore_client -d candidate -b /usr/local/var/routing -p /home/olof/src
 #include <clixon/clixon.h>
 
 /* Command line options to be passed to getopt(3) */
-#define DATASTORE_OPTS "hDd:p:b:y:m:"
+#define DATASTORE_OPTS "hDd:p:b:y:m:j"
 
 /*! usage
  */
@@ -87,6 +87,7 @@ usage(char *argv0)
 		"\t-p <plugin>\tDatastore plugin. Mandatory\n"
 		"\t-y <dir>\tYang directory (where modules are stored). Mandatory\n"
 		"\t-m <module>\tYang module. Mandatory\n"
+		"\t-j\t\tAppend edits to a journal (text plugin)\n"
 		"and command is either:\n"
 		"\tget [<xpath>]\n"
  	        "\tmget <nr> [<xpath>]\n"
@@ -124,6 +125,7 @@ main(int argc, char **argv)
     cxobj              *xt = NULL;
     int                 i;
     char               *xpath;
+    int                 journal = 0;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__PROGRAM__, LOG_INFO, CLICON_LOG_STDERR); 
@@ -167,6 +169,9 @@ main(int argc, char **argv)
 	        usage(argv0);
 	    yangmodule = optarg;
 	    break;
+	case 'j': /* journal */
+	    journal = 1;
+	    break;
 	}
     /* 
      * Logs, error and debug to stderr, set debug level
@@ -213,6 +218,8 @@ main(int argc, char **argv)
     /* Set yang spec option */
     if (xmldb_setopt(h, "yangspec", yspec) < 0)
 	goto done;
+    if (journal && xmldb_setopt(h, "journal", (void*)(intptr_t)journal) < 0)
+	goto done;
     if (strcmp(cmd, "get")==0){
 	if (argc != 1 && argc != 2)
 	    usage(argv0);
@@ -1058,7 +1058,7 @@ clixon_xmldb_plugin_init(int version)
 }
 
 static const struct xmldb_api api = {
-    1,
+    3,
     XMLDB_API_MAGIC,
     clixon_xmldb_plugin_init,
     kv_plugin_exit,
@@ -1076,6 +1076,9 @@ static const struct xmldb_api api = {
     kv_exists,
     kv_delete,
     kv_create,
+    NULL,         /* dirty: modifications not tracked */
+    NULL,         /* snapshot: no cache, xmldb_snapshot() reads a copy */
+    NULL,         /* release */
 };
 
 
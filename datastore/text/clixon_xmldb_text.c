@@ -72,6 +72,16 @@ valgrind --tool=callgrind datastore_client -d candidate -b /tmp/text -p ../datas
 
 #define handle(xh) (assert(text_handle_check(xh)==0),(struct text_handle *)(xh))
 
+/* Journal of edits of a database is stored in <dbfile> with this suffix */
+#define TEXT_JOURNAL_SUFFIX ".journal"
+
+/* First word of journal, see text_journal_append */
+#define TEXT_JOURNAL_MAGIC "clixon-journal"
+
+/* Journal is compacted into the database file when it is larger than both 
+   this and the database file */
+#define TEXT_JOURNAL_MIN 65536
+
 /* Magic to ensure plugin sanity. */
 #define TEXT_HANDLE_MAGIC 0x7f54da29
 
@@ -88,12 +98,32 @@ struct text_handle {
 				   Assumes single backend*/
     char          *th_format;   /* Datastroe format: xml / json */
     int            th_pretty;   /* Store xml/json pretty-printed. */
+    int            th_journal;  /* Append edits to a journal instead of 
+				   writing the complete database file */
+    struct text_detached *th_detached; /* Trees only kept for snapshots */
 };
 
-/* Struct per database in hash */
+/* Struct per database in hash
+ * A copy of a database shares the cached tree of the original, see text_copy.
+ * The tree is copied when one of the databases sharing it is modified, see
+ * text_db_unshare. */
 struct db_element{
     int    de_pid;
     cxobj *de_xml;
+    int    de_gen;      /* Incremented when de_xml is modified or replaced */
+    char  *de_base;     /* If set, de_xml is a copy of this db where nodes 
+			   modified since are marked with XML_FLAG_DIRTY */
+    int    de_basegen;  /* Generation of de_base when copied */
+    int    de_refs;     /* Snapshots held of de_xml, see text_snapshot */
+    int    de_marked;   /* XML_FLAG_DIRTY in de_xml are of modifications of
+			   this db, not of a db it was copied from */
+};
+
+/* Tree no longer (or never) in the cache but still held by snapshots */
+struct text_detached{
+    struct text_detached *dt_next;
+    cxobj                *dt_xml;
+    int                   dt_refs;  /* Snapshots held of dt_xml */
 };
 
 /*! Check struct magic number for sanity checks
@@ -108,6 +138,203 @@ text_handle_check(xmldb_handle xh)
     return th->th_magic == TEXT_HANDLE_MAGIC ? 0 : -1;
 }
 
+/*! Keep a tree for the snapshots held of it
+ * @param[in]  th    Text handle
+ * @param[in]  xt    Tree, freed when the last snapshot is released
+ * @param[in]  refs  Number of snapshots held of xt
+ * @see text_release
+ */
+static int
+text_detach(struct text_handle *th,
+	    cxobj              *xt,
+	    int                 refs)
+{
+    struct text_detached *dt;
+
+    if ((dt = malloc(sizeof(*dt))) == NULL){
+	clicon_err(OE_UNIX, errno, "malloc");
+	return -1;
+    }
+    memset(dt, 0, sizeof(*dt));
+    dt->dt_xml = xt;
+    dt->dt_refs = refs;
+    dt->dt_next = th->th_detached;
+    th->th_detached = dt;
+    return 0;
+}
+
+/*! Find a database with a cached xml tree
+ * @param[in]  th    Text handle
+ * @param[in]  xt    Cached xml tree
+ * @param[in]  skip  Database not to return, or NULL
+ * @param[in]  refs  If set, only return a database holding snapshots of xt
+ * @retval     de    Database element whose cached tree is xt
+ * @retval     NULL  Not found
+ */
+static struct db_element *
+text_db_find(struct text_handle *th,
+	     cxobj              *xt,
+	     struct db_element  *skip,
+	     int                 refs)
+{
+    struct db_element *de;
+    struct db_element *found = NULL;
+    char             **keys;
+    size_t             klen;
+    int                i;
+
+    if ((keys = hash_keys(th->th_dbs, &klen)) == NULL)
+	return NULL;
+    for (i = 0; i < klen; i++)
+	if ((de = hash_value(th->th_dbs, keys[i], NULL)) != NULL &&
+	    de != skip && de->de_xml == xt && (!refs || de->de_refs > 0)){
+	    found = de;
+	    break;
+	}
+    free(keys);
+    return found;
+}
+
+/*! Copy XML_FLAG_DIRTY and XML_FLAG_DEL of x0 to its copy x1
+ * Only children of nodes marked with XML_FLAG_DIRTY are visited.
+ * @param[in]  x0  Xml tree
+ * @param[in]  x1  Copy of x0 made with xml_copy(), with children in same order
+ */
+static int
+text_copy_dirty_flags(cxobj *x0,
+		      cxobj *x1)
+{
+    cxobj *xc0 = NULL;
+    cxobj *xc1 = NULL;
+
+    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DIRTY|XML_FLAG_DEL));
+    while ((xc0 = xml_child_each(x0, xc0, -1)) != NULL){
+	if ((xc1 = xml_child_each(x1, xc1, -1)) == NULL)
+	    break;
+	if (xml_flag(xc0, XML_FLAG_DIRTY))
+	    text_copy_dirty_flags(xc0, xc1);
+    }
+    return 0;
+}
+
+/*! Reset XML_FLAG_DIRTY and XML_FLAG_DEL of all nodes in a tree
+ * Only children of nodes marked with XML_FLAG_DIRTY are visited, since all
+ * ancestors of a modified node are marked.
+ */
+static int
+text_clear_dirty(cxobj *x)
+{
+    cxobj *xc = NULL;
+
+    if (!xml_flag(x, XML_FLAG_DIRTY))
+	return 0;
+    xml_flag_reset(x, XML_FLAG_DIRTY|XML_FLAG_DEL);
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+	text_clear_dirty(xc);
+    return 0;
+}
+
+/*! Let go of the cached xml tree of a database
+ * If another database shares the tree, it keeps it, and also the snapshots 
+ * held of it via this database. Otherwise, if snapshots are held of the tree,
+ * it is freed when they are released.
+ * @param[in]  th    Text handle
+ * @param[in]  de    Database element, de_xml is not changed
+ */
+static int
+text_db_drop(struct text_handle *th,
+	     struct db_element  *de)
+{
+    struct db_element *de2;
+
+    if ((de2 = text_db_find(th, de->de_xml, de, 0)) != NULL)
+	de2->de_refs += de->de_refs;
+    else if (de->de_refs){
+	if (text_detach(th, de->de_xml, de->de_refs) < 0)
+	    return -1;
+    }
+    else
+	xml_free(de->de_xml);
+    de->de_refs = 0;
+    return 0;
+}
+
+/*! Make cached xml tree of a database private before it is modified
+ * If the tree is shared with another database or snapshots are held of it,
+ * the database gets a copy. The copy keeps the modifications of the database
+ * marked with XML_FLAG_DIRTY, so that they are still tracked.
+ * This is the only place the cached tree of a database is copied: copying a
+ * database only shares it, see text_copy.
+ * @see text_put
+ */
+static int
+text_db_unshare(struct text_handle *th,
+		struct db_element  *de)
+{
+    cxobj *x0 = de->de_xml;
+    cxobj *x1;
+
+    if (x0 == NULL)
+	return 0;
+    if (de->de_refs == 0 && text_db_find(th, x0, de, 0) == NULL){
+	/* Private, but marks may be of a db it was copied from */
+	if (!de->de_marked)
+	    text_clear_dirty(x0);
+	de->de_marked = 1;
+	return 0;
+    }
+    if ((x1 = xml_new(xml_name(x0), NULL, xml_spec(x0))) == NULL)
+	return -1;
+    if (xml_copy(x0, x1) < 0 ||
+	(de->de_marked && text_copy_dirty_flags(x0, x1) < 0) ||
+	text_db_drop(th, de) < 0){
+	xml_free(x1);
+	return -1;
+    }
+    de->de_xml = x1;
+    de->de_marked = 1;
+    return 0;
+}
+
+/*! Free cached xml tree of a database, eg before it is replaced
+ * If the tree is shared with another database, or snapshots are held of it,
+ * it is kept for them, see text_db_drop.
+ */
+static int
+text_db_reset(struct text_handle *th,
+	      struct db_element  *de)
+{
+    if (de->de_xml != NULL){
+	if (text_db_drop(th, de) < 0)
+	    return -1;
+	de->de_xml = NULL;
+	de->de_marked = 0;
+    }
+    if (de->de_base != NULL){
+	free(de->de_base);
+	de->de_base = NULL;
+    }
+    de->de_gen++;
+    return 0;
+}
+
+/*! Mark node and its ancestors as modified since the db was copied
+ * @param[in]  x    Node added or changed, or parent of removed node
+ * @param[in]  del  If set, a child of x was removed
+ * @see text_dirty
+ */
+static int
+text_mark_dirty(cxobj *x,
+		int    del)
+{
+    if (del)
+	xml_flag_set(x, XML_FLAG_DEL);
+    /* If a node is dirty, so are all its ancestors */
+    for (; x != NULL && !xml_flag(x, XML_FLAG_DIRTY); x = xml_parent(x))
+	xml_flag_set(x, XML_FLAG_DIRTY);
+    return 0;
+}
+
 /*! Translate from symbolic database name to actual filename in file-system
  * @param[in]   th       text handle handle
  * @param[in]   db       Symbolic database name, eg "candidate", "running"
@@ -148,6 +375,158 @@ text_db2file(struct text_handle *th,
     return retval;
 }
 
+/*! Get name of a file related to a database file, eg its journal
+ * @param[in]  file    Database file
+ * @param[in]  suffix  Suffix, eg TEXT_JOURNAL_SUFFIX
+ * @retval     name    Filename. Free with free()
+ * @retval     NULL    Error
+ */
+static char *
+text_filename(const char *file,
+	      const char *suffix)
+{
+    char  *name;
+    size_t len;
+
+    len = strlen(file) + strlen(suffix) + 1;
+    if ((name = malloc(len)) == NULL){
+	clicon_err(OE_UNIX, errno, "malloc");
+	return NULL;
+    }
+    snprintf(name, len, "%s%s", file, suffix);
+    return name;
+}
+
+/*! Make renames and removals of database files durable
+ * @param[in]   th       text handle handle
+ */
+static int
+text_dbdir_sync(struct text_handle *th)
+{
+    int retval = -1;
+    int fd;
+
+    if ((fd = open(th->th_dbdir, O_RDONLY)) < 0){
+	clicon_err(OE_UNIX, errno, "open(%s)", th->th_dbdir);
+	goto done;
+    }
+    if (fsync(fd) < 0 && errno != EINVAL){
+	clicon_err(OE_UNIX, errno, "fsync(%s)", th->th_dbdir);
+	close(fd);
+	goto done;
+    }
+    close(fd);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Replace a database file with a temporary file and remove its journal
+ * The temporary file is synced to disk before it is renamed to the database
+ * file, so that the database file is either the old or the new version if
+ * the system crashes.
+ * @param[in]   th       text handle handle
+ * @param[in]   dbfile   Database file
+ * @param[in]   tmpfile  Complete new content of database file
+ */
+static int
+text_db_replace(struct text_handle *th,
+		const char         *dbfile,
+		const char         *tmpfile)
+{
+    int   retval = -1;
+    char *jfile = NULL;
+    int   fd;
+
+    if ((fd = open(tmpfile, O_RDONLY)) < 0){
+	clicon_err(OE_UNIX, errno, "open(%s)", tmpfile);
+	goto done;
+    }
+    if (fsync(fd) < 0){
+	clicon_err(OE_UNIX, errno, "fsync(%s)", tmpfile);
+	close(fd);
+	goto done;
+    }
+    close(fd);
+    if (rename(tmpfile, dbfile) < 0){
+	clicon_err(OE_UNIX, errno, "rename(%s, %s)", tmpfile, dbfile);
+	goto done;
+    }
+    /* The journal was of the replaced file */
+    if ((jfile = text_filename(dbfile, TEXT_JOURNAL_SUFFIX)) == NULL)
+	goto done;
+    if (unlink(jfile) < 0 && errno != ENOENT){
+	clicon_err(OE_UNIX, errno, "unlink(%s)", jfile);
+	goto done;
+    }
+    if (text_dbdir_sync(th) < 0)
+	goto done;
+    retval = 0;
+ done:
+    if (jfile)
+	free(jfile);
+    return retval;
+}
+
+/*! Write complete database file from an xml tree
+ * The file is written to a temporary file which then replaces the database
+ * file, see text_db_replace()
+ * @param[in]   th       text handle handle
+ * @param[in]   db       Symbolic database name, eg "candidate", "running"
+ * @param[in]   xt       XML tree: <config>...</config>
+ */
+static int
+text_writefile(struct text_handle *th, 
+	       const char         *db,
+	       cxobj              *xt)
+{
+    int         retval = -1;
+    char       *dbfile = NULL;
+    char       *tmpfile = NULL;
+    FILE       *f = NULL;
+    struct stat st;
+
+    if (text_db2file(th, db, &dbfile) < 0)
+	goto done;
+    if ((tmpfile = text_filename(dbfile, ".tmp")) == NULL)
+	goto done;
+    if ((f = fopen(tmpfile, "w")) == NULL){
+	clicon_err(OE_CFG, errno, "Creating file %s", tmpfile);
+	goto done;
+    } 
+    /* Keep mode of existing file */
+    if (stat(dbfile, &st) == 0 &&
+	fchmod(fileno(f), st.st_mode) < 0){
+	clicon_err(OE_UNIX, errno, "fchmod %s", tmpfile);
+	goto done;
+    }
+    if (strcmp(th->th_format,"json")==0){
+	if (xml2json(f, xt, th->th_pretty) < 0)
+	    goto done;
+    }
+    else if (clicon_xml2file(f, xt, 0, th->th_pretty) < 0)
+	goto done;
+    if (fclose(f) != 0){
+	f = NULL;
+	clicon_err(OE_UNIX, errno, "Writing file %s", tmpfile);
+	goto done;
+    }
+    f = NULL;
+    if (text_db_replace(th, dbfile, tmpfile) < 0)
+	goto done;
+    retval = 0;
+ done:
+    if (f != NULL)
+	fclose(f);
+    if (retval < 0 && tmpfile)
+	unlink(tmpfile);
+    if (tmpfile)
+	free(tmpfile);
+    if (dbfile)
+	free(dbfile);
+    return retval;
+}
+
 /*! Connect to a datastore plugin
  * @retval  handle  Use this handle for other API calls
  * @retval  NULL    Error
@@ -187,6 +566,8 @@ text_disconnect(xmldb_handle xh)
     int                 retval = -1;
     struct text_handle *th = handle(xh);
     struct db_element  *de;
+    struct db_element  *de2;
+    struct text_detached *dt;
     char              **keys = NULL;
     size_t              klen;
     int                 i;
@@ -200,14 +581,25 @@ text_disconnect(xmldb_handle xh)
 		    return 0;
 		for(i = 0; i < klen; i++) 
 		    if ((de = hash_value(th->th_dbs, keys[i], NULL)) != NULL){
-			if (de->de_xml)
+			if (de->de_xml){
+			    /* Free a tree shared by several dbs once */
+			    while ((de2 = text_db_find(th, de->de_xml, de, 0)) != NULL)
+				de2->de_xml = NULL;
 			    xml_free(de->de_xml);
+			}
+			if (de->de_base)
+			    free(de->de_base);
 		    }
 		if (keys)
 		    free(keys);
 	    }
 	    hash_free(th->th_dbs);
 	}
+	while ((dt = th->th_detached) != NULL){
+	    th->th_detached = dt->dt_next;
+	    xml_free(dt->dt_xml);
+	    free(dt);
+	}
 	free(th);
     }
     retval = 0;
@@ -240,6 +632,8 @@ text_getopt(xmldb_handle xh,
 	*value = th->th_format;
     else if (strcmp(optname, "pretty") == 0)
 	*value = &th->th_pretty;
+    else if (strcmp(optname, "journal") == 0)
+	*value = &th->th_journal;
     else{
 	clicon_err(OE_PLUGIN, 0, "Option %s not implemented by plugin", optname);
 	goto done;
@@ -251,7 +645,8 @@ text_getopt(xmldb_handle xh,
 
 /*! Set value of generic plugin option. Type of value is given by context
  * @param[in]  xh      XMLDB handle
- * @param[in]  optname Option name: yangspec, xml_cache, format, prettyprint
+ * @param[in]  optname Option name: yangspec, xml_cache, format, prettyprint,
+ *                     journal
  * @param[in]  value   Value of option
  * @retval     0       OK
  * @retval    -1       Error
@@ -288,6 +683,9 @@ text_setopt(xmldb_handle xh,
     else if (strcmp(optname, "pretty") == 0){
 	th->th_pretty = (intptr_t)value;
     }
+    else if (strcmp(optname, "journal") == 0){
+	th->th_journal = (intptr_t)value;
+    }
     else{
 	clicon_err(OE_PLUGIN, 0, "Option %s not implemented by plugin", optname);
 	goto done;
@@ -321,15 +719,11 @@ singleconfigroot(cxobj  *xt,
 	clicon_err(OE_DB, ENOENT, "Top-element is not unique, expecting single  config");
 	goto done;
     }
-    x = NULL;
-    while ((x = xml_child_each(xt, x,  CX_ELMNT)) != NULL){
-	if (xml_rm(x) < 0)
-	    goto done;
-	if (xml_free(xt) < 0)
-	    goto done;
-	*xp = x;
-	break;
-    }
+    for (i=0; i<xml_child_nr(xt); i++)
+	if (xml_type(xml_child_i(xt, i)) == CX_ELMNT)
+	    break;
+    if (xml_rootchild(xt, i, xp) < 0)
+	goto done;
     retval = 0;
  done:
     return retval;
@@ -407,6 +801,81 @@ xml_copy_marked(cxobj *x0,
     return retval;
 }
 
+static int text_journal_replay(struct text_handle *th, const char *dbfile,
+			       struct stat *st, cxobj *xt);
+
+/*! Read database file into an xml tree
+ * Edits in the journal of the database file are applied to the tree.
+ * @param[in]  th    Text handle
+ * @param[in]  db    Database
+ * @param[out] xtop  XML tree: <config>...</config>. Free with xml_free()
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+text_readfile(struct text_handle *th,
+	      const char         *db,
+	      cxobj             **xtop)
+{
+    int         retval = -1;
+    char       *dbfile = NULL;
+    int         fd = -1;
+    cxobj      *xt = NULL;
+    struct stat st;
+
+    if (text_db2file(th, db, &dbfile) < 0)
+	goto done;
+    if (dbfile==NULL){
+	clicon_err(OE_XML, 0, "dbfile NULL");
+	goto done;
+    }
+    if ((fd = open(dbfile, O_RDONLY)) < 0){
+	clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
+	goto done;
+    }    
+    /* A cached tree is edited for the lifetime of the handle and can not be 
+       allocated in an arena, see xml_new_arena() */
+    if (th->th_cache && (xt = xml_new("top", NULL, NULL)) == NULL)
+	goto done;
+    /* Parse file into XML tree */
+    if (strcmp(th->th_format,"json")==0){
+	if ((json_parse_file(fd, th->th_yangspec, &xt)) < 0)
+	    goto done;
+    }
+    else if ((xml_parse_file(fd, "</config>", th->th_yangspec, &xt)) < 0)
+	goto done;
+    /* Always assert a top-level called "config". 
+       To ensure that, deal with two cases:
+       1. File is empty <top/> -> rename top-level to "config" */
+    if (xml_child_nr(xt) == 0){ 
+	if (xml_name_set(xt, "config") < 0)
+	    goto done;     
+    }
+    /* 2. File is not empty <top><config>...</config></top> -> replace root */
+    else{ 
+	/* There should only be one element and called config */
+	if (singleconfigroot(xt, &xt) < 0)
+	    goto done;
+    }
+    if (fstat(fd, &st) < 0){
+	clicon_err(OE_UNIX, errno, "fstat(%s)", dbfile);
+	goto done;
+    }
+    if (text_journal_replay(th, dbfile, &st, xt) < 0)
+	goto done;
+    *xtop = xt;
+    xt = NULL;
+    retval = 0;
+ done:
+    if (xt)
+	xml_free(xt);
+    if (dbfile)
+	free(dbfile);
+    if (fd != -1)
+	close(fd);
+    return retval;
+}
+
 /*! Get content of database using xpath. return a set of matching sub-trees
  * The function returns a minimal tree that includes all sub-trees that match
  * xpath.
@@ -421,10 +890,8 @@ text_get(xmldb_handle xh,
 	 cxobj       **xtop)
 {
     int             retval = -1;
-    char           *dbfile = NULL;
     yang_spec      *yspec;
     cxobj          *xt = NULL;
-    int             fd = -1;
     cxobj         **xvec = NULL;
     size_t          xlen;
     int             i;
@@ -439,38 +906,8 @@ text_get(xmldb_handle xh,
 	if ((de = hash_value(th->th_dbs, db, NULL)) != NULL)
 	    xt = de->de_xml; 
     }
-    if (xt == NULL){
-	if (text_db2file(th, db, &dbfile) < 0)
-	    goto done;
-	if (dbfile==NULL){
-	    clicon_err(OE_XML, 0, "dbfile NULL");
-	    goto done;
-	}
-	if ((fd = open(dbfile, O_RDONLY)) < 0){
-	    clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
-	    goto done;
-	}    
-	/* Parse file into XML tree */
-	if (strcmp(th->th_format,"json")==0){
-	    if ((json_parse_file(fd, yspec, &xt)) < 0)
-		goto done;
-	}
-	else if ((xml_parse_file(fd, "</config>", yspec, &xt)) < 0)
-	    goto done;
-	/* Always assert a top-level called "config". 
-	   To ensure that, deal with two cases:
-	   1. File is empty <top/> -> rename top-level to "config" */
-	if (xml_child_nr(xt) == 0){ 
-	    if (xml_name_set(xt, "config") < 0)
-		goto done;     
-	}
-	/* 2. File is not empty <top><config>...</config></top> -> replace root */
-	else{ 
-	    /* There should only be one element and called config */
-	    if (singleconfigroot(xt, &xt) < 0)
-		goto done;
-	}
-    } /* xt == NULL */
+    if (xt == NULL && text_readfile(th, db, &xt) < 0)
+	goto done;
     /* Here xt looks like: <config>...</config> */
 
     if (xpath_vec(xt, xpath?xpath:"/", &xvec, &xlen) < 0)
@@ -492,19 +929,30 @@ text_get(xmldb_handle xh,
 	 * If cache was NULL, also write to datastore cache
 	 */
 	cxobj *x1;
+	cxobj *x;
 	struct db_element de0 = {0,};
 
 	if (de != NULL)
 	    de0 = *de;
 
 	x1 = xml_new(xml_name(xt), NULL, xml_spec(xt));
+	/* Copied subtrees get the hashes of the cached tree, which are updated
+	 * along the modified paths only. Then xml_diff() of two gets, eg at
+	 * validate, skips the unchanged subtrees. */
+	if (xml_hash(xt, NULL) < 0)
+	    goto done;
 	/* Copy everything that is marked */
 	if (xml_copy_marked(xt, x1) < 0)
 	    goto done;
-	if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
-	    goto done;
-	if (xml_apply(x1, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
-	    goto done;
+	/* Reset the marks along the paths to the matches only, the rest of
+	 * the cached tree is not marked, and the copy has no flags */
+	for (i=0; i<xlen; i++){
+	    xml_flag_reset(xvec[i], XML_FLAG_MARK);
+	    for (x = xml_parent(xvec[i]); 
+		 x != NULL && xml_flag(x, XML_FLAG_CHANGE);
+		 x = xml_parent(x))
+		xml_flag_reset(x, XML_FLAG_CHANGE);
+	}
 	if (de0.de_xml == NULL){
 	    de0.de_xml = xt;
 	    hash_add(th->th_dbs, db, &de0, sizeof(de0));
@@ -516,10 +964,10 @@ text_get(xmldb_handle xh,
 	if (!xml_flag(xt, XML_FLAG_MARK))
 	    if (xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) < 0)
 		goto done;
+	/* reset flag */
+	if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+	    goto done;
     }
-    /* reset flag */
-    if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
-	goto done;
     /* filter out state (operations) data if config not set. Mark all nodes
      that are not config data */
     if (config && xml_apply(xt, CX_ELMNT, xml_non_config_data, NULL) < 0)
@@ -545,12 +993,8 @@ text_get(xmldb_handle xh,
  done:
     if (xt)
 	xml_free(xt);
-    if (dbfile)
-	free(dbfile);
     if (xvec)
 	free(xvec);
-    if (fd != -1)
-	close(fd);
     return retval;
 }
 
@@ -604,6 +1048,7 @@ text_modify(cxobj              *x0,
 		//		int iamkey=0;
 		if ((x0 = xml_new(x1name, x0p, (yang_stmt*)y0)) == NULL)
 		    goto done;
+		text_mark_dirty(x0, 0);
 #if 0
 		/* If it is key I dont want to mark it */
 		if ((iamkey=yang_key_match(y0->yn_parent, x1name)) < 0)
@@ -625,8 +1070,11 @@ text_modify(cxobj              *x0,
 			goto done; 
 		    xml_type_set(x0b, CX_BODY);
 		}
-		if (xml_value_set(x0b, x1bstr) < 0)
-		    goto done;
+		if (xml_value(x0b) == NULL || strcmp(xml_value(x0b), x1bstr)){
+		    if (xml_value_set(x0b, x1bstr) < 0)
+			goto done;
+		    text_mark_dirty(x0, 0);
+		}
 	    }
 	    break;
 	case OP_DELETE:
@@ -637,6 +1085,7 @@ text_modify(cxobj              *x0,
 	case OP_REMOVE: /* fall thru */
 	    if (x0){
 		xml_purge(x0);
+		text_mark_dirty(x0p, 1);
 	    }
 	    break;
 	default:
@@ -653,6 +1102,7 @@ text_modify(cxobj              *x0,
 	case OP_REPLACE: /* fall thru */
 	    if (x0){
 		xml_purge(x0);
+		text_mark_dirty(x0p, 1);
 		x0 = NULL;
 	    }
 	case OP_MERGE:  /* fall thru */
@@ -664,16 +1114,23 @@ text_modify(cxobj              *x0,
 		    break;
 		if (x0){
 		    xml_purge(x0);
+		    text_mark_dirty(x0p, 1);
 		}
 		if ((x0 = xml_new(x1name, x0p, (yang_stmt*)y0)) == NULL)
 		    goto done;
 		if (xml_copy(x1, x0) < 0)
 		    goto done;
+		if (xml_apply0(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_set, 
+			       (void*)(XML_FLAG_DIRTY|XML_FLAG_DEL)) < 0)
+		    goto done;
+		text_mark_dirty(x0p, 0);
 		break;
 	    }
 	    if (x0==NULL){
 		if ((x0 = xml_new(x1name, x0p, (yang_stmt*)y0)) == NULL)
 		    goto done;
+		/* If it replaces a removed node, none of its children are kept */
+		text_mark_dirty(x0, 1);
 		if (op==OP_NONE)
 		    xml_flag_set(x0, XML_FLAG_NONE); /* Mark for potential deletion */
 	    }
@@ -714,8 +1171,10 @@ text_modify(cxobj              *x0,
 		goto done;
 	    }
 	case OP_REMOVE: /* fall thru */
-	    if (x0)
+	    if (x0){
 		xml_purge(x0);
+		text_mark_dirty(x0p, 1);
+	    }
 	    break;
 	default:
 	    break;
@@ -768,6 +1227,7 @@ text_modify_top(cxobj              *x0,
 		x0c = NULL;
 		while ((x0c = xml_child_each(x0, x0c, CX_ELMNT)) != NULL) 
 		    xml_purge(x0c);
+		text_mark_dirty(x0, 1);
 		break;
 	    default:
 		break;
@@ -831,116 +1291,332 @@ xml_container_presence(cxobj  *x,
     /* Mark node that is: container, have no children, dont have presence */
     if (y->ys_keyword == Y_CONTAINER && 
 	xml_child_nr(x)==0 &&
-	yang_find((yang_node*)y, Y_PRESENCE, NULL) == NULL)
+	yang_find((yang_node*)y, Y_PRESENCE, NULL) == NULL){
 	xml_flag_set(x, XML_FLAG_MARK); /* Mark, remove later */
+	if (xml_parent(x))
+	    text_mark_dirty(xml_parent(x), 1);
+    }
     retval = 0;
  done:
     return retval;
 }
 
-/*! Modify database provided an xml tree and an operation
- * This is a clixon datastore plugin of the the xmldb api
- * @see xmldb_put
+/*! Modify a database tree with a modification tree and an operation
+ * @param[in]  x0    Database tree: <config>...</config>
+ * @param[in]  x1    Modification tree: <config>...</config>
+ * @param[in]  yspec Yang spec
+ * @param[in]  op    Top-level operation
+ * @see text_put
  */
-int
-text_put(xmldb_handle        xh,
-	 const char         *db, 
-	 enum operation_type op,
-	 cxobj              *x1)
+static int
+text_put_tree(cxobj              *x0,
+	      cxobj              *x1,
+	      yang_spec          *yspec,
+	      enum operation_type op)
 {
-    int                 retval = -1;
-    struct text_handle *th = handle(xh);
-    char               *dbfile = NULL;
-    int                 fd = -1;
-    FILE               *f = NULL;
-    cbuf               *cb = NULL;
-    yang_spec          *yspec;
-    cxobj              *x0 = NULL;
-    struct db_element  *de = NULL;
-    
-    if ((yspec =  th->th_yangspec) == NULL){
-	clicon_err(OE_YANG, ENOENT, "No yang spec");
-	goto done;
-    }
-    if (x1 && strcmp(xml_name(x1),"config")!=0){
-	clicon_err(OE_XML, 0, "Top-level symbol of modification tree is %s, expected \"config\"",
-		   xml_name(x1));
+    int retval = -1;
+
+    /* Add yang specification backpointer to all XML nodes */
+    /* XXX: where is this created? Add yspec */
+    if (xml_apply(x1, CX_ELMNT, xml_spec_populate, yspec) < 0)
+       goto done;
+#if 0 /* debug */
+    if (xml_child_sort && xml_apply0(x1, -1, xml_sort_verify, NULL) < 0)
+	clicon_log(LOG_NOTICE, "%s: verify failed #1", __FUNCTION__);
+#endif
+    /* 
+     * Modify base tree x with modification x1. This is where the
+     * new tree is made.
+     */
+    if (text_modify_top(x0, x1, yspec, op) < 0)
+	goto done;
+
+    /* Remove NONE nodes if all subs recursively are also NONE */
+    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
+	goto done;
+    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, 
+		  (void*)XML_FLAG_NONE) < 0)
+	goto done;
+    /* Mark non-presence containers that do not have children */
+    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_container_presence, NULL) < 0)
+	goto done;
+    /* Remove (prune) nodes that are marked (non-presence containers w/o children) */
+    if (xml_tree_prune_flagged(x0, XML_FLAG_MARK, 1) < 0)
+	goto done;
+#if 0 /* debug */
+    if (xml_child_sort && xml_apply0(x0, -1, xml_sort_verify, NULL) < 0)
+	clicon_log(LOG_NOTICE, "%s: verify failed #3", __FUNCTION__);
+#endif
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Append an edit to the journal of a database
+ *
+ * The journal starts with a line identifying the database file that the 
+ * edits apply to, by device and inode: 
+ *   clixon-journal <dev> <ino>
+ * A new database file (see text_db_replace) thus invalidates the journal.
+ * Then follows one record per edit:
+ *   <len> <operation>
+ *   <xml>
+ * where <xml> is the modification tree given to text_put() of length <len>.
+ * @param[in]  th      Text handle
+ * @param[in]  db      Database
+ * @param[in]  op      Top-level operation
+ * @param[in]  cbx     Modification tree as xml
+ * @param[out] compact Set if the journal should be compacted into the 
+ *                     database file
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see text_journal_replay
+ */
+static int
+text_journal_append(struct text_handle *th,
+		    const char         *db,
+		    enum operation_type op,
+		    cbuf               *cbx,
+		    int                *compact)
+{
+    int         retval = -1;
+    char       *dbfile = NULL;
+    char       *jfile = NULL;
+    cbuf       *cb = NULL;
+    int         fd = -1;
+    struct stat st;
+    struct stat jst;
+
+    if (text_db2file(th, db, &dbfile) < 0)
+	goto done;
+    if ((jfile = text_filename(dbfile, TEXT_JOURNAL_SUFFIX)) == NULL)
+	goto done;
+    if (stat(dbfile, &st) < 0){
+	clicon_err(OE_UNIX, errno, "stat(%s)", dbfile);
+	goto done;
+    }
+    if ((fd = open(jfile, O_WRONLY|O_APPEND|O_CREAT, S_IRUSR|S_IWUSR)) < 0){
+	clicon_err(OE_UNIX, errno, "open(%s)", jfile);
+	goto done;
+    }
+    if (fstat(fd, &jst) < 0){
+	clicon_err(OE_UNIX, errno, "fstat(%s)", jfile);
+	goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+	clicon_err(OE_XML, errno, "cbuf_new");
 	goto done;
     }
-    if (th->th_cache){
-	if ((de = hash_value(th->th_dbs, db, NULL)) != NULL)
-	    x0 = de->de_xml; 
-    }
-    if (x0 == NULL){
-	if (text_db2file(th, db, &dbfile) < 0)
+    if (jst.st_size == 0)
+	cprintf(cb, "%s %ju %ju\n", TEXT_JOURNAL_MAGIC,
+		(uintmax_t)st.st_dev, (uintmax_t)st.st_ino);
+    cprintf(cb, "%d %s\n%s\n", cbuf_len(cbx), xml_operation2str(op),
+	    cbuf_get(cbx));
+    if (write(fd, cbuf_get(cb), cbuf_len(cb)) != cbuf_len(cb)){
+	clicon_err(OE_UNIX, errno, "write(%s)", jfile);
+	/* Remove partial record, later records would be appended after it */
+	if (ftruncate(fd, jst.st_size) < 0)
+	    clicon_log(LOG_ERR, "%s: ftruncate(%s): %s", 
+		       __FUNCTION__, jfile, strerror(errno));
+	goto done;
+    }
+    if (fsync(fd) < 0){
+	clicon_err(OE_UNIX, errno, "fsync(%s)", jfile);
+	goto done;
+    }
+    *compact = jst.st_size + cbuf_len(cb) > TEXT_JOURNAL_MIN &&
+	jst.st_size + cbuf_len(cb) > st.st_size;
+    retval = 0;
+ done:
+    if (fd != -1)
+	close(fd);
+    if (cb)
+	cbuf_free(cb);
+    if (jfile)
+	free(jfile);
+    if (dbfile)
+	free(dbfile);
+    return retval;
+}
+
+/*! Apply the edits in the journal of a database file to its xml tree
+ *
+ * A journal of another database file than the one read, eg if the backend
+ * was terminated after a new database file was written but before the 
+ * journal was removed, is removed. An incomplete record at the end, eg if
+ * the backend was terminated while writing it, is removed. A complete record
+ * that cannot be applied is an error, since the records after it may also 
+ * have been acknowledged.
+ * @param[in]  th      Text handle
+ * @param[in]  dbfile  Database file
+ * @param[in]  st      Status of database file when it was read
+ * @param[in]  xt      XML tree read from database file
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see text_journal_append
+ */
+static int
+text_journal_replay(struct text_handle *th,
+		    const char         *dbfile,
+		    struct stat        *st,
+		    cxobj              *xt)
+{
+    int                 retval = -1;
+    char               *jfile = NULL;
+    int                 fd = -1;
+    char               *buf = NULL;
+    size_t              len;
+    size_t              maplen = 0;
+    char               *p;
+    char               *end;
+    char               *nl;
+    char               *xstr;
+    unsigned long       xlen;
+    uintmax_t           dev;
+    uintmax_t           ino;
+    char                opstr[16];
+    enum operation_type op;
+    cxobj              *xtop = NULL;
+    cxobj              *x1;
+
+    if ((jfile = text_filename(dbfile, TEXT_JOURNAL_SUFFIX)) == NULL)
+	goto done;
+    if ((fd = open(jfile, O_RDONLY)) < 0){
+	if (errno == ENOENT)
+	    goto ok;
+	clicon_err(OE_UNIX, errno, "open(%s)", jfile);
+	goto done;
+    }
+    if (clicon_file_map(fd, NULL, &buf, &len, &maplen) < 0)
+	goto done;
+    end = buf + len;
+    if ((nl = memchr(buf, '\n', len)) == NULL ||
+	sscanf(buf, TEXT_JOURNAL_MAGIC " %ju %ju", &dev, &ino) != 2 ||
+	dev != (uintmax_t)st->st_dev || ino != (uintmax_t)st->st_ino){
+	clicon_debug(1, "%s: removing journal of other file", jfile);
+	if (unlink(jfile) < 0){
+	    clicon_err(OE_UNIX, errno, "unlink(%s)", jfile);
 	    goto done;
-	if (dbfile==NULL){
-	    clicon_err(OE_XML, 0, "dbfile NULL");
+	}
+	goto ok;
+    }
+    p = nl + 1;
+    while (p < end){
+	if ((nl = memchr(p, '\n', end - p)) == NULL)
+	    break; /* Incomplete */
+	*nl = '\0';
+	if (sscanf(p, "%lu %15s", &xlen, opstr) != 2 ||
+	    xml_operation(opstr, &op) < 0){
+	    clicon_err(OE_DB, 0, "%s: malformed record at offset %zu", 
+		       jfile, (size_t)(p - buf));
 	    goto done;
 	}
-	if ((fd = open(dbfile, O_RDONLY)) < 0) {
-	    clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
+	xstr = nl + 1;
+	if (end - xstr < xlen + 1)
+	    break; /* Incomplete */
+	if (xstr[xlen] != '\n'){
+	    clicon_err(OE_DB, 0, "%s: malformed record at offset %zu", 
+		       jfile, (size_t)(p - buf));
 	    goto done;
-	}    
-	/* Parse file into XML tree */
-	if (strcmp(th->th_format,"json")==0){
-	    if ((json_parse_file(fd, yspec, &x0)) < 0)
+	}
+	xstr[xlen] = '\0';
+	x1 = NULL;
+	if (xlen){
+	    if (xml_parse_string(xstr, th->th_yangspec, &xtop) < 0)
+		goto done;
+	    if ((x1 = xml_child_i(xtop, 0)) == NULL){
+		clicon_err(OE_DB, 0, "%s: empty record at offset %zu", 
+			   jfile, (size_t)(p - buf));
 		goto done;
+	    }
 	}
-	else if ((xml_parse_file(fd, "</config>", yspec, &x0)) < 0)
+	if (text_put_tree(xt, x1, th->th_yangspec, op) < 0)
 	    goto done;
-	/* Always assert a top-level called "config". 
-	   To ensure that, deal with two cases:
-	   1. File is empty <top/> -> rename top-level to "config" */
-	if (xml_child_nr(x0) == 0){ 
-	    if (xml_name_set(x0, "config") < 0)
-		goto done;     
+	if (xtop){
+	    xml_free(xtop);
+	    xtop = NULL;
 	}
-	/* 2. File is not empty <top><config>...</config></top> -> replace root */
-	else{ 
-	    /* There should only be one element and called config */
-	    if (singleconfigroot(x0, &x0) < 0)
-		goto done;
+	p = xstr + xlen + 1;
+    }
+    if (p < end){
+	clicon_log(LOG_WARNING, "%s: removing incomplete record at end of journal", jfile);
+	if (truncate(jfile, p - buf) < 0){
+	    clicon_err(OE_UNIX, errno, "truncate(%s)", jfile);
+	    goto done;
 	}
     }
+ ok:
+    retval = 0;
+ done:
+    if (xtop)
+	xml_free(xtop);
+    if (buf)
+	clicon_file_unmap(buf, maplen);
+    if (fd != -1)
+	close(fd);
+    if (jfile)
+	free(jfile);
+    return retval;
+}
+
+/*! Modify database provided an xml tree and an operation
+ * The database file is rewritten, or if the journal option is set, the edit
+ * is appended to the journal of the database.
+ * This is a clixon datastore plugin of the the xmldb api
+ * @see xmldb_put
+ */
+int
+text_put(xmldb_handle        xh,
+	 const char         *db, 
+	 enum operation_type op,
+	 cxobj              *x1)
+{
+    int                 retval = -1;
+    struct text_handle *th = handle(xh);
+    cbuf               *cb = NULL;
+    yang_spec          *yspec;
+    cxobj              *x0 = NULL;
+    struct db_element  *de = NULL;
+    int                 compact = 1;
+    
+    if ((yspec =  th->th_yangspec) == NULL){
+	clicon_err(OE_YANG, ENOENT, "No yang spec");
+	goto done;
+    }
+    if (x1 && strcmp(xml_name(x1),"config")!=0){
+	clicon_err(OE_XML, 0, "Top-level symbol of modification tree is %s, expected \"config\"",
+		   xml_name(x1));
+	goto done;
+    }
+    if (th->th_cache){
+	if ((de = hash_value(th->th_dbs, db, NULL)) != NULL)
+	    x0 = de->de_xml; 
+    }
+    if (x0 == NULL && text_readfile(th, db, &x0) < 0)
+	goto done;
+    /* Snapshots of the cached tree should not see the modification */
+    if (de != NULL && x0 == de->de_xml){
+	if (text_db_unshare(th, de) < 0)
+	    goto done;
+	x0 = de->de_xml;
+    }
     /* Here x0 looks like: <config>...</config> */
     if (strcmp(xml_name(x0),"config")!=0){
 	clicon_err(OE_XML, 0, "Top-level symbol is %s, expected \"config\"",
 		   xml_name(x0));
 	goto done;
     }
-
-    /* Add yang specification backpointer to all XML nodes */
-    /* XXX: where is this created? Add yspec */
-    if (xml_apply(x1, CX_ELMNT, xml_spec_populate, yspec) < 0)
-       goto done;
-#if 0 /* debug */
-    if (xml_child_sort && xml_apply0(x1, -1, xml_sort_verify, NULL) < 0)
-	clicon_log(LOG_NOTICE, "%s: verify failed #1", __FUNCTION__);
-#endif
-    /* 
-     * Modify base tree x with modification x1. This is where the
-     * new tree is made.
-     */
-    if (text_modify_top(x0, x1, yspec, op) < 0)
-	goto done;
-
-    /* Remove NONE nodes if all subs recursively are also NONE */
-    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
-	goto done;
-    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, 
-		  (void*)XML_FLAG_NONE) < 0)
-	goto done;
-    /* Mark non-presence containers that do not have children */
-    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_container_presence, NULL) < 0)
-	goto done;
-    /* Remove (prune) nodes that are marked (non-presence containers w/o children) */
-    if (xml_tree_prune_flagged(x0, XML_FLAG_MARK, 1) < 0)
+    /* Journal the edit as given, before x1 is used in the modification */
+    if (th->th_journal){
+	if ((cb = cbuf_new()) == NULL){
+	    clicon_err(OE_XML, errno, "cbuf_new");
+	    goto done;
+	}
+	if (x1 && clicon_xml2cbuf(cb, x1, 0, 0) < 0)
+	    goto done;
+    }
+    if (text_put_tree(x0, x1, yspec, op) < 0)
 	goto done;
-#if 0 /* debug */
-    if (xml_child_sort && xml_apply0(x0, -1, xml_sort_verify, NULL) < 0)
-	clicon_log(LOG_NOTICE, "%s: verify failed #3", __FUNCTION__);
-#endif
     /* Write back to datastore cache if first time */
     if (th->th_cache){
 	struct db_element de0 = {0,};
@@ -948,39 +1624,22 @@ text_put(xmldb_handle        xh,
 	    de0 = *de;
 	if (de0.de_xml == NULL){
 	    de0.de_xml = x0;
+	    de0.de_marked = 1;
 	    hash_add(th->th_dbs, db, &de0, sizeof(de0));
 	}
+	else
+	    de->de_gen++;
     }
-    if (dbfile == NULL){
-	if (text_db2file(th, db, &dbfile) < 0)
-	    goto done;
-	if (dbfile==NULL){
-	    clicon_err(OE_XML, 0, "dbfile NULL");
-	    goto done;
-	}
-    }
-    if (fd != -1){
-	close(fd);
-	fd = -1;
-    }
-    if ((f = fopen(dbfile, "w")) == NULL){
-	clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
-	goto done;
-    } 
-    if (strcmp(th->th_format,"json")==0){
-	if (xml2json(f, x0, th->th_pretty) < 0)
-	    goto done;
+    /* Append edit to journal, or (also if that fails) write complete file */
+    if (cb != NULL && text_journal_append(th, db, op, cb, &compact) < 0){
+	clicon_log(LOG_WARNING, "%s: %s, writing complete database", 
+		   __FUNCTION__, clicon_err_reason);
+	compact = 1;
     }
-    else if (clicon_xml2file(f, x0, 0, th->th_pretty) < 0)
+    if (compact && text_writefile(th, db, x0) < 0)
 	goto done;
     retval = 0;
  done:
-    if (f != NULL)
-	fclose(f);
-    if (dbfile)
-	free(dbfile);
-    if (fd != -1)
-	close(fd);
     if (cb)
 	cbuf_free(cb);
     if (!th->th_cache && x0)
@@ -989,6 +1648,8 @@ text_put(xmldb_handle        xh,
 }
 
 /*! Copy database from db1 to db2
+ * With cache, no xml tree is copied: "to" shares the cached tree of "from"
+ * until one of them is modified.
  * @param[in]  xh  XMLDB handle
  * @param[in]  from  Source database
  * @param[in]  to    Destination database
@@ -1004,34 +1665,36 @@ text_copy(xmldb_handle xh,
     struct text_handle *th = handle(xh);
     char               *fromfile = NULL;
     char               *tofile = NULL;
+    char               *jfile = NULL;
+    char               *tmpfile = NULL;
     struct db_element  *de = NULL;
     struct db_element  *de2 = NULL;
+    cxobj              *xfrom = NULL;
 
     /* XXX lock */
     if (th->th_cache){
 	/* 1. Free xml tree in "to"
 	 */
-	if ((de = hash_value(th->th_dbs, to, NULL)) != NULL){
-	    if (de->de_xml != NULL){
-		xml_free(de->de_xml);
-		de->de_xml = NULL;
-	    }
-	}
-	/* 2. Copy xml tree from "from" to "to" 
+	if ((de = hash_value(th->th_dbs, to, NULL)) != NULL)
+	    if (text_db_reset(th, de) < 0)
+		goto done;
+	/* 2. Share xml tree of "from" with "to", it is copied when one of 
+	 *    them is modified, see text_db_unshare
 	 * 2a) create "to" if it does not exist
+	 * 2b) from here on, track nodes in "to" modified relative to "from"
 	 */
 	if ((de2 = hash_value(th->th_dbs, from, NULL)) != NULL){
 	    if (de2->de_xml != NULL){
 		struct db_element de0 = {0,};
-		cxobj *x, *xcopy;
-		x = de2->de_xml;
 		if (de != NULL)
 		    de0 = *de;
-		if ((xcopy = xml_new(xml_name(x), NULL, xml_spec(x))) == NULL)
-		    goto done;
-		if (xml_copy(x, xcopy) < 0) 
+		de0.de_xml = de2->de_xml;
+		de0.de_marked = 0; /* Marks in the tree are of "from" */
+		if ((de0.de_base = strdup(from)) == NULL){
+		    clicon_err(OE_UNIX, errno, "strdup");
 		    goto done;
-		de0.de_xml = xcopy;
+		}
+		de0.de_basegen = de2->de_gen;
 		hash_add(th->th_dbs, to, &de0, sizeof(de0));
 	    }
 	}
@@ -1040,14 +1703,242 @@ text_copy(xmldb_handle xh,
 	goto done;
     if (text_db2file(th, to, &tofile) < 0)
 	goto done;
-    if (clicon_file_copy(fromfile, tofile) < 0)
+    if ((jfile = text_filename(fromfile, TEXT_JOURNAL_SUFFIX)) == NULL)
+	goto done;
+    if ((tmpfile = text_filename(tofile, ".tmp")) == NULL)
+	goto done;
+    /* Edits in the journal of "from" are not in its file: write it first */
+    if (access(jfile, F_OK) == 0){
+	if (de2 != NULL && de2->de_xml != NULL){
+	    if (text_writefile(th, from, de2->de_xml) < 0)
+		goto done;
+	}
+	else if (text_readfile(th, from, &xfrom) < 0 ||
+		 text_writefile(th, from, xfrom) < 0)
+	    goto done;
+    }
+    /* Copy to a temporary file (sharing data blocks with "from" if the 
+     * filesystem allows) that then replaces "to" */
+    if (clicon_file_copy(fromfile, tmpfile) < 0)
+	goto done;
+    if (text_db_replace(th, tofile, tmpfile) < 0)
 	goto done;
     retval = 0;
  done:
+    if (retval < 0 && tmpfile)
+	unlink(tmpfile);
+    if (xfrom)
+	xml_free(xfrom);
     if (fromfile)
 	free(fromfile);
     if (tofile)
 	free(tofile);
+    if (jfile)
+	free(jfile);
+    if (tmpfile)
+	free(tmpfile);
+    return retval;
+}
+
+/*! Copy nodes marked with XML_FLAG_DIRTY in x0 to x1
+ *
+ * Only what is needed to find the nodes in another tree is copied: names,
+ * bodies and list keys. XML_FLAG_DIRTY and XML_FLAG_DEL are kept.
+ * @see text_dirty
+ */
+static int
+xml_copy_dirty(cxobj *x0, 
+	       cxobj *x1)
+{
+    int        retval = -1;
+    cxobj     *x;
+    cxobj     *xcopy;
+    yang_stmt *yt;
+    int        iskey;
+
+    yt = xml_spec(x0); /* can be null */
+    x = NULL;
+    while ((x = xml_child_each(x0, x, -1)) != NULL) {
+	switch (xml_type(x)){
+	case CX_BODY:
+	    if ((xcopy = xml_new(xml_name(x), x1, NULL)) == NULL)
+		goto done;
+	    if (xml_copy(x, xcopy) < 0) 
+		goto done;
+	    break;
+	case CX_ELMNT:
+	    iskey = 0;
+	    if (yt && yt->ys_keyword == Y_LIST &&
+		(iskey = yang_key_match((yang_node*)yt, xml_name(x))) < 0)
+		goto done;
+	    if (!iskey && !xml_flag(x, XML_FLAG_DIRTY))
+		break;
+	    if ((xcopy = xml_new(xml_name(x), x1, xml_spec(x))) == NULL)
+		goto done;
+	    if (iskey){
+		if (xml_copy(x, xcopy) < 0) 
+		    goto done;
+		break;
+	    }
+	    xml_flag_set(xcopy, xml_flag(x, XML_FLAG_DIRTY|XML_FLAG_DEL));
+	    if (xml_copy_dirty(x, xcopy) < 0)
+		goto done;
+	    break;
+	default:
+	    break;
+	}
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get nodes of database modified since it was copied from base database
+ *
+ * Modifications are tracked in the datastore cache: text_copy() starts 
+ * tracking, and text_modify() marks nodes with XML_FLAG_DIRTY.
+ * This is a clixon datastore plugin of the the xmldb api
+ * @see xmldb_dirty
+ */
+int
+text_dirty(xmldb_handle xh,
+	   const char  *db,
+	   const char  *base,
+	   cxobj      **xdirty)
+{
+    int                 retval = -1;
+    struct text_handle *th = handle(xh);
+    struct db_element  *de;
+    struct db_element  *deb;
+    cxobj              *x0;
+    cxobj              *x1 = NULL;
+
+    *xdirty = NULL;
+    if (!th->th_cache)
+	goto ok;
+    if ((de = hash_value(th->th_dbs, db, NULL)) == NULL ||
+	(x0 = de->de_xml) == NULL ||
+	de->de_base == NULL || strcmp(de->de_base, base) != 0)
+	goto ok;
+    /* Base must be unmodified since the copy */
+    if ((deb = hash_value(th->th_dbs, base, NULL)) == NULL ||
+	deb->de_xml == NULL ||
+	deb->de_gen != de->de_basegen)
+	goto ok;
+    if ((x1 = xml_new(xml_name(x0), NULL, xml_spec(x0))) == NULL)
+	goto done;
+    /* Not modified since the copy if marks are not of db: empty top */
+    if (de->de_marked){
+	xml_flag_set(x1, xml_flag(x0, XML_FLAG_DIRTY|XML_FLAG_DEL));
+	if (xml_copy_dirty(x0, x1) < 0)
+	    goto done;
+    }
+    *xdirty = x1;
+    x1 = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (x1)
+	xml_free(x1);
+    return retval;
+}
+
+/*! Get a read-only snapshot of a database without copying it
+ *
+ * With cache, the snapshot is the cached tree itself. If the database is 
+ * modified or replaced while snapshots are held, the snapshots keep the old 
+ * tree, see text_db_unshare() and text_db_reset().
+ * Without cache, the database file is read into a tree only kept for the 
+ * snapshot.
+ * This is a clixon datastore plugin of the the xmldb api
+ * @see xmldb_snapshot
+ */
+int
+text_snapshot(xmldb_handle xh,
+	      const char  *db,
+	      cxobj      **xtop)
+{
+    int                 retval = -1;
+    struct text_handle *th = handle(xh);
+    struct db_element  *de = NULL;
+    struct db_element   de0 = {0,};
+    cxobj              *xt = NULL;
+
+    if (th->th_yangspec == NULL){
+	clicon_err(OE_YANG, ENOENT, "No yang spec");
+	goto done;
+    }
+    if (th->th_cache){
+	if ((de = hash_value(th->th_dbs, db, NULL)) != NULL &&
+	    de->de_xml != NULL){
+	    de->de_refs++;
+	    *xtop = de->de_xml;
+	    goto ok;
+	}
+    }
+    if (text_readfile(th, db, &xt) < 0)
+	goto done;
+    if (th->th_cache){
+	/* Write to datastore cache */
+	if (de != NULL)
+	    de0 = *de;
+	de0.de_xml = xt;
+	de0.de_refs = 1;
+	if (hash_add(th->th_dbs, db, &de0, sizeof(de0)) == NULL)
+	    goto done;
+    }
+    else if (text_detach(th, xt, 1) < 0)
+	goto done;
+    *xtop = xt;
+    xt = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+	xml_free(xt);
+    return retval;
+}
+
+/*! Release a snapshot of a database
+ * This is a clixon datastore plugin of the the xmldb api
+ * @see xmldb_release
+ */
+int
+text_release(xmldb_handle xh,
+	     const char  *db,
+	     cxobj       *xt)
+{
+    int                    retval = -1;
+    struct text_handle    *th = handle(xh);
+    struct db_element     *de;
+    struct text_detached  *dt;
+    struct text_detached **dtp;
+
+    if (th->th_cache){
+	/* The snapshots may have moved to a db sharing the tree, see text_db_drop */
+	if ((de = hash_value(th->th_dbs, db, NULL)) == NULL ||
+	    de->de_xml != xt || de->de_refs == 0)
+	    de = text_db_find(th, xt, NULL, 1);
+	if (de != NULL){
+	    de->de_refs--;
+	    goto ok;
+	}
+    }
+    for (dtp = &th->th_detached; (dt = *dtp) != NULL; dtp = &dt->dt_next)
+	if (dt->dt_xml == xt)
+	    break;
+    if (dt == NULL){
+	clicon_err(OE_DB, 0, "Not a snapshot of %s", db);
+	goto done;
+    }
+    if (--dt->dt_refs == 0){
+	*dtp = dt->dt_next;
+	xml_free(dt->dt_xml);
+	free(dt);
+    }
+ ok:
+    retval = 0;
+ done:
     return retval;
 }
 
@@ -1186,18 +2077,15 @@ text_delete(xmldb_handle xh,
 {
     int                 retval = -1;
     char               *filename = NULL;
+    char               *jfile = NULL;
     struct text_handle *th = handle(xh);
     struct db_element  *de = NULL;
-    cxobj              *xt = NULL;
     struct stat         sb;
     
     if (th->th_cache){
-	if ((de = hash_value(th->th_dbs, db, NULL)) != NULL){
-	    if ((xt = de->de_xml) != NULL){
-		xml_free(xt);
-		de->de_xml = NULL;
-	    }
-	}
+	if ((de = hash_value(th->th_dbs, db, NULL)) != NULL)
+	    if (text_db_reset(th, de) < 0)
+		goto done;
     }
     if (text_db2file(th, db, &filename) < 0)
 	goto done;
@@ -1206,10 +2094,18 @@ text_delete(xmldb_handle xh,
 	    clicon_err(OE_DB, errno, "unlink %s", filename);
 	    goto done;
 	}
+    if ((jfile = text_filename(filename, TEXT_JOURNAL_SUFFIX)) == NULL)
+	goto done;
+    if (unlink(jfile) < 0 && errno != ENOENT){
+	clicon_err(OE_DB, errno, "unlink %s", jfile);
+	goto done;
+    }
     retval = 0;
  done:
     if (filename)
 	free(filename);
+    if (jfile)
+	free(jfile);
     return retval;
 }
 
@@ -1235,9 +2131,9 @@ text_create(xmldb_handle xh,
 	if ((de = hash_value(th->th_dbs, db, NULL)) != NULL){
 	    if ((xt = de->de_xml) != NULL){
 		assert(xt==NULL); /* XXX */
-		xml_free(xt);
-		de->de_xml = NULL;
 	    }
+	    if (text_db_reset(th, de) < 0)
+		goto done;
 	}
     }
     if (text_db2file(th, db, &filename) < 0)
@@ -1280,7 +2176,7 @@ clixon_xmldb_plugin_init(int version)
 }
 
 static const struct xmldb_api api = {
-    1,
+    3,
     XMLDB_API_MAGIC,
     clixon_xmldb_plugin_init,
     text_plugin_exit,
@@ -1298,6 +2194,9 @@ static const struct xmldb_api api = {
     text_exists,
     text_delete,
     text_create,
+    text_dirty,
+    text_snapshot,
+    text_release,
 };
 
 
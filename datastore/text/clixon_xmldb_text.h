@@ -49,5 +49,8 @@ int text_unlock_all(xmldb_handle h, int pid);
 int text_islocked(xmldb_handle h, const char *db);
 int text_exists(xmldb_handle h, const char *db);
 int text_delete(xmldb_handle h, const char *db);
+int text_dirty(xmldb_handle h, const char *db, const char *base, cxobj **xdirty);
+int text_snapshot(xmldb_handle h, const char *db, cxobj **xt);
+int text_release(xmldb_handle h, const char *db, cxobj *xt);
 
 #endif /* _CLIXON_XMLDB_TEXT_H */
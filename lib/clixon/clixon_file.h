@@ -42,6 +42,10 @@ int clicon_file_dirent(const char *dir, struct dirent **ent,
 
 int clicon_file_copy(char *src, char *target);
 
+int clicon_file_map(int fd, char *endtag, char **bufp, size_t *lenp, size_t *maplenp);
+
+int clicon_file_unmap(char *buf, size_t maplen);
+
 int group_name2gid(char *name, gid_t *gid);
 
 #endif /* _CLIXON_FILE_H_ */
@@ -41,6 +41,8 @@
  */
 int xml2json_cbuf(cbuf *cb, cxobj *x, int pretty);
 int xml2json_cbuf_vec(cbuf *cb, cxobj **vec, size_t veclen, int pretty);
+int xml2json_sink(struct clicon_sink *cs, cxobj *x, int pretty);
+int xml2json_sink_vec(struct clicon_sink *cs, cxobj **vec, size_t veclen, int pretty);
 int xml2json(FILE *f, cxobj *x, int pretty);
 int xml2json_vec(FILE *f, cxobj **vec, size_t veclen, int pretty);
 int json_parse_str(char *str, cxobj **xt);
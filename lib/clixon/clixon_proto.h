@@ -55,6 +55,12 @@ struct clicon_msg {
     char        op_body[0];  /* rest of message, actual data */
 };
 
+/* op_len of a message whose length is not known when it is sent, see
+ * clicon_sink_msg(). The body follows in chunks, each a uint32_t length in
+ * network byte order followed by data, and ends with a chunk of length 0.
+ * clicon_msg_rcv() returns the message with its actual length. */
+#define CLICON_MSG_CHUNKED 0
+
 /*
  * Prototypes
  */ 
@@ -66,6 +72,8 @@ int clicon_msg_decode(struct clicon_msg *msg, cxobj **xml);
 
 int clicon_connect_unix(char *sockpath);
 
+int clicon_connect_inet(char *dst, uint16_t port);
+
 int clicon_rpc_connect_unix(struct clicon_msg    *msg, 
 			    char                 *sockpath,
 			    char                **ret,
@@ -83,6 +91,8 @@ int clicon_msg_send(int s, struct clicon_msg *msg);
 
 int clicon_msg_rcv(int s, struct clicon_msg **msg, int *eof);
 
+int clicon_msg_parse(char *buf, size_t len, struct clicon_msg **msg, size_t *used);
+
 int send_msg_notify(int s, int level, char *event);
 
 int send_msg_reply(int s, char *data, uint32_t datalen);
@@ -40,18 +40,29 @@
 #ifndef _CLIXON_PROTO_CLIENT_H_
 #define _CLIXON_PROTO_CLIENT_H_
 
+int clicon_rpc_msg_send(clicon_handle h, struct clicon_msg *msg, uint32_t *id);
+int clicon_rpc_msg_rcv_raw(clicon_handle h, uint32_t id, char **retdata0);
+int clicon_rpc_msg_rcv(clicon_handle h, uint32_t id, cxobj **xret0);
+int clicon_rpc_session_close(clicon_handle h);
 int clicon_rpc_msg(clicon_handle h, struct clicon_msg *msg, cxobj **xret0,
 		   int *sock0);
 int clicon_rpc_netconf(clicon_handle h, char *xmlst, cxobj **xret, int *sp);
 int clicon_rpc_netconf_xml(clicon_handle h, cxobj *xml, cxobj **xret, int *sp);
+int clicon_rpc_netconf_raw(clicon_handle h, char *xmlstr, char **reply);
+int clicon_rpc_netconf_xml_raw(clicon_handle h, cxobj *xml, char **reply);
+int clicon_rpc_reply_data(char *reply, char **data, size_t *len);
 int clicon_rpc_generate_error(char *format, cxobj *xerr);
 int clicon_rpc_get_config(clicon_handle h, char *db, char *xpath, cxobj **xret);
+int clicon_rpc_get_config_send(clicon_handle h, char *db, char *xpath, uint32_t *id);
+int clicon_rpc_get_config_rcv(clicon_handle h, uint32_t id, cxobj **xret);
 int clicon_rpc_edit_config(clicon_handle h, char *db, enum operation_type op, 
 			   char *xml);
 int clicon_rpc_copy_config(clicon_handle h, char *db1, char *db2);
 int clicon_rpc_delete_config(clicon_handle h, char *db);
 int clicon_rpc_lock(clicon_handle h, char *db);
 int clicon_rpc_unlock(clicon_handle h, char *db);
+int clicon_rpc_get_raw(clicon_handle h, char *xpath, char **reply);
+int clicon_rpc_get_parse(clicon_handle h, char *reply, cxobj **xt);
 int clicon_rpc_get(clicon_handle h, char *xpath, cxobj **xret);
 int clicon_rpc_close_session(clicon_handle h);
 int clicon_rpc_kill_session(clicon_handle h, int session_id);
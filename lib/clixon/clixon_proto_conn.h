@@ -0,0 +1,69 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2018 Olof Hagsand and Benny Holmgren
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ *
+ * Non-blocking message connections, eg the backend end of a client session.
+ */
+
+#ifndef _CLIXON_PROTO_CONN_H_
+#define _CLIXON_PROTO_CONN_H_
+
+/*
+ * Types
+ */
+typedef struct clicon_conn clicon_conn;
+
+/*! Called for each message received on a connection. msg is freed after return.
+ * Returns -1 on fatal error, which is returned from the event loop. */
+typedef int (clicon_conn_msg_fn_t)(clicon_conn *cc, struct clicon_msg *msg,
+				   void *arg);
+
+/*! Called when a connection is closed by the peer or has failed. Should free
+ * the connection with clicon_conn_free() and close the socket. */
+typedef int (clicon_conn_close_fn_t)(clicon_conn *cc, void *arg);
+
+/*
+ * Prototypes
+ */
+clicon_conn *clicon_conn_new(int s, clicon_conn_msg_fn_t *msgfn,
+			     clicon_conn_close_fn_t *closefn, void *arg);
+int          clicon_conn_free(clicon_conn *cc);
+int          clicon_conn_hiwat_set(clicon_conn *cc, size_t hiwat);
+int          clicon_conn_send(clicon_conn *cc, struct clicon_msg *msg);
+int          clicon_conn_notify(clicon_conn *cc, int level, char *event);
+clicon_sink *clicon_conn_sink(clicon_conn *cc);
+size_t       clicon_conn_outlen(clicon_conn *cc);
+int          clicon_conn_shutdown(clicon_conn *cc);
+
+#endif  /* _CLIXON_PROTO_CONN_H_ */
@@ -35,9 +35,15 @@
 #ifndef _CLIXON_SHA1_H_
 #define _CLIXON_SHA1_H_
 
+/*
+ * Constants
+ */
+#define CLICON_SHA1_LEN 20  /* Digest length in bytes */
+
 /*
  *  Function Prototypes
  */
+int   clicon_sha1(const void *buf, size_t len, unsigned char *digest);
 char *clicon_sha1hex(const char *str);
 
 #endif /* _CLIXON_SHA1_H_ */
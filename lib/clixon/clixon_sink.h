@@ -32,14 +32,39 @@
   ***** END LICENSE BLOCK *****
 
  *
- *  netconf match & selection: get and edit operations
- *****************************************************************************/
-#ifndef _NETCONF_FILTER_H_
-#define _NETCONF_FILTER_H_
+ * Output sinks: buffered output of generated text, eg XML or JSON, to a 
+ * socket, a clicon_msg reply, a file, a cligen buffer or a callback.
+ */
+
+#ifndef _CLIXON_SINK_H_
+#define _CLIXON_SINK_H_
+
+/*
+ * Types
+ */
+typedef struct clicon_sink clicon_sink;
+
+/* Callback of clicon_sink_fn(), eg writing to a fastcgi stream */
+typedef int (clicon_sink_fn_t)(void *arg, char *buf, size_t len);
 
 /*
  * Prototypes
  */ 
-int xml_filter(cxobj *xf, cxobj *xn);
+clicon_sink *clicon_sink_fd(int fd);
+clicon_sink *clicon_sink_msg(int s);
+clicon_sink *clicon_sink_msg_fn(clicon_sink_fn_t *fn, void *arg);
+clicon_sink *clicon_sink_file(FILE *f);
+clicon_sink *clicon_sink_cbuf(cbuf *cb);
+clicon_sink *clicon_sink_fn(clicon_sink_fn_t *fn, void *arg);
+int    clicon_sink_write(clicon_sink *cs, char *buf, size_t len);
+int    clicon_sink_puts(clicon_sink *cs, char *str);
+int    clicon_sink_putc(clicon_sink *cs, int c);
+int    clicon_sink_indent(clicon_sink *cs, int n);
+int    clicon_sink_printf(clicon_sink *cs, const char *format, ...);
+int    clicon_sink_flush(clicon_sink *cs);
+size_t clicon_sink_len(clicon_sink *cs);
+int    clicon_sink_errno(clicon_sink *cs);
+int    clicon_sink_free(clicon_sink *cs);
+int    clicon_sink_close(clicon_sink *cs);
 
-#endif  /* _NETCONF_FILTER_H_ */
+#endif  /* _CLIXON_SINK_H_ */
@@ -63,6 +63,8 @@ enum cxobj_type {CX_ERROR=-1,
 
 typedef struct xml cxobj; /* struct defined in clicon_xml.c */
 
+struct clicon_sink; /* Output sink, see clixon_sink.h */
+
 /*! Callback function type for xml_apply 
  * @retval    -1    Error, aborted at first error encounter
  * @retval     0    OK, continue
@@ -79,6 +81,11 @@ typedef int (xml_applyfn_t)(cxobj *yn, void *arg);
 #define XML_FLAG_DEL    0x04  /* Node is deleted (commits) or parent deleted rec */
 #define XML_FLAG_CHANGE 0x08  /* Node is changed (commits) or child changed rec */
 #define XML_FLAG_NONE   0x10  /* Node is added as NONE */
+#define XML_FLAG_DIRTY  0x20  /* Datastore: node or descendant modified since
+				 db was copied. With XML_FLAG_DEL: child removed */
+
+/* Length of hash of an xml tree, see xml_hash() */
+#define XML_HASH_LEN 20
 
 /* Sort and binary search of XML children
  * Experimental
@@ -89,7 +96,12 @@ extern int xml_child_sort;
  * Prototypes
  */
 char     *xml_type2str(enum cxobj_type type);
+char     *xml_name_intern(char *name);
+char     *xml_name_interned(char *name);
+int       xml_name_intern_yang(yang_spec *yspec);
 char     *xml_name(cxobj *xn);
+int       xml_name_eq(cxobj *xn, char *name);
+int       xml_name_eq_atom(cxobj *xn, char *name, char *atom);
 int       xml_name_set(cxobj *xn, char *name);
 char     *xml_namespace(cxobj *xn);
 int       xml_namespace_set(cxobj *xn, char *name);
@@ -118,6 +130,7 @@ cxobj    *xml_child_each(cxobj *xparent, cxobj *xprev,  enum cxobj_type type);
 cxobj   **xml_childvec_get(cxobj *x);
 int       xml_childvec_set(cxobj *x, int len);
 cxobj    *xml_new(char *name, cxobj *xn_parent, yang_stmt *spec);
+cxobj    *xml_new_arena(char *name, yang_stmt *spec);
 yang_stmt *xml_spec(cxobj *x);
 int       xml_spec_set(cxobj *x, yang_stmt *spec);
 cxobj    *xml_find(cxobj *xn_parent, char *name);
@@ -140,6 +153,9 @@ int       xml_free(cxobj *xn);
 int       xml_print(FILE  *f, cxobj *xn);
 int       clicon_xml2file(FILE *f, cxobj *xn, int level, int prettyprint);
 int       clicon_xml2cbuf(cbuf *xf, cxobj *xn, int level, int prettyprint);
+int       clicon_xml2cbuf_view(cbuf *cb, cxobj *xt, char *name, cxobj **xvec, size_t xlen, int config, int prettyprint);
+int       clicon_xml2sink(struct clicon_sink *cs, cxobj *xn, int level, int prettyprint);
+int       clicon_xml2sink_view(struct clicon_sink *cs, cxobj *xt, char *name, cxobj **xvec, size_t xlen, int config, int prettyprint);
 int       xml_parse_file(int fd, char *endtag, yang_spec *yspec, cxobj **xt);
 int       xml_parse_string(const char *str, yang_spec *yspec, cxobj **xml_top);
 int       xml_parse_va(cxobj **xt, yang_spec *yspec, const char *format, ...);
@@ -148,6 +164,8 @@ int       xmltree2cbuf(cbuf *cb, cxobj *x, int level);
 int       xml_copy_one(cxobj *xn0, cxobj *xn1);
 int       xml_copy(cxobj *x0, cxobj *x1);
 cxobj    *xml_dup(cxobj *x0);
+int       xml_hash(cxobj *x, unsigned char *digest);
+int       xml_hash_eq(cxobj *x1, cxobj *x2);
 
 int       cxvec_dup(cxobj **vec0, size_t len0, cxobj ***vec1, size_t *len1);
 int       cxvec_append(cxobj *x, cxobj ***vec, size_t  *len);
@@ -48,7 +48,7 @@ typedef void *xmldb_handle;
 #endif
 
 /* Version of clixon datastore plugin API. */
-#define XMLDB_API_VERSION 1
+#define XMLDB_API_VERSION 3
 
 /* Magic to ensure plugin sanity. */
 #define XMLDB_API_MAGIC 0xf386f730
@@ -104,6 +104,15 @@ typedef int (xmldb_delete_t)(xmldb_handle xh, const char *db);
 /* Type of xmldb init function */
 typedef int (xmldb_create_t)(xmldb_handle xh, const char *db);
 
+/* Type of xmldb dirty function */
+typedef int (xmldb_dirty_t)(xmldb_handle xh, const char *db, const char *base, cxobj **xdirty);
+
+/* Type of xmldb snapshot function */
+typedef int (xmldb_snapshot_t)(xmldb_handle xh, const char *db, cxobj **xt);
+
+/* Type of xmldb release function */
+typedef int (xmldb_release_t)(xmldb_handle xh, const char *db, cxobj *xt);
+
 /* plugin init struct for the api */
 struct xmldb_api{
     int                 xa_version;
@@ -124,6 +133,9 @@ struct xmldb_api{
     xmldb_exists_t     *xa_exists_fn;
     xmldb_delete_t     *xa_delete_fn;
     xmldb_create_t     *xa_create_fn;
+    xmldb_dirty_t      *xa_dirty_fn;    /* May be NULL */
+    xmldb_snapshot_t   *xa_snapshot_fn; /* May be NULL (then also release) */
+    xmldb_release_t    *xa_release_fn;  /* May be NULL (then also snapshot) */
 };
 
 /*
@@ -148,5 +160,8 @@ int xmldb_islocked(clicon_handle h, const char *db);
 int xmldb_exists(clicon_handle h, const char *db);
 int xmldb_delete(clicon_handle h, const char *db);
 int xmldb_create(clicon_handle h, const char *db);
+int xmldb_dirty(clicon_handle h, const char *db, const char *base, cxobj **xdirty);
+int xmldb_snapshot(clicon_handle h, const char *db, cxobj **xt);
+int xmldb_release(clicon_handle h, const char *db, cxobj *xt);
 
 #endif /* _CLIXON_XML_DB_H */
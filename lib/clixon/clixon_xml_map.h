@@ -38,12 +38,19 @@
 #ifndef _CLIXON_XML_MAP_H_
 #define _CLIXON_XML_MAP_H_
 
+/*
+ * Types
+ */
+struct leafref_index; /* Leafref target values, see xml_yang_validate_all */
+
 /*
  * Prototypes
  */
 int xml2txt(FILE *f, cxobj *x, int level);
 int xml2cli(FILE *f, cxobj *x, char *prepend, enum genmodel_type gt);
 int xml_yang_validate_add(cxobj *xt, void *arg);
+struct leafref_index *leafref_index_new(void);
+int leafref_index_free(struct leafref_index *li);
 int xml_yang_validate_all(cxobj *xt, void *arg);
 int xml2cvec(cxobj *xt, yang_stmt *ys, cvec **cvv0);
 int cvec2xml_1(cvec *cvv, char *toptag, cxobj *xp, cxobj **xt0);
@@ -51,6 +58,10 @@ int xml_diff(yang_spec *yspec, cxobj *xt1, cxobj *xt2,
 	     cxobj ***first, size_t *firstlen, 
 	     cxobj ***second, size_t *secondlen, 
 	     cxobj ***changed1, cxobj ***changed2, size_t *changedlen);
+int xml_diff_dirty(yang_spec *yspec, cxobj *xt1, cxobj *xt2, cxobj *xd,
+		   cxobj ***first, size_t *firstlen, 
+		   cxobj ***second, size_t *secondlen, 
+		   cxobj ***changed1, cxobj ***changed2, size_t *changedlen);
 int yang2api_path_fmt(yang_stmt *ys, int inclkey, char **api_path_fmt);
 int api_path_fmt2api_path(char *api_path_fmt, cvec *cvv, char **api_path);
 int api_path_fmt2xpath(char *api_path_fmt, cvec *cvv, char **xpath);
@@ -66,6 +77,8 @@ int api_path2xpath(yang_spec *yspec, char *api_path, cbuf *xpath);
 int api_path2xml(char *api_path, yang_spec *yspec, cxobj *xtop, 
 		 int schemanode, cxobj **xpathp, yang_node **ypathp);
 int xml_merge(cxobj *x0, cxobj *x1, yang_spec *yspec);
+int xml_subtree_filter(cxobj *xt, cxobj *xfilter, yang_spec *yspec,
+		       cxobj ***vec, size_t *veclen);
 int yang_enum_int_value(cxobj *node, int32_t *val);
 
 #endif  /* _CLIXON_XML_MAP_H_ */
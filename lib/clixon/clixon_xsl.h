@@ -36,9 +36,19 @@
 #ifndef _CLIXON_XSL_H
 #define _CLIXON_XSL_H
 
+/*
+ * Types
+ */
+/* Compiled xpath expression, see xpath_compile() */
+typedef struct xpath_compiled xpath_compiled;
+
 /*
  * Prototypes
  */
+xpath_compiled *xpath_compile(char *xpath);
+int xpath_compiled_free(xpath_compiled *xc);
+int xpath_vec_compiled(cxobj *cxtop, xpath_compiled *xc, uint16_t flags,
+		       cxobj ***vec, size_t *veclen);
 cxobj *xpath_first(cxobj *cxtop, char *format, ...);
 cxobj *xpath_each(cxobj *xn_top, char *xpath, cxobj *prev);
 int xpath_vec(cxobj *cxtop, char *format, cxobj ***vec, size_t  *veclen, ...);
@@ -140,6 +140,8 @@ struct yang_type_cache{
     cg_var    *yc_mincv;
     cg_var    *yc_maxcv;
     char      *yc_pattern;
+    cvec      *yc_patterns; /* All patterns of type and its typedefs, XSD syntax */
+    void      *yc_regex;    /* Compiled yc_patterns as regex_t vector, or NULL */
     uint8_t    yc_fraction;
     yang_stmt *yc_resolved; /* Resolved type object, can be NULL - note direct ptr */
 };
@@ -167,6 +169,8 @@ struct yang_stmt{
 					Y_LIST: vector of keys
 				     */
     yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data except unions */
+    int                ys_order;     /* Data nodes: cached yang_order(), or -1 
+					if not computed. See yang_order_populate() */
 };
 
 
@@ -30,9 +30,11 @@
   the terms of any one of the Apache License version 2 or the GPL.
 
   ***** END LICENSE BLOCK *****
-
  *
  * Event handling and loop
+ * File descriptors are polled with epoll if available, otherwise select.
+ * Registrations are kept in a table indexed by file descriptor, and 
+ * timeouts in a binary heap ordered by time.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -42,13 +44,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
 #include <syslog.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #include "clixon_queue.h"
 #include "clixon_log.h"
@@ -60,26 +67,57 @@
  */
 #define EVENT_STRLEN 32
 
+/* Ready events of a file descriptor */
+#define EVENT_IN  0x01 /* Input available (or eof or error) */
+#define EVENT_OUT 0x02 /* Writable (or error) */
+
+/* Max number of file descriptors returned by one epoll_wait() */
+#define EVENT_EPOLL_MAX 64
+
 /*
  * Types
  */
 struct event_data{
-    struct event_data *e_next;     /* next in list */
+    struct event_data *e_next;     /* next in list (of same fd) */
     int (*e_fn)(int, void*);            /* function */
     enum {EVENT_FD, EVENT_TIME} e_type;        /* type of event */
     int e_fd;                      /* File descriptor */
+    int e_out;                     /* EVENT_FD: call when fd is writable */
     struct timeval e_time;         /* Timeout */
     void *e_arg;                   /* function argument */
+    uint64_t e_serial;             /* Order of registration */
     char e_string[EVENT_STRLEN];             /* string for debugging */
 };
 
 /*
  * Internal variables
  */
-static struct event_data *ee = NULL;
-static struct event_data *ee_timers = NULL;
+/* File descriptor callbacks, indexed by file descriptor */
+static struct event_data **ee_fds = NULL;
+static int                 ee_fdslen = 0;   /* Allocated length of ee_fds */
+static int                 ee_maxfd = -1;   /* Highest registered fd */
+static int                *ee_ready = NULL; /* Ready fds, same length as ee_fds */
+static int                *ee_readyev = NULL; /* EVENT_IN/OUT of ready fds */
+/* Set for fds that cannot be polled with epoll, eg regular files. These are
+ * always ready, as with select */
+static char               *ee_nopoll = NULL;  /* Same length as ee_fds */
+static int                 ee_nopolllen = 0;  /* Number of fds set in ee_nopoll */
+
+/* Timeouts as a binary heap, earliest first */
+static struct event_data **ee_timers = NULL;
+static int                 ee_timerslen = 0; /* Number of timeouts */
+static int                 ee_timersmax = 0; /* Allocated length of ee_timers */
+
+/* Incremented for each registration. Callbacks registered after polling
+ * for input are not called until polled again */
+static uint64_t ee_serial = 0;
 
-/* Set if element in ee is deleted (event_unreg_fd). Check in ee loops */
+#ifdef HAVE_SYS_EPOLL_H
+static int ee_epfd = -1;     /* epoll file descriptor */
+#endif
+static int ee_select = 0;    /* Use select instead of epoll */
+
+/* Set if element in ee_fds is deleted (event_unreg_fd). Check in ee loops */
 static int _ee_unreg = 0;
 
 static int _clicon_exit = 0;
@@ -104,6 +142,170 @@ clicon_exit_get(void)
     return _clicon_exit;
 }
 
+/*! Start, change or stop polling a file descriptor according to its callbacks
+ * Input is polled if there are input callbacks, and writability if there are
+ * output callbacks. With select, the callbacks are checked when waiting.
+ * @param[in]  fd  File descriptor
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+event_poll_set(int fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event ev = {0,};
+    struct event_data *e;
+
+    if (ee_epfd == -1 && !ee_select){
+	if ((ee_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0){
+	    clicon_log(LOG_WARNING, "%s epoll_create1: %s, using select", 
+		       __FUNCTION__, strerror(errno));
+	    ee_select++;
+	}
+    }
+    if (ee_epfd != -1){
+	for (e = ee_fds[fd]; e; e = e->e_next)
+	    ev.events |= e->e_out?EPOLLOUT:EPOLLIN;
+	ev.data.fd = fd;
+	if (ee_nopoll[fd]){
+	    ee_nopoll[fd] = 0;
+	    ee_nopolllen--;
+	}
+	if (ev.events == 0){
+	    /* Fails if fd is already closed, which also removes it from epoll */
+	    epoll_ctl(ee_epfd, EPOLL_CTL_DEL, fd, &ev);
+	    return 0;
+	}
+	/* EEXIST also if fd was closed and reopened without event_unreg_fd */
+	if (epoll_ctl(ee_epfd, EPOLL_CTL_ADD, fd, &ev) < 0){
+	    if (errno == EPERM){ /* Regular file or directory, always ready */
+		ee_nopoll[fd] = 1;
+		ee_nopolllen++;
+	    }
+	    else if (errno != EEXIST || 
+		epoll_ctl(ee_epfd, EPOLL_CTL_MOD, fd, &ev) < 0){
+		clicon_err(OE_EVENTS, errno, "%s epoll_ctl", __FUNCTION__);
+		return -1;
+	    }
+	}
+	return 0;
+    }
+#else
+    ee_select = 1;
+#endif
+    if (fd >= FD_SETSIZE){
+	clicon_err(OE_EVENTS, EINVAL, "%s fd %d exceeds FD_SETSIZE", 
+		   __FUNCTION__, fd);
+	return -1;
+    }
+    return 0;
+}
+
+/*! Register a callback of a file descriptor, see event_reg_fd
+ * @param[in]  out  Call fn when fd is writable, instead of on input
+ */
+static int
+event_reg_fd1(int   fd, 
+	      int (*fn)(int, void*), 
+	      void *arg, 
+	      char *str,
+	      int   out)
+{
+    struct event_data  *e;
+    struct event_data **fds;
+    int                *ready;
+    char               *nopoll;
+    int                 len;
+
+    if (fd < 0){
+	clicon_err(OE_EVENTS, EBADF, "%s: %s", __FUNCTION__, str);
+	return -1;
+    }
+    if (fd >= ee_fdslen){
+	len = ee_fdslen?ee_fdslen:64;
+	while (len <= fd)
+	    len *= 2;
+	if ((fds = realloc(ee_fds, len*sizeof(*fds))) == NULL){
+	    clicon_err(OE_EVENTS, errno, "realloc");
+	    return -1;
+	}
+	memset(&fds[ee_fdslen], 0, (len-ee_fdslen)*sizeof(*fds));
+	ee_fds = fds;
+	if ((ready = realloc(ee_ready, len*sizeof(*ready))) == NULL){
+	    clicon_err(OE_EVENTS, errno, "realloc");
+	    return -1;
+	}
+	ee_ready = ready;
+	if ((ready = realloc(ee_readyev, len*sizeof(*ready))) == NULL){
+	    clicon_err(OE_EVENTS, errno, "realloc");
+	    return -1;
+	}
+	ee_readyev = ready;
+	if ((nopoll = realloc(ee_nopoll, len)) == NULL){
+	    clicon_err(OE_EVENTS, errno, "realloc");
+	    return -1;
+	}
+	memset(&nopoll[ee_fdslen], 0, len-ee_fdslen);
+	ee_nopoll = nopoll;
+	ee_fdslen = len;
+    }
+    if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
+	clicon_err(OE_EVENTS, errno, "malloc");
+	return -1;
+    }
+    memset(e, 0, sizeof(struct event_data));
+    strncpy(e->e_string, str, EVENT_STRLEN);
+    e->e_fd = fd;
+    e->e_fn = fn;
+    e->e_arg = arg;
+    e->e_type = EVENT_FD;
+    e->e_out = out;
+    e->e_serial = ++ee_serial;
+    e->e_next = ee_fds[fd];
+    ee_fds[fd] = e;
+    if (event_poll_set(fd) < 0){
+	ee_fds[fd] = e->e_next;
+	free(e);
+	return -1;
+    }
+    if (fd > ee_maxfd)
+	ee_maxfd = fd;
+    clicon_debug(2, "%s, registering %s", __FUNCTION__, e->e_string);
+    return 0;
+}
+
+/*! Deregister a callback of a file descriptor, see event_unreg_fd
+ * @param[in]  out  Output callback
+ */
+static int
+event_unreg_fd1(int   s, 
+		int (*fn)(int, void*),
+		int   out)
+{
+    struct event_data *e, **e_prev;
+    int found = 0;
+
+    if (s < 0 || s >= ee_fdslen)
+	return -1;
+    e_prev = &ee_fds[s];
+    for (e = ee_fds[s]; e; e = e->e_next){
+	if (fn == e->e_fn && out == e->e_out) {
+	    found++;
+	    *e_prev = e->e_next;
+	    _ee_unreg++;
+	    free(e);
+	    break;
+	}
+	e_prev = &e->e_next;
+    }
+    if (found){
+	event_poll_set(s);
+	while (ee_maxfd >= 0 && ee_fds[ee_maxfd] == NULL)
+	    ee_maxfd--;
+    }
+    return found?0:-1;
+}
+
 /*! Register a callback function to be called on input on a file descriptor.
  *
  * @param[in]  fd  File descriptor
@@ -122,22 +324,7 @@ event_reg_fd(int   fd,
 	     void *arg, 
 	     char *str)
 {
-    struct event_data *e;
-
-    if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
-	clicon_err(OE_EVENTS, errno, "malloc");
-	return -1;
-    }
-    memset(e, 0, sizeof(struct event_data));
-    strncpy(e->e_string, str, EVENT_STRLEN);
-    e->e_fd = fd;
-    e->e_fn = fn;
-    e->e_arg = arg;
-    e->e_type = EVENT_FD;
-    e->e_next = ee;
-    ee = e;
-    clicon_debug(2, "%s, registering %s", __FUNCTION__, e->e_string);
-    return 0;
+    return event_reg_fd1(fd, fn, arg, str, 0);
 }
 
 /*! Deregister a file descriptor callback
@@ -151,21 +338,88 @@ int
 event_unreg_fd(int   s, 
 	       int (*fn)(int, void*))
 {
-    struct event_data *e, **e_prev;
-    int found = 0;
+    return event_unreg_fd1(s, fn, 0);
+}
 
-    e_prev = &ee;
-    for (e = ee; e; e = e->e_next){
-	if (fn == e->e_fn && s == e->e_fd) {
-	    found++;
-	    *e_prev = e->e_next;
-	    _ee_unreg++;
-	    free(e);
+/*! Register a callback function to be called when a file descriptor is writable
+ * Used to write output queued on a non-blocking socket. Deregister when the
+ * queue is empty, otherwise fn is called again and again.
+ * @param[in]  fd  File descriptor
+ * @param[in]  fn  Function to call when fd is writable
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @see event_unreg_fd_out
+ */
+int
+event_reg_fd_out(int   fd, 
+		 int (*fn)(int, void*), 
+		 void *arg, 
+		 char *str)
+{
+    return event_reg_fd1(fd, fn, arg, str, 1);
+}
+
+/*! Deregister a file descriptor writability callback
+ * @param[in]  s   File descriptor
+ * @param[in]  fn  Function to call when fd is writable
+ * @see event_reg_fd_out
+ */
+int
+event_unreg_fd_out(int   s, 
+		   int (*fn)(int, void*))
+{
+    return event_unreg_fd1(s, fn, 1);
+}
+
+/*! Compare two timeouts in heap: by time, and by registration if same time
+ */
+static int
+event_timer_before(struct event_data *e1,
+		   struct event_data *e2)
+{
+    if (timercmp(&e1->e_time, &e2->e_time, !=))
+	return timercmp(&e1->e_time, &e2->e_time, <);
+    return e1->e_serial < e2->e_serial;
+}
+
+/*! Move timeout at position i in heap up or down to its place
+ * @param[in]  i   Position in ee_timers
+ */
+static void
+event_timer_sift(int i)
+{
+    struct event_data *e = ee_timers[i];
+    int                c;
+
+    while (i > 0 && event_timer_before(e, ee_timers[(i-1)/2])){
+	ee_timers[i] = ee_timers[(i-1)/2];
+	i = (i-1)/2;
+    }
+    while ((c = 2*i+1) < ee_timerslen){
+	if (c+1 < ee_timerslen && event_timer_before(ee_timers[c+1], ee_timers[c]))
+	    c++;
+	if (!event_timer_before(ee_timers[c], e))
 	    break;
-	}
-	e_prev = &e->e_next;
+	ee_timers[i] = ee_timers[c];
+	i = c;
     }
-    return found?0:-1;
+    ee_timers[i] = e;
+}
+
+/*! Remove timeout at position i from heap
+ * @param[in]  i   Position in ee_timers
+ * @retval     e   Removed timeout
+ */
+static struct event_data *
+event_timer_rm(int i)
+{
+    struct event_data *e = ee_timers[i];
+
+    if (--ee_timerslen > i){
+	ee_timers[i] = ee_timers[ee_timerslen];
+	event_timer_sift(i);
+    }
+    return e;
 }
 
 /*! Call a callback function at an absolute time
@@ -197,8 +451,19 @@ event_reg_timeout(struct timeval t,
 		  void          *arg, 
 		  char          *str)
 {
-    struct event_data *e, *e1, **e_prev;
+    struct event_data  *e;
+    struct event_data **timers;
+    int                 len;
 
+    if (ee_timerslen == ee_timersmax){
+	len = ee_timersmax?2*ee_timersmax:16;
+	if ((timers = realloc(ee_timers, len*sizeof(*timers))) == NULL){
+	    clicon_err(OE_EVENTS, errno, "realloc");
+	    return -1;
+	}
+	ee_timers = timers;
+	ee_timersmax = len;
+    }
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
 	clicon_err(OE_EVENTS, errno, "malloc");
 	return -1;
@@ -209,15 +474,10 @@ event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
+    e->e_serial = ++ee_serial;
     /* Sort into right place */
-    e_prev = &ee_timers;
-    for (e1=ee_timers; e1; e1=e1->e_next){
-	if (timercmp(&e->e_time, &e1->e_time, <))
-	    break;
-	e_prev = &e1->e_next;
-    }
-    e->e_next = e1;
-    *e_prev = e;
+    ee_timers[ee_timerslen++] = e;
+    event_timer_sift(ee_timerslen-1);
     clicon_debug(2, "event_reg_timeout: %s", str); 
     return 0;
 }
@@ -235,20 +495,15 @@ int
 event_unreg_timeout(int (*fn)(int, void*), 
 		    void *arg)
 {
-    struct event_data *e, **e_prev;
-    int found = 0;
+    int i;
 
-    e_prev = &ee_timers;
-    for (e = ee_timers; e; e = e->e_next){
-	if (fn == e->e_fn && arg == e->e_arg) {
-	    found++;
-	    *e_prev = e->e_next;
-	    free(e);
-	    break;
+    for (i=0; i<ee_timerslen; i++){
+	if (fn == ee_timers[i]->e_fn && arg == ee_timers[i]->e_arg) {
+	    free(event_timer_rm(i));
+	    return 0;
 	}
-	e_prev = &e->e_next;
     }
-    return found?0:-1;
+    return -1;
 }
 
 /*! Poll to see if there is any data available on this file descriptor.
@@ -260,20 +515,97 @@ event_unreg_timeout(int (*fn)(int, void*),
 int 
 event_poll(int fd)
 {
-    int            retval = -1;
-    fd_set         fdset;
-    struct timeval tnull = {0,};
+    int           retval = -1;
+    struct pollfd pfd = {0,};
 
-    FD_ZERO(&fdset);
-    FD_SET(fd, &fdset);
-    if ((retval = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull)) < 0)
-	clicon_err(OE_EVENTS, errno, "%s select1: %s", __FUNCTION__, strerror(errno));
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if ((retval = poll(&pfd, 1, 0)) < 0)
+	clicon_err(OE_EVENTS, errno, "%s poll: %s", __FUNCTION__, strerror(errno));
     return retval;
 }
 
+/*! Wait for input on registered file descriptors, or for a timeout
+ * Also waits for file descriptors with output callbacks to be writable.
+ * File descriptors that epoll cannot poll, see ee_nopoll, are ready each time
+ * and the wait does not block while there are such file descriptors.
+ * @param[in]  tp      Max time to wait, or NULL to wait for input
+ * @retval     n       Number of ready file descriptors, set in ee_ready and
+ *                     their events (EVENT_IN/EVENT_OUT) in ee_readyev
+ * @retval    -1       Error, errno set
+ */
+static int
+event_wait(struct timeval *tp)
+{
+    int                n;
+    int                fd;
+    fd_set             fdset;
+    fd_set             wset;
+    struct event_data *e;
+    int                ev;
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event evs[EVENT_EPOLL_MAX];
+    int                ms = -1;
+    int                i;
+
+    if (ee_epfd != -1){
+	if (ee_nopolllen)
+	    ms = 0;
+	else if (tp){
+	    if (tp->tv_sec >= INT_MAX/1000)
+		ms = INT_MAX;
+	    else
+		ms = tp->tv_sec*1000 + (tp->tv_usec+999)/1000;
+	}
+	if ((n = epoll_wait(ee_epfd, evs, EVENT_EPOLL_MAX, ms)) < 0)
+	    return -1;
+	for (i=0; i<n; i++){
+	    ee_ready[i] = evs[i].data.fd;
+	    ev = 0;
+	    /* Errors are reported to both input and output callbacks */
+	    if (evs[i].events & (EPOLLIN|EPOLLHUP|EPOLLERR))
+		ev |= EVENT_IN;
+	    if (evs[i].events & (EPOLLOUT|EPOLLHUP|EPOLLERR))
+		ev |= EVENT_OUT;
+	    ee_readyev[i] = ev;
+	}
+	for (fd=0; ee_nopolllen && fd<=ee_maxfd; fd++){
+	    if (!ee_nopoll[fd])
+		continue;
+	    ev = 0;
+	    for (e = ee_fds[fd]; e; e = e->e_next)
+		ev |= e->e_out?EVENT_OUT:EVENT_IN;
+	    ee_readyev[n] = ev;
+	    ee_ready[n++] = fd;
+	}
+	return n;
+    }
+#endif
+    FD_ZERO(&fdset);
+    FD_ZERO(&wset);
+    for (fd=0; fd<=ee_maxfd; fd++)
+	for (e = ee_fds[fd]; e; e = e->e_next)
+	    FD_SET(fd, e->e_out?&wset:&fdset);
+    if ((n = select(ee_maxfd+1, &fdset, &wset, NULL, tp)) <= 0)
+	return n;
+    n = 0;
+    for (fd=0; fd<=ee_maxfd; fd++){
+	ev = 0;
+	if (FD_ISSET(fd, &fdset))
+	    ev |= EVENT_IN;
+	if (FD_ISSET(fd, &wset))
+	    ev |= EVENT_OUT;
+	if (ev){
+	    ee_readyev[n] = ev;
+	    ee_ready[n++] = fd;
+	}
+    }
+    return n;
+}
+
 /*! Dispatch file descriptor events (and timeouts) by invoking callbacks.
- * There is an issue with fairness that timeouts may take over all events
- * One could try to poll the file descriptors after a timeout?
+ * Timeouts that have expired are called first, then the callbacks of all
+ * file descriptors with input, also if a callback is deregistered.
  */
 int
 event_loop(void)
@@ -281,27 +613,26 @@ event_loop(void)
     struct event_data *e;
     struct event_data *e_next;
     int                n;
+    int                i;
+    int                fd;
+    int                ntimers;
+    uint64_t           serial;
     struct timeval     t;
     struct timeval     t0;
-    struct timeval     tnull = {0,};
-    fd_set             fdset;
+    struct timeval    *tp;
     int                retval = -1;
 
     while (!clicon_exit_get()){
-	FD_ZERO(&fdset);
-	for (e=ee; e; e=e->e_next)
-	    if (e->e_type == EVENT_FD)
-		FD_SET(e->e_fd, &fdset);
-	if (ee_timers != NULL){
+	tp = NULL;
+	if (ee_timerslen){
 	    gettimeofday(&t0, NULL);
-	    timersub(&ee_timers->e_time, &t0, &t); 
+	    timersub(&ee_timers[0]->e_time, &t0, &t); 
 	    if (t.tv_sec < 0)
-		n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull); 
-	    else
-		n = select(FD_SETSIZE, &fdset, NULL, NULL, &t); 
+		timerclear(&t);
+	    tp = &t;
 	}
-	else
-	    n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL); 
+	serial = ee_serial;
+	n = event_wait(tp);
 	if (clicon_exit_get())
 	    break;
 	if (n == -1) {
@@ -314,34 +645,44 @@ event_loop(void)
 		clicon_err(OE_EVENTS, errno, "%s select2", __FUNCTION__);
 	    goto err;
 	}
-	if (n==0){ /* Timeout */
-	    e = ee_timers;
-	    ee_timers = ee_timers->e_next;
-	    clicon_debug(2, "%s timeout: %s[%x]", 
-		    __FUNCTION__, e->e_string, e->e_arg);
-	    if ((*e->e_fn)(0, e->e_arg) < 0){
+	/* Timeouts, not those registered by the callbacks */
+	if (ee_timerslen){
+	    gettimeofday(&t0, NULL);
+	    ntimers = ee_timerslen;
+	    while (ntimers-- && ee_timerslen &&
+		   timercmp(&ee_timers[0]->e_time, &t0, <=)){
+		e = event_timer_rm(0);
+		clicon_debug(2, "%s timeout: %s[%x]", 
+			     __FUNCTION__, e->e_string, e->e_arg);
+		if ((*e->e_fn)(0, e->e_arg) < 0){
+		    free(e);
+		    goto err;
+		}
 		free(e);
-		goto err;
 	    }
-	    free(e);
 	}
-	_ee_unreg = 0;
-	for (e=ee; e; e=e_next){
+	for (i=0; i<n; i++){
 	    if (clicon_exit_get())
 		break;
-	    e_next = e->e_next;
-	    if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset)){
+	    fd = ee_ready[i];
+	    _ee_unreg = 0;
+	    for (e = fd<ee_fdslen?ee_fds[fd]:NULL; e; e = e_next){
+		e_next = e->e_next;
+		/* Registered after wait, eg new fd with same number */
+		if (e->e_serial > serial)
+		    continue;
+		if ((ee_readyev[i] & (e->e_out?EVENT_OUT:EVENT_IN)) == 0)
+		    continue;
 		clicon_debug(2, "%s: FD_ISSET: %s[%x]", 
-			__FUNCTION__, e->e_string, e->e_arg);
+			     __FUNCTION__, e->e_string, e->e_arg);
 		if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
 		    clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
 		    goto err;
-
 		}
-		if (_ee_unreg){
-		    _ee_unreg = 0;
+		/* e_next may be freed, other callbacks of fd are called when 
+		   polled again */
+		if (_ee_unreg)
 		    break;
-		}
 	    }
 	}
 	continue;
@@ -356,18 +697,42 @@ int
 event_exit(void)
 {
     struct event_data *e, *e_next;
-    
-    e_next = ee;
-    while ((e = e_next) != NULL){
-	e_next = e->e_next;
-	free(e);
-    }
-    ee = NULL;
-    e_next = ee_timers;
-    while ((e = e_next) != NULL){
-	e_next = e->e_next;
-	free(e);
+    int                fd;
+    int                i;
+
+    for (fd=0; fd<ee_fdslen; fd++){
+	e_next = ee_fds[fd];
+	while ((e = e_next) != NULL){
+	    e_next = e->e_next;
+	    free(e);
+	}
     }
+    if (ee_fds)
+	free(ee_fds);
+    ee_fds = NULL;
+    if (ee_ready)
+	free(ee_ready);
+    ee_ready = NULL;
+    if (ee_readyev)
+	free(ee_readyev);
+    ee_readyev = NULL;
+    if (ee_nopoll)
+	free(ee_nopoll);
+    ee_nopoll = NULL;
+    ee_nopolllen = 0;
+    ee_fdslen = 0;
+    ee_maxfd = -1;
+    for (i=0; i<ee_timerslen; i++)
+	free(ee_timers[i]);
+    if (ee_timers)
+	free(ee_timers);
     ee_timers = NULL;
+    ee_timerslen = 0;
+    ee_timersmax = 0;
+#ifdef HAVE_SYS_EPOLL_H
+    if (ee_epfd != -1)
+	close(ee_epfd);
+    ee_epfd = -1;
+#endif
     return 0;
 }
@@ -49,6 +49,12 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#ifdef HAVE_LINUX_FS_H
+#include <linux/fs.h> /* FICLONE */
+#endif
 #include <unistd.h>
 #include <netinet/in.h>
 #include <grp.h>
@@ -62,6 +68,9 @@
 #include "clixon_string.h"
 #include "clixon_file.h"
 
+/* Start size of buffer when reading from a stream, doubled when full */
+#define FILE_BUFLEN 65536
+
 /*
  * qsort function
  */
@@ -186,6 +195,8 @@ quit:
 }
 
 /*! Make a copy of file src. Overwrite existing
+ * If the filesystem supports it (eg btrfs, xfs), the copy shares data blocks
+ * with src (reflink) instead of copying them.
  * @retval 0   OK
  * @retval -1  Error
  */
@@ -213,6 +224,12 @@ clicon_file_copy(char *src,
 	err = errno;
 	goto error;
     }
+#ifdef FICLONE
+    if (ioctl(ouF, FICLONE, inF) == 0){
+	retval = 0;
+	goto error;
+    }
+#endif
     while((bytes = read(inF, line, sizeof(line))) > 0)
 	if (write(ouF, line, bytes) < 0){
 	    clicon_err(OE_UNIX, errno, "write(%s)", src);
@@ -230,6 +247,226 @@ clicon_file_copy(char *src,
 }
 
 
+/*! Find first occurrence of tag in a buffer of given length (not NUL-terminated)
+ */
+static char *
+file_memstr(char   *buf,
+	    size_t  len,
+	    char   *tag,
+	    size_t  taglen)
+{
+    char *p = buf;
+    char *end = buf + len;
+
+    if (taglen == 0 || len < taglen)
+	return NULL;
+    while ((p = memchr(p, tag[0], end - p - taglen + 1)) != NULL){
+	if (memcmp(p, tag, taglen) == 0)
+	    return p;
+	if (++p > end - taglen)
+	    break;
+    }
+    return NULL;
+}
+
+/*! Map a regular file into memory, followed by two NUL bytes
+ *
+ * Anonymous zero-filled pages with room for the NULs are reserved first and
+ * the file is then mapped over the start of them. Both are private and
+ * writable (copy-on-write) so that the buffer can be scanned in place.
+ * If endtag is given and found, the data ends after it, and the file offset
+ * is set after it as if it had been read.
+ */
+static int
+file_map_regular(int     fd,
+		 size_t  size,
+		 char   *endtag,
+		 char  **bufp,
+		 size_t *lenp,
+		 size_t *maplenp)
+{
+    long    pagesize = sysconf(_SC_PAGESIZE);
+    size_t  maplen;
+    size_t  len = size;
+    char   *buf;
+    char   *p;
+
+    maplen = ((size + 2 + pagesize - 1) / pagesize) * pagesize;
+    if ((buf = mmap(NULL, maplen, PROT_READ|PROT_WRITE,
+		    MAP_PRIVATE|MAP_ANONYMOUS, -1, 0)) == MAP_FAILED){
+	clicon_err(OE_UNIX, errno, "mmap");
+	return -1;
+    }
+    if (mmap(buf, size, PROT_READ|PROT_WRITE,
+	     MAP_PRIVATE|MAP_FIXED, fd, 0) == MAP_FAILED){
+	clicon_err(OE_UNIX, errno, "mmap");
+	munmap(buf, maplen);
+	return -1;
+    }
+    (void)madvise(buf, size, MADV_SEQUENTIAL);
+    if (endtag &&
+	(p = file_memstr(buf, size, endtag, strlen(endtag))) != NULL){
+	len = p - buf + strlen(endtag);
+	buf[len] = '\0';
+	buf[len+1] = '\0';
+    }
+    if (lseek(fd, len, SEEK_SET) < 0){
+	clicon_err(OE_UNIX, errno, "lseek");
+	munmap(buf, maplen);
+	return -1;
+    }
+    *bufp = buf;
+    *lenp = len;
+    *maplenp = maplen;
+    return 0;
+}
+
+/*! Read a stream (socket, pipe, tty,...) into a malloced buffer, followed by two NUL bytes
+ *
+ * Without endtag, read in large blocks until end-of-file.
+ * With endtag, no data after it is consumed, so that a following message on
+ * the same stream is left intact: sockets are peeked with MSG_PEEK and then
+ * read up to and including the endtag, other streams are read byte by byte.
+ */
+static int
+file_read_stream(int     fd,
+		 char   *endtag,
+		 int     sock,
+		 char  **bufp,
+		 size_t *lenp)
+{
+    int     retval = -1;
+    char   *buf = NULL;
+    char   *p;
+    size_t  buflen = FILE_BUFLEN;
+    size_t  len = 0;
+    size_t  taglen = 0;
+    size_t  start;
+    size_t  want;
+    ssize_t n;
+
+    if (endtag)
+	taglen = strlen(endtag);
+    if ((buf = malloc(buflen)) == NULL){
+	clicon_err(OE_UNIX, errno, "malloc");
+	goto done;
+    }
+    while (1){
+	if (len + 2 >= buflen){ /* Space: two for the NUL bytes */
+	    buflen *= 2;
+	    if ((p = realloc(buf, buflen)) == NULL){
+		clicon_err(OE_UNIX, errno, "realloc");
+		goto done;
+	    }
+	    buf = p;
+	}
+	want = buflen - len - 2;
+	if (endtag){
+	    if (sock){
+		if ((n = recv(fd, buf+len, want, MSG_PEEK)) < 0){
+		    if (errno == EINTR)
+			continue;
+		    clicon_err(OE_UNIX, errno, "recv");
+		    goto done;
+		}
+		if (n == 0) /* EOF */
+		    break;
+		/* The endtag may start in data already read */
+		start = len >= taglen ? len - taglen + 1 : 0;
+		if ((p = file_memstr(buf+start, len+n-start, endtag, taglen)) != NULL)
+		    want = p + taglen - (buf + len);
+		else
+		    want = n;
+	    }
+	    else
+		want = 1;
+	}
+	if ((n = read(fd, buf+len, want)) < 0){
+	    if (errno == EINTR)
+		continue;
+	    clicon_err(OE_UNIX, errno, "read");
+	    goto done;
+	}
+	if (n == 0) /* EOF */
+	    break;
+	len += n;
+	if (endtag && len >= taglen && 
+	    memcmp(buf+len-taglen, endtag, taglen) == 0)
+	    break;
+    }
+    buf[len] = '\0';
+    buf[len+1] = '\0';
+    *bufp = buf;
+    buf = NULL;
+    *lenp = len;
+    retval = 0;
+ done:
+    if (buf)
+	free(buf);
+    return retval;
+}
+
+/*! Read contents of a file descriptor into a buffer that can be scanned in place
+ *
+ * A regular file read from its start is mapped into memory with mmap(),
+ * other input is read in blocks (see file_read_stream for endtag framing).
+ * In both cases the data is followed by two NUL bytes, as required by
+ * flex yy_scan_buffer(), so the buffer can be handed to a scanner without
+ * copying. The buffer is writable but changes are never written back.
+ * @param[in]  fd       File descriptor
+ * @param[in]  endtag   Input ends after this string, or NULL for end-of-file
+ * @param[out] bufp     Buffer, free with clicon_file_unmap()
+ * @param[out] lenp     Length of data, excluding the two NUL bytes
+ * @param[out] maplenp  Length of memory mapping, or 0 if buffer is malloced
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @code
+ *  char  *buf;
+ *  size_t len, maplen;
+ *  if (clicon_file_map(fd, NULL, &buf, &len, &maplen) < 0)
+ *    err;
+ *  ...
+ *  clicon_file_unmap(buf, maplen);
+ * @endcode
+ * @note A mapped file must not be truncated while the buffer is in use
+ */
+int
+clicon_file_map(int     fd,
+		char   *endtag,
+		char  **bufp,
+		size_t *lenp,
+		size_t *maplenp)
+{
+    struct stat st;
+
+    *maplenp = 0;
+    if (fstat(fd, &st) < 0){
+	clicon_err(OE_UNIX, errno, "fstat");
+	return -1;
+    }
+    if (S_ISREG(st.st_mode) && st.st_size > 0 &&
+	lseek(fd, 0, SEEK_CUR) == 0)
+	return file_map_regular(fd, st.st_size, endtag, bufp, lenp, maplenp);
+    return file_read_stream(fd, endtag, S_ISSOCK(st.st_mode), bufp, lenp);
+}
+
+/*! Free buffer returned by clicon_file_map()
+ * @param[in]  buf     Buffer
+ * @param[in]  maplen  Length of memory mapping, or 0 if buffer is malloced
+ */
+int
+clicon_file_unmap(char  *buf,
+		  size_t maplen)
+{
+    if (buf == NULL)
+	return 0;
+    if (maplen)
+	munmap(buf, maplen);
+    else
+	free(buf);
+    return 0;
+}
+
 /*! Translate group name to gid. Return -1 if error or not found.
  * @param[in]   name  Name of group
  * @param[out]  gid   Group id
@@ -44,6 +44,7 @@
 #include <ctype.h>
 #include <limits.h>
 #include <fnmatch.h>
+#include <dirent.h>
 #include <stdint.h>
 #include <syslog.h>
 #include <assert.h>
@@ -54,6 +55,8 @@
 /* clixon */
 #include "clixon_err.h"
 #include "clixon_log.h"
+#include "clixon_file.h"
+#include "clixon_sink.h"
 #include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -69,9 +72,6 @@
 */
 #define VEC_ARRAY 1
 
-/* Size of json read buffer when reading from file*/
-#define BUFLEN 1024
-
 /* Name of xml top object created by xml parse functions */
 #define JSON_TOP_SYMBOL "top"
 
@@ -171,11 +171,11 @@ array_eval(cxobj *xprev,
     ys = xml_spec(x);
     if (xnext && 
 	xml_type(xnext)==CX_ELMNT &&
-	strcmp(xml_name(x),xml_name(xnext))==0)
+	xml_name_eq(x, xml_name(xnext)))
 	eqnext++;
     if (xprev &&
 	xml_type(xprev)==CX_ELMNT &&
-	strcmp(xml_name(x),xml_name(xprev))==0)
+	xml_name_eq(x, xml_name(xprev)))
 	eqprev++;
     if (eqprev && eqnext)
 	array = MIDDLE_ARRAY;
@@ -191,43 +191,148 @@ array_eval(cxobj *xprev,
     return array;
 }
 
-/*! Escape a json string
+/* Set if character must be escaped in a json string, RFC 8259 section 7 */
+#define JSON_ESC(c) ((unsigned char)(c) < 0x20 || (c) == '"' || (c) == '\\')
+
+/* Byte patterns for checking 8 characters at a time, see json_esc_word */
+#define JSON_ONES  0x0101010101010101ULL
+#define JSON_HIGHS 0x8080808080808080ULL
+
+/*! Check if any of 8 characters in a word may need escaping
+ * Tests each byte for < 0x20, '"' and '\\' with integer operations, instead 
+ * of one character at a time. May give false positives, but not false 
+ * negatives.
+ */
+static inline int
+json_esc_word(uint64_t w)
+{
+    uint64_t q = w ^ (JSON_ONES * '"');  /* Zero bytes where '"' */
+    uint64_t b = w ^ (JSON_ONES * '\\'); /* Zero bytes where '\\' */
+
+    return ((((w - JSON_ONES * 0x20) & ~w) |
+	     ((q - JSON_ONES) & ~q) |
+	     ((b - JSON_ONES) & ~b)) & JSON_HIGHS) != 0;
+}
+
+/*! Print a json string value, escaped as defined in RFC 8259 section 7
+ * The string is scanned once and runs of characters that need no escaping are 
+ * written as one block. Long runs are scanned 8 characters at a time.
+ * @param[in]  cs   Output sink
+ * @param[in]  str  String to escape, without quotes
+ * @retval     0    OK
+ * @retval    -1    Error
  */
-static char *
-json_str_escape(char *str)
+static int
+json_str_escape(clicon_sink *cs,
+		char        *str)
 {
-    int   i, j;
-    char *snew;
-
-    j = 0;
-    for (i=0;i<strlen(str);i++)
-	switch (str[i]){
-	case '\n':
-	case '\"':
-	case '\\':
-	    j++;
+    char    *end = str + strlen(str);
+    char    *p = str; /* Next char to check */
+    char    *s = str; /* Start of chars not yet written */
+    uint64_t w;
+    char     esc[8];
+    char    *e;
+
+    while (p < end){
+	while (end - p >= 8){
+	    memcpy(&w, p, 8);
+	    if (json_esc_word(w))
+		break;
+	    p += 8;
+	}
+	while (p < end && !JSON_ESC(*p))
+	    p++;
+	if (p == end)
+	    break;
+	if (p > s && clicon_sink_write(cs, s, p - s) < 0)
+	    return -1;
+	switch (*p){
+	case '"':  e = "\\\""; break;
+	case '\\': e = "\\\\"; break;
+	case '\b': e = "\\b"; break;
+	case '\f': e = "\\f"; break;
+	case '\n': e = "\\n"; break;
+	case '\r': e = "\\r"; break;
+	case '\t': e = "\\t"; break;
+	default:
+	    snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)*p);
+	    e = esc;
 	    break;
 	}
-    if ((snew = malloc(strlen(str)+1+j))==NULL){
-	clicon_err(OE_XML, errno, "malloc");
-	return NULL;
+	if (clicon_sink_puts(cs, e) < 0)
+	    return -1;
+	s = ++p;
     }
-    j = 0;
-    for (i=0;i<strlen(str);i++)
-	switch (str[i]){
-	case '\n':
-	case '\"':
-	case '\\':
-	    snew[j++]='\\';
-	default: /* fall thru */
-	    snew[j++]=str[i];
-	}
-    snew[j++]='\0';
-    return snew;
+    if (end > s && clicon_sink_write(cs, s, end - s) < 0)
+	return -1;
+    return 0;
+}
+
+/*! Check if a value can be printed as a json literal, ie without quotes
+ * Values of YANG number and boolean types are printed as json numbers and 
+ * true/false, but only if they are valid as such (RFC 8259 sections 3 and 6),
+ * eg not "+1" or "01".
+ * @param[in]  str  Value
+ * @retval     1    Number or true/false
+ * @retval     0    Not a json literal, print as string
+ */
+static int
+json_literal(char *str)
+{
+    char *p = str;
+
+    if (strcmp(str, "true") == 0 || strcmp(str, "false") == 0)
+	return 1;
+    if (*p == '-')
+	p++;
+    if (*p == '0')
+	p++;
+    else if (*p >= '1' && *p <= '9')
+	while (*p >= '0' && *p <= '9')
+	    p++;
+    else
+	return 0;
+    if (*p == '.'){
+	p++;
+	if (*p < '0' || *p > '9')
+	    return 0;
+	while (*p >= '0' && *p <= '9')
+	    p++;
+    }
+    return *p == '\0';
+}
+
+/*! Print indentation of a json level if pretty-printed */
+static inline int
+json_indent(clicon_sink *cs,
+	    int          pretty,
+	    int          level)
+{
+    return pretty?clicon_sink_indent(cs, level*JSON_INDENT):0;
+}
+
+/*! Print a newline if pretty-printed */
+static inline int
+json_nl(clicon_sink *cs,
+	int          pretty)
+{
+    return pretty?clicon_sink_putc(cs, '\n'):0;
+}
+
+/*! Print a json object name: "name": */
+static int
+json_name(clicon_sink *cs,
+	  char        *name)
+{
+    if (clicon_sink_putc(cs, '"') < 0 ||
+	clicon_sink_puts(cs, name) < 0 ||
+	clicon_sink_write(cs, "\": ", 3) < 0)
+	return -1;
+    return 0;
 }
 
 /*! Do the actual work of translating XML to JSON 
- * @param[out]   cb        Cligen text buffer containing json on exit
+ * @param[in]    cs        Output sink
  * @param[in]    x         XML tree structure containing XML to translate
  * @param[in]    arraytype Does x occur in a array (of its parent) and how?
  * @param[in]    level     Indentation level
@@ -264,7 +369,7 @@ json_str_escape(char *str)
   +----------+--------------+--------------+--------------+
  */
 static int 
-xml2json1_cbuf(cbuf                  *cb,
+xml2json1_sink(clicon_sink           *cs,
 	       cxobj                 *x,
 	       enum array_element_type arraytype,
 	       int                    level,
@@ -283,36 +388,38 @@ xml2json1_cbuf(cbuf                  *cb,
     childt = childtype(x);
     ys = xml_spec(x);
     if (pretty==2)
-	cprintf(cb, "#%s_array, %s_child ", 
-		arraytype2str(arraytype),
-		childtype2str(childt));
+	if (clicon_sink_printf(cs, "#%s_array, %s_child ", 
+			       arraytype2str(arraytype),
+			       childtype2str(childt)) < 0)
+	    goto done;
     switch(arraytype){
     case BODY_ARRAY:{
-	if (bodystr){
-	    char      *str;
-	    if ((str = json_str_escape(xml_value(x))) == NULL)
+	if (!bodystr && json_literal(xml_value(x))){
+	    if (clicon_sink_puts(cs, xml_value(x)) < 0)
 		goto done;
-	    cprintf(cb, "\"%s\"", str);
-	    free(str);
 	}
 	else
-	    cprintf(cb, "%s", xml_value(x));
-
+	    if (clicon_sink_putc(cs, '"') < 0 ||
+		json_str_escape(cs, xml_value(x)) < 0 ||
+		clicon_sink_putc(cs, '"') < 0)
+		goto done;
 	break;
     }
     case NO_ARRAY:
 	if (!flat)
-	    cprintf(cb, "%*s\"%s\": ", 
-		    pretty?(level*JSON_INDENT):0, "", 
-		    xml_name(x));
+	    if (json_indent(cs, pretty, level) < 0 ||
+		json_name(cs, xml_name(x)) < 0)
+		goto done;
 	switch (childt){
 	case NULL_CHILD:
-	    cprintf(cb, "null");
+	    if (clicon_sink_write(cs, "null", 4) < 0)
+		goto done;
 	    break;
 	case BODY_CHILD:
 	    break;
 	case ANY_CHILD:
-	    cprintf(cb, "{%s", pretty?"\n":"");
+	    if (clicon_sink_putc(cs, '{') < 0 || json_nl(cs, pretty) < 0)
+		goto done;
 	    break;
 	default:
 	    break;
@@ -320,21 +427,24 @@ xml2json1_cbuf(cbuf                  *cb,
 	break;
     case FIRST_ARRAY:
     case SINGLE_ARRAY:
-	cprintf(cb, "%*s\"%s\": ", 
-		pretty?(level*JSON_INDENT):0, "", 
-		xml_name(x));
+	if (json_indent(cs, pretty, level) < 0 ||
+	    json_name(cs, xml_name(x)) < 0)
+	    goto done;
 	level++;
-	cprintf(cb, "[%s%*s", 
-		pretty?"\n":"",
-		pretty?(level*JSON_INDENT):0, "");
+	if (clicon_sink_putc(cs, '[') < 0 || 
+	    json_nl(cs, pretty) < 0 ||
+	    json_indent(cs, pretty, level) < 0)
+	    goto done;
 	switch (childt){
 	case NULL_CHILD:
-	    cprintf(cb, "null");
+	    if (clicon_sink_write(cs, "null", 4) < 0)
+		goto done;
 	    break;
 	case BODY_CHILD:
 	    break;
 	case ANY_CHILD:
-	    cprintf(cb, "{%s", pretty?"\n":"");
+	    if (clicon_sink_putc(cs, '{') < 0 || json_nl(cs, pretty) < 0)
+		goto done;
 	    break;
 	default:
 	    break;
@@ -343,16 +453,18 @@ xml2json1_cbuf(cbuf                  *cb,
     case MIDDLE_ARRAY:
     case LAST_ARRAY:
 	level++;
-	cprintf(cb, "%*s", 
-		pretty?(level*JSON_INDENT):0, "");
+	if (json_indent(cs, pretty, level) < 0)
+	    goto done;
 	switch (childt){
 	case NULL_CHILD:
-	    cprintf(cb, "null");
+	    if (clicon_sink_write(cs, "null", 4) < 0)
+		goto done;
 	    break;
 	case BODY_CHILD:
 	    break;
 	case ANY_CHILD:
-	    cprintf(cb, "{ %s", pretty?"\n":"");
+	    if (clicon_sink_write(cs, "{ ", 2) < 0 || json_nl(cs, pretty) < 0)
+		goto done;
 	    break;
 	default:
 	    break;
@@ -390,13 +502,14 @@ xml2json1_cbuf(cbuf                  *cb,
 	xc_arraytype = array_eval(i?xml_child_i(x,i-1):NULL, 
 				xc, 
 				xml_child_i(x, i+1));
-	if (xml2json1_cbuf(cb, 
+	if (xml2json1_sink(cs, 
 			   xc, 
 			   xc_arraytype,
 			   level+1, pretty, 0, bodystr0) < 0)
 	    goto done;
 	if (i<xml_child_nr(x)-1)
-	    cprintf(cb, ",%s", pretty?"\n":"");
+	    if (clicon_sink_putc(cs, ',') < 0 || json_nl(cs, pretty) < 0)
+		goto done;
     }
     switch (arraytype){
     case BODY_ARRAY:
@@ -407,9 +520,10 @@ xml2json1_cbuf(cbuf                  *cb,
 	case BODY_CHILD:
 	    break;
 	case ANY_CHILD:
-	    cprintf(cb, "%s%*s}", 
-		    pretty?"\n":"",
-		    pretty?(level*JSON_INDENT):0, "");
+	    if (json_nl(cs, pretty) < 0 ||
+		json_indent(cs, pretty, level) < 0 ||
+		clicon_sink_putc(cs, '}') < 0)
+		goto done;
 	    break;
 	default:
 	    break;
@@ -423,9 +537,10 @@ xml2json1_cbuf(cbuf                  *cb,
 	case BODY_CHILD:
 	    break;
 	case ANY_CHILD:
-	    cprintf(cb, "%s%*s}", 
-		    pretty?"\n":"",
-		    pretty?(level*JSON_INDENT):0, "");
+	    if (json_nl(cs, pretty) < 0 ||
+		json_indent(cs, pretty, level) < 0 ||
+		clicon_sink_putc(cs, '}') < 0)
+		goto done;
 	    level--;
 	    break;
 	default:
@@ -437,20 +552,23 @@ xml2json1_cbuf(cbuf                  *cb,
 	switch (childt){
 	case NULL_CHILD:
 	case BODY_CHILD:
-	    cprintf(cb, "%s",pretty?"\n":"");
+	    if (json_nl(cs, pretty) < 0)
+		goto done;
 	    break;
 	case ANY_CHILD:
-	    cprintf(cb, "%s%*s}", 
-		    pretty?"\n":"",
-		    pretty?(level*JSON_INDENT):0, "");
-	    cprintf(cb, "%s",pretty?"\n":"");
+	    if (json_nl(cs, pretty) < 0 ||
+		json_indent(cs, pretty, level) < 0 ||
+		clicon_sink_putc(cs, '}') < 0 ||
+		json_nl(cs, pretty) < 0)
+		goto done;
 	    level--;
 	    break;
 	default:
 	    break;
 	}
-	cprintf(cb, "%*s]",
-		pretty?(level*JSON_INDENT):0,"");
+	if (json_indent(cs, pretty, level) < 0 ||
+	    clicon_sink_putc(cs, ']') < 0)
+	    goto done;
 	break;
     default:
 	break;
@@ -460,6 +578,39 @@ xml2json1_cbuf(cbuf                  *cb,
     return retval;
 }
 
+/*! Translate an XML tree to JSON and print it to an output sink
+ *
+ * @param[in]     cs     Output sink
+ * @param[in]     x      XML tree to translate from
+ * @param[in]     pretty Set if output is pretty-printed
+ * @retval        0      OK
+ * @retval       -1      Error
+ * @see xml2json_cbuf
+ */
+int 
+xml2json_sink(clicon_sink *cs, 
+	      cxobj       *x, 
+	      int          pretty)
+{
+    int    retval = -1;
+    int    level = 0;
+
+    if (clicon_sink_putc(cs, '{') < 0 || json_nl(cs, pretty) < 0)
+	goto done;
+    if (xml2json1_sink(cs, 
+		       x, 
+		       NO_ARRAY,
+		       level+1, pretty,0,1) < 0)
+	goto done;
+    if (json_nl(cs, pretty) < 0 ||
+	clicon_sink_putc(cs, '}') < 0 ||
+	json_nl(cs, pretty) < 0)
+	goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Translate an XML tree to JSON in a CLIgen buffer
  *
  * @param[in,out] cb     Cligen buffer to write to
@@ -477,36 +628,83 @@ xml2json1_cbuf(cbuf                  *cb,
  * cbuf_free(cb);
  * @endcode
  * @see clicon_xml2cbuf
+ * @see xml2json_sink
  */
 int 
 xml2json_cbuf(cbuf      *cb, 
 	      cxobj     *x, 
 	      int        pretty)
 {
-    int    retval = 1;
-    int    level = 0;
+    int          retval = -1;
+    clicon_sink *cs;
 
-    cprintf(cb, "%*s{%s", 
-	    pretty?level*JSON_INDENT:0,"", 
-	    pretty?"\n":"");
-    if (xml2json1_cbuf(cb, 
-		       x, 
-		       NO_ARRAY,
-		       level+1, pretty,0,1) < 0)
+    if ((cs = clicon_sink_cbuf(cb)) == NULL)
 	goto done;
-    cprintf(cb, "%s%*s}%s", 
-	    pretty?"\n":"",
-	    pretty?level*JSON_INDENT:0,"",
-	    pretty?"\n":"");
+    retval = xml2json_sink(cs, x, pretty);
+    if (clicon_sink_close(cs) < 0)
+	retval = -1;
+ done:
+    return retval;
+}
 
+/*! Translate a vector of xml objects to JSON and print it to an output sink
+ * The vector is printed as the children of a top pseudo-object, without
+ * printing the pseudo-object itself (the 'flat' option of xml2json1_sink), and
+ * without copying the objects.
+ * @param[in]  cs     Output sink
+ * @param[in]  vec    Vector of xml objecst
+ * @param[in]  veclen Length of vector
+ * @param[in]  pretty Set if output is pretty-printed (2 for debug)
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @note This only works if the vector is uniform, ie same object name.
+ * Example: <b/><c/> --> <a><b/><c/></a> --> {"b" : null,"c" : null}
+ * @see xml2json1_sink
+ */
+int 
+xml2json_sink_vec(clicon_sink *cs, 
+		  cxobj      **vec,
+		  size_t       veclen,
+		  int          pretty)
+{
+    int    retval = -1;
+    int    level = 1; /* of pseudo-object */
+    int    i;
+
+    if (pretty==2)
+	if (clicon_sink_printf(cs, "#%s_array, %s_child ", 
+			       arraytype2str(NO_ARRAY),
+			       childtype2str(veclen?ANY_CHILD:NULL_CHILD)) < 0)
+	    goto done;
+    if (veclen == 0){
+	if (clicon_sink_write(cs, "null", 4) < 0)
+	    goto done;
+	goto ok;
+    }
+    if (clicon_sink_putc(cs, '{') < 0 || json_nl(cs, pretty) < 0)
+	goto done;
+    for (i=0; i<veclen; i++){
+	if (xml2json1_sink(cs, 
+			   vec[i], 
+			   array_eval(i?vec[i-1]:NULL, vec[i], 
+				      i<veclen-1?vec[i+1]:NULL),
+			   level+1, pretty, 0, 1) < 0)
+	    goto done;
+	if (i<veclen-1)
+	    if (clicon_sink_putc(cs, ',') < 0 || json_nl(cs, pretty) < 0)
+		goto done;
+    }
+    if (json_nl(cs, pretty) < 0 ||
+	json_indent(cs, pretty, level) < 0 ||
+	clicon_sink_putc(cs, '}') < 0)
+	goto done;
+ ok:
     retval = 0;
  done:
     return retval;
 }
 
 /*! Translate a vector of xml objects to JSON CLigen buffer.
- * This is done by adding a top pseudo-object, and add the vector as subs,
- * and then not printing the top pseudo-object using the 'flat' option.
  * @param[out] cb     Cligen buffer to write to
  * @param[in]  vec    Vector of xml objecst
  * @param[in]  veclen Length of vector
@@ -515,7 +713,7 @@ xml2json_cbuf(cbuf      *cb,
  * @retval    -1      Error
  * @note This only works if the vector is uniform, ie same object name.
  * Example: <b/><c/> --> <a><b/><c/></a> --> {"b" : null,"c" : null}
- * @see xml2json1_cbuf
+ * @see xml2json_sink_vec
  */
 int 
 xml2json_cbuf_vec(cbuf      *cb, 
@@ -523,38 +721,15 @@ xml2json_cbuf_vec(cbuf      *cb,
 		  size_t     veclen,
 		  int        pretty)
 {
-    int    retval = -1;
-    int    level = 0;
-    int    i;
-    cxobj *xp = NULL;
-    cxobj *xc;
+    int          retval = -1;
+    clicon_sink *cs;
 
-    if ((xp = xml_new("", NULL, NULL)) == NULL)
+    if ((cs = clicon_sink_cbuf(cb)) == NULL)
 	goto done;
-    for (i=0; i<veclen; i++){
-	xc = xml_dup(vec[i]);
-	xml_addsub(xp, xc);
-    }
-    if (0){
-	cprintf(cb, "[%s", pretty?"\n":" ");
-	level++;
-    }
-    if (xml2json1_cbuf(cb, 
-		       xp, 
-		       NO_ARRAY,
-		       level+1, pretty,1, 1) < 0)
-	goto done;
-
-    if (0){
-	level--;
-	cprintf(cb, "%s]%s", 
-	    pretty?"\n":"",
-	    pretty?"\n":""); /* top object */
-    }
-    retval = 0;
+    retval = xml2json_sink_vec(cs, vec, veclen, pretty);
+    if (clicon_sink_close(cs) < 0)
+	retval = -1;
  done:
-    if (xp)
-	xml_free(xp);
     return retval;
 }
 
@@ -577,27 +752,20 @@ xml2json(FILE      *f,
 	 cxobj     *x, 
 	 int        pretty)
 {
-    int   retval = 1;
-    cbuf *cb = NULL;
+    int          retval = -1;
+    clicon_sink *cs;
 
-    if ((cb = cbuf_new()) ==NULL){
-	clicon_err(OE_XML, errno, "cbuf_new");
+    if ((cs = clicon_sink_file(f)) == NULL)
 	goto done;
-    }
-    if (xml2json_cbuf(cb, x, pretty) < 0)
-	goto done;
-    fprintf(f, "%s", cbuf_get(cb));
-    retval = 0;
+    retval = xml2json_sink(cs, x, pretty);
+    if (clicon_sink_close(cs) < 0)
+	retval = -1;
  done:
-    if (cb)
-	cbuf_free(cb);
     return retval;
 }
 
 /*! Translate a vector of xml objects to JSON File.
- * This is done by adding a top pseudo-object, and add the vector as subs,
- * and then not pritning the top pseudo-.object using the 'flat' option.
- * @param[out] cb     Cligen buffer to write to
+ * @param[in]  f      File to print to
  * @param[in]  vec    Vector of xml objecst
  * @param[in]  veclen Length of vector
  * @param[in]  pretty Set if output is pretty-printed (2 for debug)
@@ -605,7 +773,7 @@ xml2json(FILE      *f,
  * @retval    -1      Error
  * @note This only works if the vector is uniform, ie same object name.
  * Example: <b/><c/> --> <a><b/><c/></a> --> {"b" : null,"c" : null}
- * @see xml2json1_cbuf
+ * @see xml2json_sink_vec
  */
 int 
 xml2json_vec(FILE      *f, 
@@ -613,30 +781,28 @@ xml2json_vec(FILE      *f,
 	     size_t     veclen,
 	     int        pretty)
 {
-    int   retval = 1;
-    cbuf *cb = NULL;
+    int          retval = -1;
+    clicon_sink *cs;
 
-    if ((cb = cbuf_new()) ==NULL){
-	clicon_err(OE_XML, errno, "cbuf_new");
-	goto done;
-    }
-    if (xml2json_cbuf_vec(cb, vec, veclen, pretty) < 0)
+    if ((cs = clicon_sink_file(f)) == NULL)
 	goto done;
-    fprintf(f, "%s", cbuf_get(cb));
-    retval = 0;
+    retval = xml2json_sink_vec(cs, vec, veclen, pretty);
+    if (clicon_sink_close(cs) < 0)
+	retval = -1;
  done:
-    if (cb)
-	cbuf_free(cb);
     return retval;
 }
 
 /*! Parse a string containing JSON and return an XML tree
  * @param[in]  str    Input string containing JSON
+ * @param[in]  len    If set, str is followed by two NULs and scanned in place
+ *                    without copying. len includes the NULs. See clicon_file_map
  * @param[in]  name   Log string, typically filename
  * @param[out] xt     XML top of tree typically w/o children on entry (but created)
  */
 static int 
 json_parse(char       *str, 
+	   size_t      len,
 	   const char *name, 
 	   cxobj      *xt)
 {
@@ -645,6 +811,7 @@ json_parse(char       *str,
 
     //    clicon_debug(1, "%s", __FUNCTION__);
     jy.jy_parse_string = str;
+    jy.jy_parse_len = len;
     jy.jy_name = name;
     jy.jy_linenum = 1;
     jy.jy_current = xt;
@@ -685,9 +852,9 @@ int
 json_parse_str(char   *str, 
 	       cxobj **xt)
 {
-    if ((*xt = xml_new("top", NULL, NULL)) == NULL)
+    if ((*xt = xml_new_arena("top", NULL)) == NULL)
 	return -1;
-    return json_parse(str, "", *xt);
+    return json_parse(str, 0, "", *xt);
 }
 
 /*! Read a JSON definition from file and parse it into a parse-tree. 
@@ -707,63 +874,34 @@ json_parse_str(char   *str,
  * @note  you need to free the xml parse tree after use, using xml_free()
  * @note, If xt empty, a top-level symbol will be added so that <tree../> will be:  <top><tree.../></tree></top>
  * @note May block on file I/O
+ * @see clicon_file_map  Regular files are memory mapped, streams read in blocks
  */
 int 
 json_parse_file(int        fd,
 		yang_spec *yspec,
 		cxobj    **xt)
 {
-    int   retval = -1;
-    int   ret;
-    char *jsonbuf = NULL;
-    int   jsonbuflen = BUFLEN; /* start size */
-    int   oldjsonbuflen;
-    char *ptr;
-    char  ch;
-    int   len = 0;
-    
-    if ((jsonbuf = malloc(jsonbuflen)) == NULL){
-	clicon_err(OE_XML, errno, "%s: malloc", __FUNCTION__);
+    int    retval = -1;
+    char  *buf = NULL;
+    size_t len = 0;
+    size_t maplen = 0;
+    cxobj *xtop = NULL;
+
+    if (clicon_file_map(fd, NULL, &buf, &len, &maplen) < 0)
+	goto done;
+    if (*xt == NULL)
+	if ((*xt = xtop = xml_new_arena(JSON_TOP_SYMBOL, NULL)) == NULL)
+	    goto done;
+    if (len && json_parse(buf, len + 2, "", *xt) < 0)
 	goto done;
-    }
-    memset(jsonbuf, 0, jsonbuflen);
-    ptr = jsonbuf;
-    while (1){
-	if ((ret = read(fd, &ch, 1)) < 0){
-	    clicon_err(OE_XML, errno, "%s: read: [pid:%d]\n", 
-		    __FUNCTION__,
-		    (int)getpid());
-	    break;
-	}
-	if (ret != 0)
-	    jsonbuf[len++] = ch;
-	if (ret == 0){
-	    if (*xt == NULL)
-		if ((*xt = xml_new(JSON_TOP_SYMBOL, NULL, NULL)) == NULL)
-		    goto done;
-	    if (len && json_parse(ptr, "", *xt) < 0)
-		goto done;
-	    break;
-	}
-	if (len>=jsonbuflen-1){ /* Space: one for the null character */
-	    oldjsonbuflen = jsonbuflen;
-	    jsonbuflen *= 2;
-	    if ((jsonbuf = realloc(jsonbuf, jsonbuflen)) == NULL){
-		clicon_err(OE_XML, errno, "%s: realloc", __FUNCTION__);
-		goto done;
-	    }
-	    memset(jsonbuf+oldjsonbuflen, 0, jsonbuflen-oldjsonbuflen);
-	    ptr = jsonbuf;
-	}
-    }
     retval = 0;
  done:
-    if (retval < 0 && *xt){
-	free(*xt);
+    if (retval < 0 && xtop){
+	xml_free(xtop);
 	*xt = NULL;
     }
-    if (jsonbuf)
-	free(jsonbuf);
+    if (buf)
+	clicon_file_unmap(buf, maplen);
     return retval;    
 }
 
@@ -43,6 +43,8 @@ struct clicon_json_yacc_arg{ /* XXX: mostly unrelevant */
     const char           *jy_name;         /* Name of syntax (for error string) */
     int                   jy_linenum;      /* Number of \n in parsed buffer */
     char                 *jy_parse_string; /* original (copy of) parse string */
+    size_t                jy_parse_len;    /* If set, parse string is scanned in place:
+					      length including two trailing NULs */
     void                 *jy_lexbuf;       /* internal parse buffer from lex */
     cxobj                *jy_current;
 };
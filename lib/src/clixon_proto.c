@@ -161,7 +161,8 @@ clicon_msg_encode(char *format, ...)
 
 /*! Decode a clicon netconf message
  * @param[in]  msg    CLICON msg
- * @param[out] xml    XML parse tree
+ * @param[out] xml    XML parse tree. Allocated in an arena if NULL on entry
+ * @see xml_new_arena
  */
 int
 clicon_msg_decode(struct clicon_msg *msg, 
@@ -216,6 +217,41 @@ clicon_connect_unix(char *sockpath)
     return retval;
 }
 
+/*! Open connection using inet (TCP) sockets
+ * @param[in]  dst     IPv4 address
+ * @param[in]  port    TCP port
+ * @retval     s       socket
+ * @retval     -1      error
+ */
+int
+clicon_connect_inet(char    *dst,
+		    uint16_t port)
+{
+    int                retval = -1;
+    int                s = -1;
+    struct sockaddr_in addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(addr.sin_family, dst, &addr.sin_addr) != 1){
+	clicon_err(OE_CFG, EINVAL, "%s: not an IPv4 address", dst);
+	goto done; /* Could check getaddrinfo */
+    }
+    if ((s = socket(addr.sin_family, SOCK_STREAM, 0)) < 0) {
+	clicon_err(OE_CFG, errno, "socket");
+	goto done;
+    }
+    if (connect(s, (struct sockaddr*)&addr, sizeof(addr)) < 0){
+	clicon_err(OE_CFG, errno, "connecting socket inet4");
+	close(s);
+	goto done;
+    }
+    retval = s;
+  done:
+    return retval;
+}
+
 static void
 atomicio_sig_handler(int arg)
 {
@@ -312,6 +348,155 @@ clicon_msg_send(int                s,
     return retval;
 }
 
+/*! Receive the body of a chunked CLICON message, see CLICON_MSG_CHUNKED
+ * @param[in]   s      socket (unix or inet) to communicate with backend
+ * @param[out]  msg    CLICON msg with actual length. Free with free()
+ * @retval      0      OK
+ * @retval     -1      Error
+ */
+static int
+clicon_msg_rcv_chunked(int                 s,
+		       struct clicon_msg **msg)
+{
+    int                retval = -1;
+    struct clicon_msg *m = NULL;
+    struct clicon_msg *m1;
+    size_t             len = sizeof(*m); /* Received, including header */
+    size_t             max = 0;          /* Allocated */
+    uint32_t           clen;
+    int                n;
+
+    while (1){
+	if ((n = atomicio(read, s, &clen, sizeof(clen))) < 0){
+	    clicon_err(OE_CFG, errno, "%s: read", __FUNCTION__);
+	    goto done;
+	}
+	if (n != sizeof(clen)){
+	    clicon_err(OE_CFG, errno, "%s: chunk header too short", __FUNCTION__);
+	    goto done;
+	}
+	if ((clen = ntohl(clen)) == 0)
+	    break;
+	if (len + clen > max){
+	    max = max?2*max:4096;
+	    while (len + clen > max)
+		max *= 2;
+	    if ((m1 = realloc(m, max)) == NULL){
+		clicon_err(OE_CFG, errno, "realloc");
+		goto done;
+	    }
+	    m = m1;
+	}
+	if ((n = atomicio(read, s, (char*)m + len, clen)) < 0){
+	    clicon_err(OE_CFG, errno, "%s: read", __FUNCTION__);
+	    goto done;
+	}
+	if (n != clen){
+	    clicon_err(OE_CFG, errno, "%s: chunk too short", __FUNCTION__);
+	    goto done;
+	}
+	len += clen;
+    }
+    if (m == NULL && (m = malloc(len)) == NULL){ /* Empty */
+	clicon_err(OE_CFG, errno, "malloc");
+	goto done;
+    }
+    m->op_len = htonl(len);
+    *msg = m;
+    m = NULL;
+    retval = 0;
+ done:
+    if (m)
+	free(m);
+    return retval;
+}
+
+/*! Get a CLICON message from a buffer of received data
+ * Used to receive messages on a non-blocking socket: data is read into a buffer
+ * as it arrives, and messages are taken from the buffer when complete.
+ * @param[in]   buf    Received data
+ * @param[in]   len    Length of buf
+ * @param[out]  msg    CLICON msg if complete, with actual length. Free with free()
+ * @param[out]  used   Length of message in buf, if complete
+ * @retval      1      Complete message returned
+ * @retval      0      Message not complete, need more data
+ * @retval     -1      Error, invalid message
+ * A chunked message (see CLICON_MSG_CHUNKED) is returned as a plain message.
+ * @see clicon_msg_rcv  for blocking sockets
+ */
+int
+clicon_msg_parse(char               *buf,
+		 size_t              len,
+		 struct clicon_msg **msg,
+		 size_t             *used)
+{
+    int                retval = -1;
+    struct clicon_msg *m = NULL;
+    uint32_t           mlen;
+    uint32_t           clen;
+    size_t             off;
+    size_t             blen = 0; /* Length of body */
+
+    if (len < sizeof(mlen))
+	return 0;
+    memcpy(&mlen, buf, sizeof(mlen));
+    mlen = ntohl(mlen);
+    if (mlen != CLICON_MSG_CHUNKED){
+	if (mlen < sizeof(*m)){
+	    clicon_err(OE_PROTO, EINVAL, "%s: invalid length %u", __FUNCTION__, mlen);
+	    goto done;
+	}
+	if (len < mlen)
+	    return 0;
+	if ((m = malloc(mlen)) == NULL){
+	    clicon_err(OE_PROTO, errno, "malloc");
+	    goto done;
+	}
+	memcpy(m, buf, mlen);
+	*used = mlen;
+	goto ok;
+    }
+    /* Chunked: find end of last chunk before copying */
+    off = sizeof(mlen);
+    while (1){
+	if (len - off < sizeof(clen))
+	    return 0;
+	memcpy(&clen, buf + off, sizeof(clen));
+	off += sizeof(clen);
+	if ((clen = ntohl(clen)) == 0)
+	    break;
+	if (len - off < clen)
+	    return 0;
+	off += clen;
+	blen += clen;
+    }
+    *used = off;
+    if ((m = malloc(sizeof(*m) + blen)) == NULL){
+	clicon_err(OE_PROTO, errno, "malloc");
+	goto done;
+    }
+    m->op_len = htonl(sizeof(*m) + blen);
+    blen = 0;
+    off = sizeof(mlen);
+    while (1){
+	memcpy(&clen, buf + off, sizeof(clen));
+	off += sizeof(clen);
+	if ((clen = ntohl(clen)) == 0)
+	    break;
+	memcpy(m->op_body + blen, buf + off, clen);
+	off += clen;
+	blen += clen;
+    }
+ ok:
+    *msg = m;
+    m = NULL;
+    retval = 1;
+ done:
+    if (m)
+	free(m);
+    return retval;
+}
+
 /*! Receive a CLICON message
  *
  * XXX: timeout? and signals?
@@ -326,6 +511,7 @@ clicon_msg_send(int                s,
  * @param[out]  msg    CLICON msg data reply structure. Free with free()
  * @param[out]  eof    Set if eof encountered
  * Note: caller must ensure that s is closed if eof is set after call.
+ * A chunked message (see CLICON_MSG_CHUNKED) is returned as a plain message
  */
 int
 clicon_msg_rcv(int                s,
@@ -359,6 +545,15 @@ clicon_msg_rcv(int                s,
     mlen = ntohl(hdr.op_len);
     clicon_debug(2, "%s: rcv msg len=%d",  
 		 __FUNCTION__, mlen);
+    if (mlen == CLICON_MSG_CHUNKED){
+	if (clicon_msg_rcv_chunked(s, msg) < 0)
+	    goto done;
+	goto ok;
+    }
+    if (mlen < sizeof(hdr)){
+	clicon_err(OE_CFG, 0, "%s: invalid length %u", __FUNCTION__, mlen);
+	goto done;
+    }
     if ((*msg = (struct clicon_msg *)malloc(mlen)) == NULL){
 	clicon_err(OE_CFG, errno, "malloc");
 	goto done;
@@ -372,6 +567,7 @@ clicon_msg_rcv(int                s,
 	clicon_err(OE_CFG, errno, "%s: body too short", __FUNCTION__);
 	goto done;
     }
+  ok:
     if (debug > 1)
 	msg_dump(*msg);
     retval = 0;
@@ -444,26 +640,10 @@ clicon_rpc_connect_inet(struct clicon_msg *msg,
 {
     int                retval = -1;
     int                s = -1;
-    struct sockaddr_in addr;
 
     clicon_debug(1, "Send msg to %s:%hu", dst, port);
-
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-    if (inet_pton(addr.sin_family, dst, &addr.sin_addr) != 1)
-	goto done; /* Could check getaddrinfo */
-    
-    /* special error handling to get understandable messages (otherwise ENOENT) */
-    if ((s = socket(addr.sin_family, SOCK_STREAM, 0)) < 0) {
-	clicon_err(OE_CFG, errno, "socket");
-	return -1;
-    }
-    if (connect(s, (struct sockaddr*)&addr, sizeof(addr)) < 0){
-	clicon_err(OE_CFG, errno, "connecting socket inet4");
-	close(s);
+    if ((s = clicon_connect_inet(dst, port)) < 0)
 	goto done;
-    }
     if (clicon_rpc(s, msg, retdata) < 0)
 	goto done;
     if (sock0 != NULL)
@@ -47,6 +47,8 @@
 #include <errno.h>
 #include <assert.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <sys/syslog.h>
@@ -68,6 +70,379 @@
 #include "clixon_err.h"
 #include "clixon_proto_client.h"
 
+/*
+ * Persistent session to the backend
+ * A client keeps one socket to the backend in the clicon handle and sends all
+ * its rpcs on it, instead of connecting for each rpc. The backend handles the
+ * messages of a socket one at a time in the order they arrive, so a reply is
+ * matched to its request by a message id which is the sequence number of the
+ * request on the session. Several requests may be sent before their replies
+ * are read, see clicon_rpc_msg_send() and clicon_rpc_msg_rcv().
+ * If the backend closes the socket, eg when restarted, the session is
+ * reconnected on the next request. Replies of outstanding requests are then
+ * lost.
+ */
+
+/* Reply read from the session socket but not yet asked for */
+struct rpc_reply{
+    uint32_t  rr_id;      /* Message id of request */
+    char     *rr_data;    /* Reply body as string */
+};
+
+/* Backend session, stored in the clicon handle */
+struct rpc_session{
+    int               rs_s;       /* Socket, or -1 if not connected */
+    int               rs_broken;  /* Send failed, only read replies */
+    uint32_t          rs_next;    /* Message id of next request */
+    uint32_t          rs_rcvd;    /* Message id of next reply on socket */
+    struct rpc_reply *rs_replies; /* Replies read but not yet asked for */
+    int               rs_nreplies;
+};
+
+/*! Get backend session of handle, create it if not exists
+ * @param[in]  h    CLICON handle
+ * @param[in]  add  If set, create session if not exists
+ * @retval     rs   Session
+ * @retval     NULL No session (add not set) or error
+ */
+static struct rpc_session *
+rpc_session_get(clicon_handle h,
+		int           add)
+{
+    clicon_hash_t      *cdat = clicon_data(h);
+    struct rpc_session *rs = NULL;
+    void               *p;
+
+    if ((p = hash_value(cdat, "rpc_session", NULL)) != NULL)
+	return *(struct rpc_session **)p;
+    if (!add)
+	return NULL;
+    if ((rs = malloc(sizeof(*rs))) == NULL){
+	clicon_err(OE_UNIX, errno, "malloc");
+	return NULL;
+    }
+    memset(rs, 0, sizeof(*rs));
+    rs->rs_s = -1;
+    if (hash_add(cdat, "rpc_session", &rs, sizeof(rs)) == NULL){
+	free(rs);
+	return NULL;
+    }
+    return rs;
+}
+
+/*! Close the socket of a backend session, replies of outstanding requests are lost
+ * @param[in]  rs   Session
+ */
+static void
+rpc_session_reset(struct rpc_session *rs)
+{
+    if (rs->rs_s != -1){
+	close(rs->rs_s);
+	rs->rs_s = -1;
+    }
+    rs->rs_broken = 0;
+    rs->rs_rcvd = rs->rs_next;
+}
+
+/*! Connect backend session to the backend
+ * @param[in]  h    CLICON handle
+ * @param[in]  rs   Session
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+rpc_session_connect(clicon_handle       h,
+		    struct rpc_session *rs)
+{
+    int         retval = -1;
+    char       *sock;
+    int         port;
+    int         s = -1;
+    struct stat sb;
+
+    if ((sock = clicon_sock(h)) == NULL){
+	clicon_err(OE_FATAL, 0, "CLICON_SOCK option not set");
+	goto done;
+    }
+    /* What to do if inet socket? */
+    switch (clicon_sock_family(h)){
+    case AF_UNIX:
+	/* special error handling to get understandable messages (otherwise ENOENT) */
+	if (stat(sock, &sb) < 0){
+	    clicon_err(OE_PROTO, errno, "%s: config daemon not running?", sock);
+	    goto done;
+	}
+	if (!S_ISSOCK(sb.st_mode)){
+	    clicon_err(OE_PROTO, EIO, "%s: Not unix socket", sock);
+	    goto done;
+	}
+	if ((s = clicon_connect_unix(sock)) < 0)
+	    goto done;
+	break;
+    case AF_INET:
+	if ((port = clicon_sock_port(h)) < 0){
+	    clicon_err(OE_FATAL, 0, "CLICON_SOCK_PORT not set");
+	    goto done;
+	}
+	if ((s = clicon_connect_inet(sock, port)) < 0)
+	    goto done;
+	break;
+    default:
+	clicon_err(OE_FATAL, 0, "CLICON_SOCK_FAMILY not supported");
+	goto done;
+    }
+    /* Do not leak session to forked programs, eg from cli commands */
+    if (fcntl(s, F_SETFD, FD_CLOEXEC) < 0){
+	clicon_err(OE_UNIX, errno, "fcntl");
+	close(s);
+	goto done;
+    }
+    clicon_debug(1, "%s: session to %s", __FUNCTION__, sock);
+    rs->rs_s = s;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if an idle session socket has been closed by the backend
+ * Nothing is expected on an idle socket, so if it is readable, the backend
+ * has closed it (or it is out of sync) and the session is reconnected.
+ * @param[in]  s    Socket
+ * @retval     1    Closed, or out of sync
+ * @retval     0    Open
+ */
+static int
+rpc_session_closed(int s)
+{
+    struct pollfd pfd;
+
+    pfd.fd = s;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return poll(&pfd, 1, 0) != 0;
+}
+
+/*! Parse reply from backend
+ * @param[in]  h       CLICON handle
+ * @param[in]  retdata Reply as string, or NULL
+ * @param[out] xret0   Return value from backend as xml tree. Free w xml_free
+ */
+static int
+rpc_reply_parse(clicon_handle h, 
+		char         *retdata,
+		cxobj       **xret0)
+{
+    int        retval = -1;
+    cxobj     *xret = NULL;
+    yang_spec *yspec;
+
+    clicon_debug(1, "%s retdata:%s", __FUNCTION__, retdata);
+    if (retdata){
+ 	yspec = clicon_dbspec_yang(h);
+	if (xml_parse_string(retdata, yspec, &xret) < 0)
+	    goto done;
+    }
+    if (xret0){
+	*xret0 = xret;
+	xret = NULL;
+    }
+    retval = 0;
+ done:
+    if (xret)
+	xml_free(xret);
+    return retval;
+}
+
+/*! Send internal netconf rpc from client to backend without waiting for reply
+ * The request is sent on the backend session of the handle, which is connected
+ * if needed. Several requests may be sent before their replies are read.
+ * @param[in]  h      CLICON handle
+ * @param[in]  msg    Encoded message. Deallocate with free
+ * @param[out] id     Message id of request, to use in clicon_rpc_msg_rcv()
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *   uint32_t id1, id2;
+ *   if (clicon_rpc_msg_send(h, msg1, &id1) < 0 ||
+ *       clicon_rpc_msg_send(h, msg2, &id2) < 0)
+ *      err;
+ *   if (clicon_rpc_msg_rcv(h, id1, &xret1) < 0 ||
+ *       clicon_rpc_msg_rcv(h, id2, &xret2) < 0)
+ *      err;
+ * @endcode
+ * @note All requests sent must be read with clicon_rpc_msg_rcv()
+ * @note The backend does not read the next request until the reply of the 
+ *       previous is written, so only small requests should be outstanding
+ */
+int
+clicon_rpc_msg_send(clicon_handle      h, 
+		    struct clicon_msg *msg,
+		    uint32_t          *id)
+{
+    int                 retval = -1;
+    struct rpc_session *rs;
+
+    if ((rs = rpc_session_get(h, 1)) == NULL)
+	goto done;
+    /* Reconnect if a send has failed or the backend has closed an idle session */
+    if (rs->rs_s != -1 &&
+	(rs->rs_broken ||
+	 (rs->rs_rcvd == rs->rs_next && rpc_session_closed(rs->rs_s))))
+	rpc_session_reset(rs);
+    if (rs->rs_s == -1 && rpc_session_connect(h, rs) < 0)
+	goto done;
+    if (clicon_msg_send(rs->rs_s, msg) < 0){
+	/* Replies of requests already sent may still be read */
+	if (rs->rs_rcvd == rs->rs_next)
+	    rpc_session_reset(rs);
+	else
+	    rs->rs_broken = 1;
+	goto done;
+    }
+    *id = rs->rs_next++;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Read reply of a request sent with clicon_rpc_msg_send() as string
+ * Replies of other requests read before the reply of this request are kept
+ * until they are asked for.
+ * @param[in]  h        CLICON handle
+ * @param[in]  id       Message id of request
+ * @param[out] retdata0 Reply body from backend as string. Free w free
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see clicon_rpc_msg_rcv  which parses the reply
+ */
+int
+clicon_rpc_msg_rcv_raw(clicon_handle h, 
+		       uint32_t      id,
+		       char        **retdata0)
+{
+    int                 retval = -1;
+    struct rpc_session *rs;
+    struct rpc_reply   *rr;
+    struct clicon_msg  *reply = NULL;
+    char               *retdata = NULL;
+    int                 eof;
+    int                 i;
+
+    if ((rs = rpc_session_get(h, 0)) == NULL ||
+	(int32_t)(id - rs->rs_next) >= 0){
+	clicon_err(OE_PROTO, EINVAL, "%s: No request with id %u", __FUNCTION__, id);
+	goto done;
+    }
+    for (i=0; i<rs->rs_nreplies; i++)
+	if (rs->rs_replies[i].rr_id == id){
+	    retdata = rs->rs_replies[i].rr_data;
+	    rs->rs_replies[i] = rs->rs_replies[--rs->rs_nreplies];
+	    break;
+	}
+    if (retdata == NULL && (int32_t)(id - rs->rs_rcvd) < 0){
+	clicon_err(OE_PROTO, ESHUTDOWN, "%s: No reply of request %u, already read or session closed",
+		   __FUNCTION__, id);
+	goto done;
+    }
+    while (retdata == NULL){
+	if (clicon_msg_rcv(rs->rs_s, &reply, &eof) < 0){
+	    rpc_session_reset(rs);
+	    goto done;
+	}
+	if (eof){
+	    clicon_err(OE_PROTO, ESHUTDOWN, "%s: Socket unexpected close", __FUNCTION__);
+	    rpc_session_reset(rs);
+	    errno = ESHUTDOWN;
+	    goto done;
+	}
+	if (rs->rs_rcvd == id){
+	    if ((retdata = strdup(reply->op_body)) == NULL){
+		clicon_err(OE_UNIX, errno, "strdup");
+		goto done;
+	    }
+	}
+	else { /* Reply to another request, keep it */
+	    if ((rr = realloc(rs->rs_replies, (rs->rs_nreplies+1)*sizeof(*rr))) == NULL){
+		clicon_err(OE_UNIX, errno, "realloc");
+		goto done;
+	    }
+	    rs->rs_replies = rr;
+	    rr = &rs->rs_replies[rs->rs_nreplies];
+	    rr->rr_id = rs->rs_rcvd;
+	    if ((rr->rr_data = strdup(reply->op_body)) == NULL){
+		clicon_err(OE_UNIX, errno, "strdup");
+		goto done;
+	    }
+	    rs->rs_nreplies++;
+	}
+	rs->rs_rcvd++;
+	free(reply);
+	reply = NULL;
+    }
+    *retdata0 = retdata;
+    retdata = NULL;
+    retval = 0;
+ done:
+    if (reply)
+	free(reply);
+    if (retdata)
+	free(retdata);
+    return retval;
+}
+
+/*! Read reply of a request sent with clicon_rpc_msg_send()
+ * @param[in]  h      CLICON handle
+ * @param[in]  id     Message id of request
+ * @param[out] xret0  Return value from backend as xml tree. Free w xml_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @note xret is populated with yangspec according to standard handle yangspec
+ * @see clicon_rpc_msg_rcv_raw  which returns the reply without parsing it
+ */
+int
+clicon_rpc_msg_rcv(clicon_handle h, 
+		   uint32_t      id,
+		   cxobj       **xret0)
+{
+    int   retval = -1;
+    char *retdata = NULL;
+
+    if (clicon_rpc_msg_rcv_raw(h, id, &retdata) < 0)
+	goto done;
+    if (rpc_reply_parse(h, retdata, xret0) < 0)
+	goto done;
+    retval = 0;
+ done:
+    if (retdata)
+	free(retdata);
+    return retval;
+}
+
+/*! Close the backend session of the handle, if any
+ * The session is otherwise closed on exit. A new session is opened on the
+ * next rpc.
+ * @param[in]  h      CLICON handle
+ * @see clicon_rpc_close_session which also closes the session
+ */
+int
+clicon_rpc_session_close(clicon_handle h)
+{
+    clicon_hash_t      *cdat = clicon_data(h);
+    struct rpc_session *rs;
+    int                 i;
+
+    if ((rs = rpc_session_get(h, 0)) == NULL)
+	return 0;
+    rpc_session_reset(rs);
+    for (i=0; i<rs->rs_nreplies; i++)
+	free(rs->rs_replies[i].rr_data);
+    if (rs->rs_replies)
+	free(rs->rs_replies);
+    free(rs);
+    hash_del(cdat, "rpc_session");
+    return 0;
+}
+
 /*! Send internal netconf rpc from client to backend
  * @param[in]    h      CLICON handle
  * @param[in]    msg    Encoded message. Deallocate woth free
@@ -75,6 +450,8 @@
  * @param[inout] sock0  If pointer exists, do not close socket to backend on success 
  *                      and return it here. For keeping a notify socket open
  * @note sock0 is if connection should be persistent, like a notification/subscribe api
+ *       Such a request is sent on its own socket, otherwise the backend session
+ *       of the handle is used.
  * @note xret is populated with yangspec according to standard handle yangspec
  */
 int
@@ -87,9 +464,15 @@ clicon_rpc_msg(clicon_handle      h,
     char              *sock;
     int                port;
     char              *retdata = NULL;
-    cxobj             *xret = NULL;
-    yang_spec         *yspec;
+    uint32_t           id;
 
+    if (sock0 == NULL){
+	if (clicon_rpc_msg_send(h, msg, &id) < 0)
+	    goto done;
+	if (clicon_rpc_msg_rcv(h, id, xret0) < 0)
+	    goto done;
+	goto ok;
+    }
     if ((sock = clicon_sock(h)) == NULL){
 	clicon_err(OE_FATAL, 0, "CLICON_SOCK option not set");
 	goto done;
@@ -120,23 +503,13 @@ clicon_rpc_msg(clicon_handle      h,
 	    goto done;
 	break;
     }
-    clicon_debug(1, "%s retdata:%s", __FUNCTION__, retdata);
-
-    if (retdata){
- 	yspec = clicon_dbspec_yang(h);
-	if (xml_parse_string(retdata, yspec, &xret) < 0)
-	    goto done;
-    }
-    if (xret0){
-	*xret0 = xret;
-	xret = NULL;
-    }
+    if (rpc_reply_parse(h, retdata, xret0) < 0)
+	goto done;
+ ok:
     retval = 0;
  done:
     if (retdata)
 	free(retdata);
-    if (xret)
-	xml_free(xret);
     return retval;
 }
 
@@ -200,6 +573,106 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     return retval;
 }
 
+/*! Generic xml netconf clicon rpc, return reply as string without parsing it
+ * For frontends that forward the reply of the backend, or only a part of it, 
+ * as it is. The request is sent on the backend session of the handle.
+ * @param[in]  h       clicon handle
+ * @param[in]  xmlstr  XML netconf tree as string
+ * @param[out] reply   Reply from backend as string, error or OK. Free w free
+ * @see clicon_rpc_netconf  which returns the reply as xml tree
+ * @see clicon_rpc_reply_data  to find the data of a reply without parsing it
+ */
+int
+clicon_rpc_netconf_raw(clicon_handle  h, 
+		       char          *xmlstr,
+		       char         **reply)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    uint32_t           id;
+
+    if ((msg = clicon_msg_encode("%s", xmlstr)) == NULL)
+	goto done;
+    if (clicon_rpc_msg_send(h, msg, &id) < 0)
+	goto done;
+    if (clicon_rpc_msg_rcv_raw(h, id, reply) < 0)
+	goto done;
+    retval = 0;
+ done:
+    if (msg)
+	free(msg);
+    return retval;
+}
+
+/*! Generic xml netconf clicon rpc, return reply as string without parsing it
+ * @param[in]  h       clicon handle
+ * @param[in]  xml     XML netconf tree 
+ * @param[out] reply   Reply from backend as string, error or OK. Free w free
+ * @see clicon_rpc_netconf_raw xml as string instead of tree
+ */
+int
+clicon_rpc_netconf_xml_raw(clicon_handle  h, 
+			   cxobj         *xml,
+			   char         **reply)
+{
+    int                retval = -1;
+    cbuf               *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+	clicon_err(OE_XML, errno, "cbuf_new");
+	goto done;
+    }
+    if (clicon_xml2cbuf(cb, xml, 0, 0) < 0)
+	goto done;
+    if (clicon_rpc_netconf_raw(h, cbuf_get(cb), reply) < 0)
+	goto done;
+    retval = 0;
+ done:
+    if (cb)
+	cbuf_free(cb);
+    return retval;
+}
+
+/*! Find the <data> element of a reply from the backend without parsing it
+ * The backend writes a reply with data as <rpc-reply><data>...</data></rpc-reply>,
+ * which is recognized by looking at the start and end of the reply only. Any
+ * other reply, eg an rpc-error, is not and has to be parsed.
+ * @param[in]  reply   Reply from backend as string, eg from clicon_rpc_netconf_raw
+ * @param[out] data    Start of <data> element in reply
+ * @param[out] len     Length of <data> element, including its end tag
+ * @retval     1       Found, data points into reply
+ * @retval     0       Not found, eg rpc-error or <data> not first in reply
+ */
+int
+clicon_rpc_reply_data(char   *reply,
+		      char  **data,
+		      size_t *len)
+{
+    size_t rlen;
+    char  *p;
+
+    if (reply == NULL || strncmp(reply, "<rpc-reply>", strlen("<rpc-reply>")))
+	return 0;
+    p = reply + strlen("<rpc-reply>");
+    if (strncmp(p, "<data", strlen("<data")) ||
+	p[strlen("<data")] == '\0' || strchr(">/ ", p[strlen("<data")]) == NULL)
+	return 0;
+    rlen = strlen(p);
+    if (rlen < strlen("</rpc-reply>") ||
+	strcmp(p + rlen - strlen("</rpc-reply>"), "</rpc-reply>"))
+	return 0;
+    rlen -= strlen("</rpc-reply>");
+    /* The data element must end where the reply ends, ie no other elements */
+    if (!(rlen >= strlen("</data>") && 
+	  strncmp(p + rlen - strlen("</data>"), "</data>", strlen("</data>")) == 0) &&
+	!(rlen >= strlen("/>") && strncmp(p + rlen - strlen("/>"), "/>", 2) == 0 &&
+	  memchr(p, '>', rlen) == p + rlen - 1))
+	return 0;
+    *data = p;
+    *len = rlen;
+    return 1;
+}
+
 /*! Generate clicon error function call from Netconf error message
  * @param[in]  xerr    Netconf error message on the level: <rpc-reply><rpc-error>
  */
@@ -258,12 +731,39 @@ clicon_rpc_get_config(clicon_handle       h,
 		      char               *db, 
 		      char               *xpath,
 		      cxobj             **xt)
+{
+    int      retval = -1;
+    uint32_t id;
+
+    if (clicon_rpc_get_config_send(h, db, xpath, &id) < 0)
+	goto done;
+    if (clicon_rpc_get_config_rcv(h, id, xt) < 0)
+	goto done;
+    retval = 0;
+  done:
+    return retval;
+}
+
+/*! Send get-config request without waiting for reply
+ * Several get-config (or other) requests may be sent before reading the
+ * replies, thereby saving a roundtrip to the backend for each request.
+ * @param[in]  h        CLICON handle
+ * @param[in]  db       Name of database
+ * @param[in]  xpath    XPath (or "")
+ * @param[out] id       Message id, read reply with clicon_rpc_get_config_rcv()
+ * @retval    0         OK
+ * @retval   -1         Error
+ * @see clicon_rpc_get_config
+ */
+int
+clicon_rpc_get_config_send(clicon_handle h, 
+			   char         *db, 
+			   char         *xpath,
+			   uint32_t     *id)
 {
     int                retval = -1;
     struct clicon_msg *msg = NULL;
     cbuf              *cb = NULL;
-    cxobj             *xret = NULL;
-    cxobj             *xd;
 
     if ((cb = cbuf_new()) == NULL)
 	goto done;
@@ -273,7 +773,36 @@ clicon_rpc_get_config(clicon_handle       h,
     cprintf(cb, "</get-config></rpc>");
     if ((msg = clicon_msg_encode("%s", cbuf_get(cb))) == NULL)
 	goto done;
-    if (clicon_rpc_msg(h, msg, &xret, NULL) < 0)
+    if (clicon_rpc_msg_send(h, msg, id) < 0)
+	goto done;
+    retval = 0;
+  done:
+    if (cb)
+	cbuf_free(cb);
+    if (msg)
+	free(msg);
+    return retval;
+}
+
+/*! Read reply of a get-config request sent with clicon_rpc_get_config_send()
+ * @param[in]  h        CLICON handle
+ * @param[in]  id       Message id of request
+ * @param[out] xt       XML tree. Free with xml_free. 
+ *                      Either <config> or <rpc-error>. 
+ * @retval    0         OK
+ * @retval   -1         Error, fatal or xml
+ * @see clicon_rpc_get_config
+ */
+int
+clicon_rpc_get_config_rcv(clicon_handle h, 
+			  uint32_t      id,
+			  cxobj       **xt)
+{
+    int                retval = -1;
+    cxobj             *xret = NULL;
+    cxobj             *xd;
+
+    if (clicon_rpc_msg_rcv(h, id, &xret) < 0)
 	goto done;
     /* Send xml error back: first check error, then ok */
     if ((xd = xpath_first(xret, "/rpc-reply/rpc-error")) != NULL)
@@ -288,12 +817,8 @@ clicon_rpc_get_config(clicon_handle       h,
     }
     retval = 0;
   done:
-    if (cb)
-	cbuf_free(cb);
     if (xret)
 	xml_free(xret);
-    if (msg)
-	free(msg);
     return retval;
 }
 
@@ -482,36 +1007,36 @@ clicon_rpc_unlock(clicon_handle h,
     return retval;
 }
 
-/*! Get database configuration and state data
+/*! Get database configuration and state data as reply string
  * @param[in]  h        CLICON handle
  * @param[in]  xpath    XPath (or "")
- * @param[out] xt       XML tree. Free with xml_free. 
- *                      Either <config> or <rpc-error>. 
+ * @param[out] reply    Reply from backend as string. Free with free. 
  * @retval    0         OK
- * @retval   -1         Error, fatal or xml
+ * @retval   -1         Error, fatal
  * @code
- *    cxobj *xt = NULL;
- *    if (clicon_rpc_get(h, "/", &xt) < 0)
+ *    char   *reply = NULL;
+ *    char   *data;
+ *    size_t  len;
+ *    cxobj  *xt = NULL;
+ *    if (clicon_rpc_get_raw(h, "/", &reply) < 0)
  *       err;
- *   if ((xerr = xpath_first(xt, "/rpc-error")) != NULL){
- *	clicon_rpc_generate_error(xerr);
- *      err;
- *  }
- *    if (xt)
- *       xml_free(xt);
+ *    if (clicon_rpc_reply_data(reply, &data, &len) == 1)
+ *       fwrite(data, 1, len, f);  
+ *    else if (clicon_rpc_get_parse(h, reply, &xt) < 0)
+ *       err;
+ *    free(reply);
  * @endcode
- * @see clicon_rpc_generate_error
+ * @see clicon_rpc_get  which returns an xml tree
  */
 int
-clicon_rpc_get(clicon_handle       h, 
-	       char               *xpath,
-	       cxobj             **xt)
+clicon_rpc_get_raw(clicon_handle       h, 
+		   char               *xpath,
+		   char              **reply)
 {
     int                retval = -1;
     struct clicon_msg *msg = NULL;
     cbuf              *cb = NULL;
-    cxobj             *xret = NULL;
-    cxobj             *xd;
+    uint32_t           id;
 
     if ((cb = cbuf_new()) == NULL)
 	goto done;
@@ -521,7 +1046,37 @@ clicon_rpc_get(clicon_handle       h,
     cprintf(cb, "</get></rpc>");
     if ((msg = clicon_msg_encode("%s", cbuf_get(cb))) == NULL)
 	goto done;
-    if (clicon_rpc_msg(h, msg, &xret, NULL) < 0)
+    if (clicon_rpc_msg_send(h, msg, &id) < 0)
+	goto done;
+    if (clicon_rpc_msg_rcv_raw(h, id, reply) < 0)
+	goto done;
+    retval = 0;
+  done:
+    if (cb)
+	cbuf_free(cb);
+    if (msg)
+	free(msg);
+    return retval;
+}
+
+/*! Parse reply string of a get as returned by clicon_rpc_get
+ * @param[in]  h        CLICON handle
+ * @param[in]  reply    Reply from backend as string, see clicon_rpc_get_raw
+ * @param[out] xt       XML tree. Free with xml_free. 
+ *                      Either <data> or <rpc-reply> with <rpc-error>. 
+ * @retval    0         OK
+ * @retval   -1         Error, fatal or xml
+ */
+int
+clicon_rpc_get_parse(clicon_handle h, 
+		     char         *reply,
+		     cxobj       **xt)
+{
+    int                retval = -1;
+    cxobj             *xret = NULL;
+    cxobj             *xd;
+
+    if (rpc_reply_parse(h, reply, &xret) < 0)
 	goto done;
     /* Send xml error back: first check error, then ok */
     if ((xd = xpath_first(xret, "/rpc-reply/rpc-error")) != NULL)
@@ -536,16 +1091,53 @@ clicon_rpc_get(clicon_handle       h,
     }
     retval = 0;
   done:
-    if (cb)
-	cbuf_free(cb);
     if (xret)
 	xml_free(xret);
-    if (msg)
-	free(msg);
+    return retval;
+}
+
+/*! Get database configuration and state data
+ * @param[in]  h        CLICON handle
+ * @param[in]  xpath    XPath (or "")
+ * @param[out] xt       XML tree. Free with xml_free. 
+ *                      Either <config> or <rpc-error>. 
+ * @retval    0         OK
+ * @retval   -1         Error, fatal or xml
+ * @code
+ *    cxobj *xt = NULL;
+ *    if (clicon_rpc_get(h, "/", &xt) < 0)
+ *       err;
+ *   if ((xerr = xpath_first(xt, "/rpc-error")) != NULL){
+ *	clicon_rpc_generate_error(xerr);
+ *      err;
+ *  }
+ *    if (xt)
+ *       xml_free(xt);
+ * @endcode
+ * @see clicon_rpc_generate_error
+ * @see clicon_rpc_get_raw  which returns the reply as string
+ */
+int
+clicon_rpc_get(clicon_handle       h, 
+	       char               *xpath,
+	       cxobj             **xt)
+{
+    int                retval = -1;
+    char              *reply = NULL;
+
+    if (clicon_rpc_get_raw(h, xpath, &reply) < 0)
+	goto done;
+    if (clicon_rpc_get_parse(h, reply, xt) < 0)
+	goto done;
+    retval = 0;
+  done:
+    if (reply)
+	free(reply);
     return retval;
 }
 
 /*! Close a (user) session
+ * Also closes the backend session socket of the handle
  * @param[in] h        CLICON handle
  */
 int
@@ -566,6 +1158,7 @@ clicon_rpc_close_session(clicon_handle h)
     }
     retval = 0;
  done:
+    clicon_rpc_session_close(h);
     if (xret)
 	xml_free(xret);
     if (msg)
@@ -709,6 +1302,7 @@ clicon_rpc_create_subscription(clicon_handle    h,
     struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
+    int                s = -1;
 
     if ((msg = clicon_msg_encode("<rpc><create-subscription>"
 				 "<stream>%s</stream>"
@@ -716,7 +1310,8 @@ clicon_rpc_create_subscription(clicon_handle    h,
 				 "</create-subscription></rpc>", 
 				 stream?stream:"", filter?filter:"")) == NULL)
 	goto done;
-    if (clicon_rpc_msg(h, msg, &xret, s0) < 0)
+    /* Notifications are sent on the subscribing socket, never use the session */
+    if (clicon_rpc_msg(h, msg, &xret, s0?s0:&s) < 0)
 	goto done;
     if ((xerr = xpath_first(xret, "//rpc-error")) != NULL){
 	clicon_rpc_generate_error("Create subscription", xerr);
@@ -724,6 +1319,8 @@ clicon_rpc_create_subscription(clicon_handle    h,
     }
     retval = 0;
   done:
+    if (s != -1)
+	close(s);
     if (xret)
 	xml_free(xret);
     if (msg)
@@ -0,0 +1,520 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2018 Olof Hagsand and Benny Holmgren
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ *
+ * Non-blocking message connections
+ * A connection reads clicon messages from a non-blocking socket as data
+ * arrives, and calls a callback for each complete message. Output is written
+ * directly if the socket is writable, otherwise queued and written by the
+ * event loop when the socket becomes writable. Thereby a peer that is slow to
+ * send or to read does not block the process, eg the backend serving other
+ * clients.
+ * When more output than a high-water mark is queued, no more messages are
+ * read until the queue is drained below half of it.
+ */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_event.h"
+#include "clixon_proto.h"
+#include "clixon_sink.h"
+#include "clixon_proto_conn.h"
+
+/* Bytes to read from a socket at a time */
+#define CONN_READLEN  65536
+
+/* Default high-water mark of queued output, see clicon_conn_hiwat_set */
+#define CONN_HIWAT    (1024*1024)
+
+struct clicon_conn{
+    int                     cc_s;       /* Socket, non-blocking */
+    clicon_conn_msg_fn_t   *cc_msgfn;   /* Called for each message */
+    clicon_conn_close_fn_t *cc_closefn; /* Called on close or failure */
+    void                   *cc_arg;     /* Argument to callbacks */
+    char                   *cc_ibuf;    /* Received data, not yet a message */
+    size_t                  cc_ilen;    /* Bytes in cc_ibuf */
+    size_t                  cc_imax;    /* Allocated size of cc_ibuf */
+    char                   *cc_obuf;    /* Queued output, from cc_ooff */
+    size_t                  cc_ooff;    /* Written bytes in cc_obuf */
+    size_t                  cc_olen;    /* Bytes in cc_obuf, incl written */
+    size_t                  cc_omax;    /* Allocated size of cc_obuf */
+    size_t                  cc_hiwat;   /* Dont read when queue larger */
+    int                     cc_inreg;   /* Input callback registered */
+    int                     cc_outreg;  /* Output callback registered */
+    int                     cc_failed;  /* Closed or failed, cc_closefn is
+					   called from event loop */
+    int                     cc_busy;    /* Calling cc_msgfn */
+    int                     cc_freed;   /* clicon_conn_free() when busy */
+};
+
+static int conn_input(int s, void *arg);
+static int conn_output(int s, void *arg);
+
+/*! Write to a socket, without SIGPIPE if peer has closed
+ * @retval  n   Bytes written
+ * @retval -1   Error, errno set (EAGAIN if socket is not writable)
+ */
+static ssize_t
+conn_send1(int    s,
+	   char  *buf,
+	   size_t len)
+{
+    ssize_t n;
+
+    do {
+#ifdef MSG_NOSIGNAL
+	n = send(s, buf, len, MSG_NOSIGNAL);
+#else
+	n = write(s, buf, len);
+#endif
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+/*! Call close callback of a failed connection, registered as timeout
+ */
+static int
+conn_closed(int   fd,
+	    void *arg)
+{
+    clicon_conn *cc = (clicon_conn *)arg;
+
+    return cc->cc_closefn(cc, cc->cc_arg);
+}
+
+/*! Stop using a connection that is closed by peer or has failed
+ * Queued output and received data are dropped. The close callback is called 
+ * from the event loop, not here, since the connection may be in use by the 
+ * caller.
+ * @param[in]  cc   Connection
+ */
+static int
+conn_fail(clicon_conn *cc)
+{
+    struct timeval t;
+
+    if (cc->cc_failed || cc->cc_freed)
+	return 0;
+    cc->cc_failed = 1;
+    if (cc->cc_inreg){
+	event_unreg_fd(cc->cc_s, conn_input);
+	cc->cc_inreg = 0;
+    }
+    if (cc->cc_outreg){
+	event_unreg_fd_out(cc->cc_s, conn_output);
+	cc->cc_outreg = 0;
+    }
+    cc->cc_ooff = cc->cc_olen = 0;
+    cc->cc_ilen = 0;
+    gettimeofday(&t, NULL);
+    return event_reg_timeout(t, conn_closed, cc, "connection closed");
+}
+
+/*! Free a connection, see clicon_conn_free
+ */
+static void
+conn_free1(clicon_conn *cc)
+{
+    if (cc->cc_ibuf)
+	free(cc->cc_ibuf);
+    if (cc->cc_obuf)
+	free(cc->cc_obuf);
+    free(cc);
+}
+
+/*! Call message callback for each complete message received
+ * Stops if output queue gets larger than high-water mark.
+ * @param[in]  cc   Connection
+ * @retval     0    OK
+ * @retval    -1    Fatal error from message callback
+ */
+static int
+conn_dispatch(clicon_conn *cc)
+{
+    int                retval = -1;
+    struct clicon_msg *msg;
+    size_t             off = 0;
+    size_t             used;
+    int                ret;
+
+    cc->cc_busy++;
+    while (cc->cc_inreg && !cc->cc_freed){
+	if ((ret = clicon_msg_parse(cc->cc_ibuf+off, cc->cc_ilen-off, &msg, &used)) < 0){
+	    clicon_log(LOG_WARNING, "%s: invalid message, closing", __FUNCTION__);
+	    conn_fail(cc);
+	    break;
+	}
+	if (ret == 0)
+	    break;
+	off += used;
+	ret = cc->cc_msgfn(cc, msg, cc->cc_arg);
+	free(msg);
+	if (ret < 0)
+	    goto done;
+	if (cc->cc_inreg && clicon_conn_outlen(cc) > cc->cc_hiwat){
+	    clicon_debug(1, "%s: %zu bytes queued, pause input", 
+			 __FUNCTION__, clicon_conn_outlen(cc));
+	    event_unreg_fd(cc->cc_s, conn_input);
+	    cc->cc_inreg = 0;
+	}
+    }
+    retval = 0;
+ done:
+    cc->cc_busy--;
+    if (cc->cc_freed){
+	if (cc->cc_busy == 0)
+	    conn_free1(cc);
+	return retval;
+    }
+    if (off && !cc->cc_failed){ /* conn_fail() drops received data */
+	memmove(cc->cc_ibuf, cc->cc_ibuf+off, cc->cc_ilen-off);
+	cc->cc_ilen -= off;
+    }
+    return retval;
+}
+
+/*! Read available data from socket and handle complete messages
+ * Registered as input callback of the socket
+ */
+static int
+conn_input(int   s,
+	   void *arg)
+{
+    clicon_conn *cc = (clicon_conn *)arg;
+    char        *buf;
+    size_t       max;
+    ssize_t      n;
+
+    if (cc->cc_imax - cc->cc_ilen < CONN_READLEN){
+	max = cc->cc_imax?cc->cc_imax:CONN_READLEN;
+	while (max - cc->cc_ilen < CONN_READLEN)
+	    max *= 2;
+	if ((buf = realloc(cc->cc_ibuf, max)) == NULL){
+	    clicon_err(OE_UNIX, errno, "realloc");
+	    return -1;
+	}
+	cc->cc_ibuf = buf;
+	cc->cc_imax = max;
+    }
+    if ((n = read(s, cc->cc_ibuf+cc->cc_ilen, cc->cc_imax-cc->cc_ilen)) < 0){
+	if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+	    return 0;
+	clicon_debug(1, "%s: read: %s", __FUNCTION__, strerror(errno));
+	return conn_fail(cc);
+    }
+    if (n == 0) /* Closed by peer */
+	return conn_fail(cc);
+    cc->cc_ilen += n;
+    return conn_dispatch(cc);
+}
+
+/*! Write queued output when socket is writable
+ * Registered as output callback of the socket when there is queued output.
+ * Reading is resumed when the queue is below half of high-water mark.
+ */
+static int
+conn_output(int   s,
+	    void *arg)
+{
+    clicon_conn *cc = (clicon_conn *)arg;
+    ssize_t      n;
+
+    if ((n = conn_send1(s, cc->cc_obuf+cc->cc_ooff, cc->cc_olen-cc->cc_ooff)) < 0){
+	if (errno == EAGAIN || errno == EWOULDBLOCK)
+	    return 0;
+	clicon_debug(1, "%s: write: %s", __FUNCTION__, strerror(errno));
+	return conn_fail(cc);
+    }
+    cc->cc_ooff += n;
+    if (cc->cc_ooff == cc->cc_olen){
+	cc->cc_ooff = cc->cc_olen = 0;
+	event_unreg_fd_out(s, conn_output);
+	cc->cc_outreg = 0;
+    }
+    if (!cc->cc_inreg && !cc->cc_failed && 
+	clicon_conn_outlen(cc) <= cc->cc_hiwat/2){
+	clicon_debug(1, "%s: resume input", __FUNCTION__);
+	if (event_reg_fd(s, conn_input, cc, "connection input") < 0)
+	    return -1;
+	cc->cc_inreg = 1;
+	/* Messages may already have been received */
+	return conn_dispatch(cc);
+    }
+    return 0;
+}
+
+/*! Write data on connection, or queue it if socket is not writable
+ * @param[in]  cc   Connection
+ * @param[in]  buf  Data
+ * @param[in]  len  Length of data
+ * @retval     0    OK, written or queued. Or dropped since connection failed
+ * @retval    -1    Error, errno set, eg EPIPE
+ */
+static int
+conn_write(clicon_conn *cc,
+	   char        *buf,
+	   size_t       len)
+{
+    ssize_t n;
+    size_t  max;
+    char   *obuf;
+
+    if (cc->cc_failed || cc->cc_freed)
+	return 0;
+    if (cc->cc_olen == 0){ /* Nothing queued, try to write directly */
+	if ((n = conn_send1(cc->cc_s, buf, len)) < 0){
+	    if (errno != EAGAIN && errno != EWOULDBLOCK){
+		clicon_err(OE_UNIX, errno, "%s: write", __FUNCTION__);
+		n = errno;
+		conn_fail(cc);
+		errno = n;
+		return -1;
+	    }
+	    n = 0;
+	}
+	buf += n;
+	len -= n;
+	if (len == 0)
+	    return 0;
+    }
+    if (cc->cc_olen + len > cc->cc_omax){
+	if (cc->cc_ooff){ /* Move unwritten to start */
+	    memmove(cc->cc_obuf, cc->cc_obuf+cc->cc_ooff, cc->cc_olen-cc->cc_ooff);
+	    cc->cc_olen -= cc->cc_ooff;
+	    cc->cc_ooff = 0;
+	}
+	if (cc->cc_olen + len > cc->cc_omax){
+	    max = cc->cc_omax?cc->cc_omax:CONN_READLEN;
+	    while (cc->cc_olen + len > max)
+		max *= 2;
+	    if ((obuf = realloc(cc->cc_obuf, max)) == NULL){
+		clicon_err(OE_UNIX, errno, "realloc");
+		return -1;
+	    }
+	    cc->cc_obuf = obuf;
+	    cc->cc_omax = max;
+	}
+    }
+    memcpy(cc->cc_obuf+cc->cc_olen, buf, len);
+    cc->cc_olen += len;
+    if (!cc->cc_outreg){
+	if (event_reg_fd_out(cc->cc_s, conn_output, cc, "connection output") < 0)
+	    return -1;
+	cc->cc_outreg = 1;
+    }
+    return 0;
+}
+
+/*! Sink callback, see clicon_conn_sink
+ */
+static int
+conn_sink_write(void  *arg,
+		char  *buf,
+		size_t len)
+{
+    return conn_write((clicon_conn *)arg, buf, len);
+}
+
+/*! Create a non-blocking message connection on a socket
+ * The socket is set non-blocking and registered in the event loop.
+ * @param[in]  s        Socket, eg accepted client socket
+ * @param[in]  msgfn    Called for each message received
+ * @param[in]  closefn  Called when closed by peer or failed
+ * @param[in]  arg      Argument to callbacks
+ * @retval     cc       Connection, free with clicon_conn_free()
+ * @retval     NULL     Error
+ */
+clicon_conn *
+clicon_conn_new(int                     s,
+		clicon_conn_msg_fn_t   *msgfn,
+		clicon_conn_close_fn_t *closefn,
+		void                   *arg)
+{
+    clicon_conn *cc;
+    int          flags;
+
+    if ((flags = fcntl(s, F_GETFL, 0)) < 0 ||
+	fcntl(s, F_SETFL, flags | O_NONBLOCK) < 0){
+	clicon_err(OE_UNIX, errno, "fcntl");
+	return NULL;
+    }
+    if ((cc = malloc(sizeof(*cc))) == NULL){
+	clicon_err(OE_UNIX, errno, "malloc");
+	return NULL;
+    }
+    memset(cc, 0, sizeof(*cc));
+    cc->cc_s = s;
+    cc->cc_msgfn = msgfn;
+    cc->cc_closefn = closefn;
+    cc->cc_arg = arg;
+    cc->cc_hiwat = CONN_HIWAT;
+    if (event_reg_fd(s, conn_input, cc, "connection input") < 0){
+	free(cc);
+	return NULL;
+    }
+    cc->cc_inreg = 1;
+    return cc;
+}
+
+/*! Free a connection, the socket is not closed
+ * Queued output not yet written is dropped.
+ * @param[in]  cc   Connection
+ */
+int
+clicon_conn_free(clicon_conn *cc)
+{
+    if (cc->cc_inreg)
+	event_unreg_fd(cc->cc_s, conn_input);
+    if (cc->cc_outreg)
+	event_unreg_fd_out(cc->cc_s, conn_output);
+    cc->cc_inreg = cc->cc_outreg = 0;
+    if (cc->cc_failed)
+	event_unreg_timeout(conn_closed, cc);
+    if (cc->cc_busy) /* Freed when message callback returns */
+	cc->cc_freed = 1;
+    else
+	conn_free1(cc);
+    return 0;
+}
+
+/*! Set high-water mark of queued output of a connection
+ * When more output is queued, eg a large reply to a slow reader, no more 
+ * messages are read from the connection until the queue is below half of it.
+ * @param[in]  cc     Connection
+ * @param[in]  hiwat  High-water mark in bytes
+ */
+int
+clicon_conn_hiwat_set(clicon_conn *cc,
+		      size_t       hiwat)
+{
+    cc->cc_hiwat = hiwat;
+    return 0;
+}
+
+/*! Send a message on a connection
+ * @param[in]  cc   Connection
+ * @param[in]  msg  Message, not freed
+ * @retval     0    OK, written or queued
+ * @retval    -1    Error, errno set
+ * @see clicon_msg_send  for blocking sockets
+ */
+int
+clicon_conn_send(clicon_conn       *cc,
+		 struct clicon_msg *msg)
+{
+    return conn_write(cc, (char*)msg, ntohl(msg->op_len));
+}
+
+/*! Send a notification message on a connection
+ * @param[in]  cc     Connection
+ * @param[in]  level
+ * @param[in]  event
+ * @retval     0      OK, written or queued
+ * @retval    -1      Error
+ * @see send_msg_notify  for blocking sockets
+ */
+int
+clicon_conn_notify(clicon_conn *cc,
+		   int          level,
+		   char        *event)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+
+    if ((msg=clicon_msg_encode("<notification><event>%s</event></notification>", event)) == NULL)
+	goto done;
+    if (clicon_conn_send(cc, msg) < 0)
+	goto done;
+    retval = 0;
+  done:
+    if (msg)
+	free(msg);
+    return retval;
+}
+
+/*! Create a sink writing a message on a connection, eg a streamed reply
+ * @param[in]  cc   Connection
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ * @see clicon_sink_msg
+ */
+clicon_sink *
+clicon_conn_sink(clicon_conn *cc)
+{
+    return clicon_sink_msg_fn(conn_sink_write, cc);
+}
+
+/*! Get number of bytes of queued output of a connection
+ * @param[in]  cc   Connection
+ */
+size_t
+clicon_conn_outlen(clicon_conn *cc)
+{
+    return cc->cc_olen - cc->cc_ooff;
+}
+
+/*! Close a connection without writing queued output
+ * Eg if a peer does not read. The close callback is called from the event loop.
+ * @param[in]  cc   Connection
+ */
+int
+clicon_conn_shutdown(clicon_conn *cc)
+{
+    return conn_fail(cc);
+}
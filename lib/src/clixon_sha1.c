@@ -60,6 +60,7 @@
 /* clicon */
 #include "clixon_log.h"
 #include "clixon_err.h"
+#include "clixon_sha1.h"
 
 
 /* 
@@ -419,6 +420,35 @@ SHA1PadMessage(SHA1Context *context)
     SHA1ProcessMessageBlock(context);
 }
 
+/*! Compute the SHA-1 digest of a buffer
+ * @param[in]  buf     Data, may contain null characters
+ * @param[in]  len     Length of data
+ * @param[out] digest  CLICON_SHA1_LEN bytes, most significant byte first
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+clicon_sha1(const void    *buf,
+	    size_t         len,
+	    unsigned char *digest)
+{
+    int         i;
+    SHA1Context context;
+
+    SHA1Reset(&context);
+    SHA1Input(&context, (const unsigned char *)buf, len);
+    if (!SHA1Result(&context)) {
+	clicon_err(OE_UNIX, 0, "Could not compute SHA1 message digest");
+	return -1;
+    }
+    for (i = 0; i < 5; i++){
+	digest[i*4]   = (context.Message_Digest[i] >> 24) & 0xFF;
+	digest[i*4+1] = (context.Message_Digest[i] >> 16) & 0xFF;
+	digest[i*4+2] = (context.Message_Digest[i] >> 8) & 0xFF;
+	digest[i*4+3] = context.Message_Digest[i] & 0xFF;
+    }
+    return 0;
+}
 
 char *
 clicon_sha1hex(const char *str)
@@ -0,0 +1,561 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2018 Olof Hagsand and Benny Holmgren
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Output sinks
+ * Text generated in many small pieces, eg XML or JSON printed from a tree, is
+ * collected in a bounded buffer and written to the destination when the 
+ * buffer is full. The output is never assembled in memory as a whole, unless
+ * the destination is a cligen buffer.
+ * Large pieces are written directly, together with the buffered output using
+ * writev(), instead of being copied to the buffer.
+ */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_proto.h"
+#include "clixon_sink.h"
+
+/* Buffer size of sinks writing to a socket, ie size of message chunks */
+#define SINK_BUFLEN_FD  65536
+
+/* Buffer size of sinks writing to a file, cligen buffer or callback */
+#define SINK_BUFLEN     8192
+
+enum sink_type{
+    SINK_FD,     /* File descriptor, eg socket */
+    SINK_MSG,    /* Clicon message on a socket, see CLICON_MSG_CHUNKED */
+    SINK_FILE,   /* Stdio stream */
+    SINK_CBUF,   /* Cligen buffer */
+    SINK_FN,     /* Callback */
+};
+
+struct clicon_sink{
+    enum sink_type     cs_type;
+    int                cs_fd;      /* SINK_FD, SINK_MSG (if not cs_fn) */
+    FILE              *cs_f;       /* SINK_FILE */
+    cbuf              *cs_cb;      /* SINK_CBUF */
+    clicon_sink_fn_t  *cs_fn;      /* SINK_FN, SINK_MSG */
+    void              *cs_arg;     /* SINK_FN, SINK_MSG */
+    int                cs_chunked; /* SINK_MSG: header of chunked message sent*/
+    int                cs_err;     /* A write failed, later writes fail */
+    int                cs_errno;   /* errno of failed write */
+    size_t             cs_total;   /* Bytes written to sink */
+    size_t             cs_len;     /* Bytes in buffer */
+    size_t             cs_buflen;  /* Size of buffer */
+    char               cs_buf[0];  /* Buffer, follows struct */
+};
+
+/*! Create a sink of a type 
+ * @param[in]  type    Sink type
+ * @param[in]  buflen  Size of buffer
+ */
+static clicon_sink *
+sink_new(enum sink_type type,
+	 size_t         buflen)
+{
+    clicon_sink *cs;
+
+    if ((cs = malloc(sizeof(*cs) + buflen + 1)) == NULL){ /* +1: vsnprintf NUL */
+	clicon_err(OE_UNIX, errno, "malloc");
+	return NULL;
+    }
+    memset(cs, 0, sizeof(*cs));
+    cs->cs_type = type;
+    cs->cs_fd = -1;
+    cs->cs_buflen = buflen;
+    return cs;
+}
+
+/*! Write a vector of buffers to a file descriptor, retry on partial writes
+ * @param[in]  fd   File descriptor
+ * @param[in]  iov  Vector of buffers, modified
+ * @param[in]  n    Length of iov
+ * @retval     0    OK
+ * @retval    -1    Error, errno set
+ */
+static int
+sink_writev(int           fd,
+	    struct iovec *iov,
+	    int           n)
+{
+    ssize_t len;
+
+    while (n > 0){
+	if ((len = writev(fd, iov, n)) < 0){
+	    if (errno == EINTR)
+		continue;
+	    clicon_err(OE_UNIX, errno, "writev");
+	    return -1;
+	}
+	while (n > 0 && len >= iov->iov_len){
+	    len -= iov->iov_len;
+	    iov++;
+	    n--;
+	}
+	if (n > 0){
+	    iov->iov_base = (char*)iov->iov_base + len;
+	    iov->iov_len -= len;
+	}
+    }
+    return 0;
+}
+
+/*! Write the buffer of a sink and data to the destination
+ * @param[in]  cs    Sink
+ * @param[in]  buf   Data to write after the buffer, or NULL
+ * @param[in]  len   Length of buf
+ * @param[in]  last  Set if this is the end of output (SINK_MSG)
+ * @retval     0     OK, buffer is empty
+ * @retval    -1     Error
+ */
+static int
+sink_output(clicon_sink *cs,
+	    char        *buf,
+	    size_t       len,
+	    int          last)
+{
+    struct iovec iov[5];
+    int          n = 0;
+    uint32_t     hdr[3];
+    int          h = 0;
+
+    if (cs->cs_err)
+	return -1;
+    switch (cs->cs_type){
+    case SINK_FD:
+	break;
+    case SINK_MSG:
+	if (last && !cs->cs_chunked) /* Whole message known: plain message */
+	    hdr[h++] = htonl(sizeof(struct clicon_msg) + cs->cs_len + len);
+	else{
+	    if (!cs->cs_chunked){
+		hdr[h++] = htonl(CLICON_MSG_CHUNKED);
+		cs->cs_chunked = 1;
+	    }
+	    if (cs->cs_len + len)
+		hdr[h++] = htonl(cs->cs_len + len);
+	}
+	if (h){
+	    iov[n].iov_base = hdr;
+	    iov[n++].iov_len = h*sizeof(uint32_t);
+	}
+	break;
+    case SINK_FILE:
+	if ((cs->cs_len && fwrite(cs->cs_buf, 1, cs->cs_len, cs->cs_f) != cs->cs_len) ||
+	    (len && fwrite(buf, 1, len, cs->cs_f) != len)){
+	    clicon_err(OE_UNIX, errno, "fwrite");
+	    goto err;
+	}
+	goto ok;
+    case SINK_CBUF:
+	if (cs->cs_len)
+	    cprintf(cs->cs_cb, "%.*s", (int)cs->cs_len, cs->cs_buf);
+	if (len)
+	    cprintf(cs->cs_cb, "%.*s", (int)len, buf);
+	goto ok;
+    case SINK_FN:
+	if ((cs->cs_len && cs->cs_fn(cs->cs_arg, cs->cs_buf, cs->cs_len) < 0) ||
+	    (len && cs->cs_fn(cs->cs_arg, buf, len) < 0))
+	    goto err;
+	goto ok;
+    }
+    if (cs->cs_len){
+	iov[n].iov_base = cs->cs_buf;
+	iov[n++].iov_len = cs->cs_len;
+    }
+    if (len){
+	iov[n].iov_base = buf;
+	iov[n++].iov_len = len;
+    }
+    if (last && cs->cs_chunked){ /* End of chunks */
+	hdr[h] = htonl(0);
+	iov[n].iov_base = &hdr[h];
+	iov[n++].iov_len = sizeof(uint32_t);
+    }
+    if (cs->cs_fn){ /* SINK_MSG with callback */
+	for (h=0; h<n; h++)
+	    if (cs->cs_fn(cs->cs_arg, iov[h].iov_base, iov[h].iov_len) < 0)
+		goto err;
+    }
+    else if (n && sink_writev(cs->cs_fd, iov, n) < 0)
+	goto err;
+ ok:
+    cs->cs_len = 0;
+    return 0;
+ err:
+    cs->cs_err = 1;
+    cs->cs_errno = errno;
+    return -1;
+}
+
+/*! Create a sink writing to a file descriptor, eg a socket
+ * @param[in]  fd   File descriptor, not closed by clicon_sink_close()
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ */
+clicon_sink *
+clicon_sink_fd(int fd)
+{
+    clicon_sink *cs;
+
+    if ((cs = sink_new(SINK_FD, SINK_BUFLEN_FD)) != NULL)
+	cs->cs_fd = fd;
+    return cs;
+}
+
+/*! Create a sink writing a clicon message to a socket, eg a backend reply
+ * The output is sent as one message when the sink is closed, ending with a NUL
+ * byte. If the output does not fit in the buffer of the sink, it is sent in
+ * chunks as it is written, see CLICON_MSG_CHUNKED. 
+ * @param[in]  s    Socket, not closed by clicon_sink_close()
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ * @see send_msg_reply  if the reply is known
+ * @see clicon_msg_rcv  receives both plain and chunked messages
+ */
+clicon_sink *
+clicon_sink_msg(int s)
+{
+    clicon_sink *cs;
+
+    if ((cs = sink_new(SINK_MSG, SINK_BUFLEN_FD)) != NULL)
+	cs->cs_fd = s;
+    return cs;
+}
+
+/*! Create a sink writing a clicon message with a callback
+ * As clicon_sink_msg(), but the message, including headers, is written with
+ * a callback, eg to the output queue of a non-blocking socket.
+ * @param[in]  fn   Callback, called with parts of the message. Returns -1 on error
+ * @param[in]  arg  Argument to fn
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ * @see clicon_conn_sink
+ */
+clicon_sink *
+clicon_sink_msg_fn(clicon_sink_fn_t *fn,
+		   void             *arg)
+{
+    clicon_sink *cs;
+
+    if ((cs = sink_new(SINK_MSG, SINK_BUFLEN_FD)) != NULL){
+	cs->cs_fn = fn;
+	cs->cs_arg = arg;
+    }
+    return cs;
+}
+
+/*! Create a sink writing to a stdio stream
+ * @param[in]  f    Stream, not closed by clicon_sink_close()
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ */
+clicon_sink *
+clicon_sink_file(FILE *f)
+{
+    clicon_sink *cs;
+
+    if ((cs = sink_new(SINK_FILE, SINK_BUFLEN)) != NULL)
+	cs->cs_f = f;
+    return cs;
+}
+
+/*! Create a sink appending to a cligen buffer
+ * @param[in]  cb   Cligen buffer, not freed by clicon_sink_close()
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ */
+clicon_sink *
+clicon_sink_cbuf(cbuf *cb)
+{
+    clicon_sink *cs;
+
+    if ((cs = sink_new(SINK_CBUF, SINK_BUFLEN)) != NULL)
+	cs->cs_cb = cb;
+    return cs;
+}
+
+/*! Create a sink writing with a callback, eg to a fastcgi stream
+ * @param[in]  fn   Callback, called with buffered output. Returns -1 on error
+ * @param[in]  arg  Argument to fn
+ * @retval     cs   Sink, close with clicon_sink_close()
+ * @retval     NULL Error
+ * @code
+ *   static int 
+ *   fcgx_write(void *arg, char *buf, size_t len)
+ *   {
+ *      return FCGX_PutStr(buf, len, (FCGX_Stream*)arg);
+ *   }
+ *   cs = clicon_sink_fn(fcgx_write, r->out);
+ * @endcode
+ */
+clicon_sink *
+clicon_sink_fn(clicon_sink_fn_t *fn,
+	       void             *arg)
+{
+    clicon_sink *cs;
+
+    if ((cs = sink_new(SINK_FN, SINK_BUFLEN)) != NULL){
+	cs->cs_fn = fn;
+	cs->cs_arg = arg;
+    }
+    return cs;
+}
+
+/*! Write data to a sink
+ * @param[in]  cs   Sink
+ * @param[in]  buf  Data
+ * @param[in]  len  Length of data
+ * @retval     0    OK
+ * @retval    -1    Error, also if an earlier write failed
+ */
+int
+clicon_sink_write(clicon_sink *cs,
+		  char        *buf,
+		  size_t       len)
+{
+    size_t n;
+
+    if (cs->cs_err)
+	return -1;
+    if (cs->cs_len + len <= cs->cs_buflen){
+	memcpy(cs->cs_buf + cs->cs_len, buf, len);
+	cs->cs_len += len;
+    }
+    else if (len >= cs->cs_buflen){ /* Large: write with the buffer */
+	if (sink_output(cs, buf, len, 0) < 0)
+	    return -1;
+    }
+    else {
+	n = cs->cs_buflen - cs->cs_len;
+	memcpy(cs->cs_buf + cs->cs_len, buf, n);
+	cs->cs_len += n;
+	if (sink_output(cs, NULL, 0, 0) < 0)
+	    return -1;
+	memcpy(cs->cs_buf, buf + n, len - n);
+	cs->cs_len = len - n;
+    }
+    cs->cs_total += len;
+    return 0;
+}
+
+/*! Write a string to a sink
+ * @param[in]  cs   Sink
+ * @param[in]  str  NUL-terminated string
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+clicon_sink_puts(clicon_sink *cs,
+		 char        *str)
+{
+    return clicon_sink_write(cs, str, strlen(str));
+}
+
+/*! Write a character to a sink
+ * @param[in]  cs   Sink
+ * @param[in]  c    Character
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+clicon_sink_putc(clicon_sink *cs,
+		 int          c)
+{
+    if (cs->cs_err)
+	return -1;
+    if (cs->cs_len == cs->cs_buflen && sink_output(cs, NULL, 0, 0) < 0)
+	return -1;
+    cs->cs_buf[cs->cs_len++] = c;
+    cs->cs_total++;
+    return 0;
+}
+
+/*! Write spaces to a sink, eg for indentation
+ * @param[in]  cs   Sink
+ * @param[in]  n    Number of spaces
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+clicon_sink_indent(clicon_sink *cs,
+		   int          n)
+{
+    while (n-- > 0)
+	if (clicon_sink_putc(cs, ' ') < 0)
+	    return -1;
+    return 0;
+}
+
+/*! Write formatted output to a sink, slower than clicon_sink_puts()
+ * @param[in]  cs      Sink
+ * @param[in]  format  Format string as printf
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+clicon_sink_printf(clicon_sink *cs,
+		   const char  *format, ...)
+{
+    int     retval = -1;
+    va_list args;
+    int     len;
+    char   *str = NULL;
+
+    va_start(args, format);
+    len = vsnprintf(cs->cs_buf + cs->cs_len, cs->cs_buflen - cs->cs_len + 1, 
+		    format, args);
+    va_end(args);
+    if (len < 0){
+	clicon_err(OE_UNIX, errno, "vsnprintf");
+	goto done;
+    }
+    if (cs->cs_len + len <= cs->cs_buflen){ /* Fits in buffer */
+	cs->cs_len += len;
+	cs->cs_total += len;
+    }
+    else{
+	if ((str = malloc(len+1)) == NULL){
+	    clicon_err(OE_UNIX, errno, "malloc");
+	    goto done;
+	}
+	va_start(args, format);
+	vsnprintf(str, len+1, format, args);
+	va_end(args);
+	if (clicon_sink_write(cs, str, len) < 0)
+	    goto done;
+    }
+    retval = 0;
+ done:
+    if (str)
+	free(str);
+    return retval;
+}
+
+/*! Write buffered output of a sink to its destination
+ * For a clicon message sink, this starts a chunked message.
+ * @param[in]  cs   Sink
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+clicon_sink_flush(clicon_sink *cs)
+{
+    if (cs->cs_len == 0)
+	return cs->cs_err?-1:0;
+    return sink_output(cs, NULL, 0, 0);
+}
+
+/*! Get number of bytes written to a sink
+ * @param[in]  cs   Sink
+ * @retval     len  Bytes written, including buffered output
+ */
+size_t
+clicon_sink_len(clicon_sink *cs)
+{
+    return cs->cs_total;
+}
+
+/*! Get errno of a failed write to a sink
+ * @param[in]  cs   Sink
+ * @retval     0    No write has failed
+ * @retval     err  errno of the failed write, eg EPIPE
+ */
+int
+clicon_sink_errno(clicon_sink *cs)
+{
+    return cs->cs_err?cs->cs_errno:0;
+}
+
+/*! Free a sink without writing remaining output
+ * @param[in]  cs   Sink
+ * @see clicon_sink_close
+ */
+int
+clicon_sink_free(clicon_sink *cs)
+{
+    free(cs);
+    return 0;
+}
+
+/*! Write remaining output, and free a sink
+ * A clicon message sink sends the end of the message.
+ * @param[in]  cs   Sink
+ * @retval     0    OK
+ * @retval    -1    Error, also if an earlier write failed. errno is set to the
+ *                  errno of the failed write. The sink is freed
+ */
+int
+clicon_sink_close(clicon_sink *cs)
+{
+    int retval = -1;
+    int err;
+
+    if (cs->cs_type == SINK_MSG){
+	if (clicon_sink_putc(cs, '\0') < 0)
+	    goto done;
+	if (sink_output(cs, NULL, 0, 1) < 0)
+	    goto done;
+    }
+    else if (clicon_sink_flush(cs) < 0)
+	goto done;
+    retval = 0;
+ done:
+    err = clicon_sink_errno(cs);
+    free(cs);
+    if (err)
+	errno = err;
+    return retval;
+}
@@ -47,6 +47,7 @@
 #include <string.h>
 #include <limits.h>
 #include <fnmatch.h>
+#include <dirent.h>
 #include <stdint.h>
 #include <assert.h>
 
@@ -57,6 +58,9 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_string.h"
+#include "clixon_file.h"
+#include "clixon_sink.h"
+#include "clixon_sha1.h"
 
 #include "clixon_queue.h"
 #include "clixon_hash.h"
@@ -69,12 +73,21 @@
 /*
  * Constants
  */
-/* Size of xml read buffer */
-#define BUFLEN 1024  
 /* Indentation for xml pretty-print. Consider option? */
 #define XML_INDENT 3 
 /* Name of xml top object created by xml parse functions */
 #define XML_TOP_SYMBOL "top" 
+/* Build a child name index when a node has at least this many children */
+#define XML_INDEX_MIN 32
+/* Initial size of child name index, must be a power of 2 */
+#define XML_INDEX_INITLEN 16
+/* Size of first memory block of an xml arena, next blocks are doubled */
+#define XML_ARENA_BLOCK 4096
+/* Max size of a memory block of an xml arena */
+#define XML_ARENA_BLOCK_MAX (1024*1024)
+/* Allocations from an xml arena are rounded up to a multiple of this */
+#define XML_ARENA_ALIGN sizeof(void*)
+#define XML_ARENA_ROUND(len) (((len)+XML_ARENA_ALIGN-1) & ~(XML_ARENA_ALIGN-1))
 
 /*
  * Types
@@ -100,22 +113,111 @@
  *   <x>a</<x>
  *   <x>b</<x>
  * </c>
+ * The body of a leaf is a separate CX_BODY child node, held in the inline 
+ * child vector of the leaf. It is not stored in the leaf itself, since
+ * body nodes are used as nodes:
+ * - text_modify(), xml_merge1(), cli_dbxml() and xml_default() get the body 
+ *   node with xml_body_get() or create it with xml_new(), and set its value
+ * - clicon_xml2sink(), xml2sink_view1(), xml2txt(), xml2cli(), xml2json
+ *   (via child_type()) and xml_copy_dirty() walk all children and handle the
+ *   body as a child
+ * - xpath_vec() can return body nodes, see expand_dbvar()
+ * - the xml parser appends text to a body node with xml_value_append()
  */
 struct xml{
     char             *x_name;       /* name of node */
-    char             *x_namespace;  /* namespace, if any */
     struct xml       *x_up;         /* parent node in hierarchy if any */
-    struct xml      **x_childvec;   /* vector of children nodes */
-    int               x_childvec_len;/* length of vector */
-    enum cxobj_type   x_type;       /* type of node: element, attribute, body */
-    char             *x_value;      /* attribute and body nodes have values */
-    int              _x_vector_i;   /* internal use: xml_child_each */
-    int               x_flags;      /* Flags according to XML_FLAG_* above */
+    struct xml      **x_childvec;   /* vector of children nodes, or x_u.xu_child
+				       if the node has a single child */
+    union {
+	char         *xu_value;     /* attribute and body nodes have values */
+	struct xml   *xu_child;     /* inline child vector of length one, eg
+				       the body of a leaf, see xml_child_append */
+    } x_u;
     yang_stmt        *x_spec;       /* Pointer to specification, eg yang, by 
 				       reference, dont free */
-    cg_var           *x_cv;         /* If body this contains the typed value */
+    struct xml_ext   *x_ext;        /* Seldom used fields, or NULL */
+    struct xml_arena *x_arena;      /* Arena of node and its strings, or NULL
+				       if allocated with malloc */
+    int               x_childvec_len;/* length of vector */
+    int               x_childvec_max;/* Allocated length of child vector */
+    int              _x_vector_i;   /* internal use: xml_child_each */
+    uint16_t          x_flags;      /* Flags according to XML_FLAG_* above */
+    int8_t            x_type;       /* type of node: element, attribute, body,
+				       see enum cxobj_type */
+    uint8_t           x_name_atom;  /* x_name is interned, dont free, see
+				       xml_name_intern() */
+};
+
+/*! Seldom used fields of an xml node, allocated on demand
+ * Most nodes of a large tree are leafs and bodies without namespace, which
+ * keeps struct xml small.
+ */
+struct xml_ext{
+    char             *xe_namespace; /* namespace, if any */
+    cg_var           *xe_cv;        /* Cached typed value of body, eg leaf-list
+				       entry, list key or (first key of) list
+				       entry. See xml_cmp() */
+    struct xml      **xe_index;     /* Hash index: name -> first child with that
+				       name. Built lazily by xml_find() */
+    int               xe_index_len; /* Size of index (power of 2) or 0 */
+    int               xe_index_nr;  /* Number of used entries in index */
+    unsigned char    *xe_hash;      /* Digest of subtree of a node with element
+				       children, valid if XML_FLAG_HASHED */
+};
+
+/* Child vector of x is the inline vector in the node itself */
+#define XML_CHILD_INLINE(x) ((x)->x_childvec == &(x)->x_u.xu_child)
+
+/* Child name index of x, or NULL */
+#define XML_INDEX(x) ((x)->x_ext?(x)->x_ext->xe_index:NULL)
+
+/* Internal xml_flag(): hash of node is computed and the node and its subtree
+ * are unchanged since, see xml_hash(). Set on all descendants of a node where
+ * it is set. */
+#define XML_FLAG_HASHED 0x8000
+
+/*! Memory block of an xml arena, the memory follows the header
+ */
+struct xml_arena_block{
+    struct xml_arena_block *xb_next;  /* Next (older) block */
 };
 
+/*! Region of memory for the nodes of an xml tree that are freed together
+ * Nodes, names, values and child vectors of a tree created with
+ * xml_new_arena() are allocated from a list of blocks. Freeing the root frees
+ * all blocks without visiting the nodes. A node created under a parent gets 
+ * the arena of the parent, and memory released by a node (eg an old value) is
+ * reclaimed only when the arena is freed.
+ * If nodes of other arenas or malloced nodes are added to the tree, or nodes
+ * are removed and kept, the tree is freed node by node and the arena is freed
+ * when its last node is freed.
+ * Therefore, an arena should be used for short-lived trees, eg parsed 
+ * messages, and not for trees edited for a long time.
+ */
+struct xml_arena{
+    struct xml_arena_block *xa_block; /* Current block, first in list */
+    char             *xa_next;      /* Next free memory in current block */
+    size_t            xa_left;      /* Free bytes in current block */
+    size_t            xa_blocklen;  /* Size of next block */
+    cxobj            *xa_root;      /* Root of tree, freeing it frees arena */
+    int               xa_nodes;     /* Nodes allocated and not freed */
+    int               xa_ext;       /* Malloced objects of nodes (xe_cv, 
+				       xe_index)*/
+    int               xa_walk;      /* Tree may have foreign nodes, or arena
+				       nodes may be outside the tree */
+};
+
+static int xml_index_free(cxobj *x);
+static int xml_child_rm1(cxobj *xp, int i);
+
+/* Interned names: name -> shared copy of name (the key), see xml_name_intern() */
+static clicon_hash_t *xml_names = NULL;
+
+/* Names interned with the names of a yang spec, see xml_name_intern_yang() */
+static char *xml_names_default[] = {"body", XML_TOP_SYMBOL, "config", "data",
+				    NULL};
+
 /* Mapping between xml type <--> string */
 static const map_str2int xsmap[] = {
     {"error",         CX_ERROR}, 
@@ -136,6 +238,337 @@ xml_type2str(enum cxobj_type type)
     return (char*)clicon_int2str(xsmap, type);
 }
 
+/*
+ * Arena allocation, see struct xml_arena
+ */
+/*! Create an xml arena
+ * @retval  xa    Arena, free with xml_arena_free()
+ * @retval  NULL  Error
+ */
+static struct xml_arena *
+xml_arena_new(void)
+{
+    struct xml_arena *xa;
+
+    if ((xa = malloc(sizeof(*xa))) == NULL){
+	clicon_err(OE_XML, errno, "%s: malloc", __FUNCTION__);
+	return NULL;
+    }
+    memset(xa, 0, sizeof(*xa));
+    xa->xa_blocklen = XML_ARENA_BLOCK;
+    return xa;
+}
+
+/*! Free an xml arena and all memory allocated from it
+ * @param[in]  xa   Arena
+ */
+static int
+xml_arena_free(struct xml_arena *xa)
+{
+    struct xml_arena_block *xb;
+
+    while ((xb = xa->xa_block) != NULL){
+	xa->xa_block = xb->xb_next;
+	free(xb);
+    }
+    free(xa);
+    return 0;
+}
+
+/*! Allocate memory from an xml arena
+ * Large allocations get a block of their own, otherwise the free memory of
+ * the current block would be lost.
+ * @param[in]  xa   Arena
+ * @param[in]  len  Number of bytes
+ * @retval     p    Memory, released when arena is freed
+ * @retval     NULL Error
+ */
+static void *
+xml_arena_alloc(struct xml_arena *xa,
+		size_t            len)
+{
+    struct xml_arena_block *xb;
+    size_t                  blen;
+    int                     own;
+    char                   *p;
+
+    len = XML_ARENA_ROUND(len);
+    if (len > xa->xa_left){
+	own = len > xa->xa_blocklen/4;
+	blen = own ? len : xa->xa_blocklen;
+	if ((xb = malloc(sizeof(*xb) + blen)) == NULL){
+	    clicon_err(OE_XML, errno, "%s: malloc", __FUNCTION__);
+	    return NULL;
+	}
+	if (own && xa->xa_block){ /* Insert after current block */
+	    xb->xb_next = xa->xa_block->xb_next;
+	    xa->xa_block->xb_next = xb;
+	    return (char*)(xb+1);
+	}
+	xb->xb_next = xa->xa_block;
+	xa->xa_block = xb;
+	xa->xa_next = (char*)(xb+1);
+	xa->xa_left = blen;
+	if (!own && xa->xa_blocklen < XML_ARENA_BLOCK_MAX)
+	    xa->xa_blocklen *= 2;
+    }
+    p = xa->xa_next;
+    xa->xa_next += len;
+    xa->xa_left -= len;
+    return p;
+}
+
+/*! Allocate node memory, from arena if given, otherwise with malloc
+ * @param[in]  xa   Arena or NULL
+ * @param[in]  len  Number of bytes
+ * @retval     p    Memory, release with xml_mem_free()
+ * @retval     NULL Error
+ */
+static void *
+xml_mem_alloc(struct xml_arena *xa,
+	      size_t            len)
+{
+    void *p;
+
+    if (xa)
+	return xml_arena_alloc(xa, len);
+    if ((p = malloc(len)) == NULL)
+	clicon_err(OE_XML, errno, "%s: malloc", __FUNCTION__);
+    return p;
+}
+
+/*! Resize node memory, from arena if given, otherwise with realloc
+ * In an arena, the last allocation of the current block is extended in place,
+ * so that eg a body appended to repeatedly by the parser is not copied.
+ * @param[in]  xa   Arena or NULL
+ * @param[in]  p    Memory allocated by xml_mem_alloc(), or NULL
+ * @param[in]  len0 Size of p
+ * @param[in]  len  New size
+ * @retval     p    Memory, release with xml_mem_free()
+ * @retval     NULL Error, p is not released
+ */
+static void *
+xml_mem_realloc(struct xml_arena *xa,
+		void             *p,
+		size_t            len0,
+		size_t            len)
+{
+    void  *p1;
+    size_t grow;
+
+    if (xa == NULL){
+	if ((p1 = realloc(p, len)) == NULL)
+	    clicon_err(OE_XML, errno, "%s: realloc", __FUNCTION__);
+	return p1;
+    }
+    if (p && len <= len0)
+	return p;
+    grow = XML_ARENA_ROUND(len) - XML_ARENA_ROUND(len0);
+    if (p && (char*)p + XML_ARENA_ROUND(len0) == xa->xa_next &&
+	grow <= xa->xa_left){
+	xa->xa_next += grow;
+	xa->xa_left -= grow;
+	return p;
+    }
+    if ((p1 = xml_arena_alloc(xa, len)) == NULL)
+	return NULL;
+    if (p)
+	memcpy(p1, p, len0);
+    return p1;
+}
+
+/*! Release node memory, a no-op in an arena
+ * @param[in]  xa   Arena or NULL
+ * @param[in]  p    Memory allocated by xml_mem_alloc() or NULL
+ */
+static void
+xml_mem_free(struct xml_arena *xa,
+	     void             *p)
+{
+    if (xa == NULL && p)
+	free(p);
+}
+
+/*! Copy a string into node memory
+ * @param[in]  xa   Arena or NULL
+ * @param[in]  str  String
+ * @retval     p    Copy of str, release with xml_mem_free()
+ * @retval     NULL Error
+ */
+static char *
+xml_mem_strdup(struct xml_arena *xa,
+	       char             *str)
+{
+    size_t len = strlen(str) + 1;
+    char  *p;
+
+    if ((p = xml_mem_alloc(xa, len)) != NULL)
+	memcpy(p, str, len);
+    return p;
+}
+
+/*! Mark that the tree of a node has nodes not in its arena or vice-versa
+ * Called when a node is added to a parent of another arena, or removed from
+ * its parent but not freed. The tree is then freed node by node.
+ * @param[in]  x    XML node
+ */
+static inline void
+xml_arena_walk(cxobj *x)
+{
+    if (x->x_arena)
+	x->x_arena->xa_walk = 1;
+}
+
+/*! Get seldom used fields of a node, allocate them if not present
+ * @param[in]  x    XML node
+ * @retval     xe   Extension fields of node
+ * @retval     NULL Error
+ */
+static struct xml_ext *
+xml_ext_get(cxobj *x)
+{
+    if (x->x_ext == NULL){
+	if ((x->x_ext = xml_mem_alloc(x->x_arena, sizeof(struct xml_ext))) == NULL)
+	    return NULL;
+	memset(x->x_ext, 0, sizeof(struct xml_ext));
+    }
+    return x->x_ext;
+}
+
+/*! Invalidate hash of a modified node and of its ancestors
+ * Stops at the first node without hash, since none of its ancestors have one.
+ * @param[in]  x    XML node whose name, value or children are changed
+ * @see xml_hash
+ */
+static inline void
+xml_hash_reset(cxobj *x)
+{
+    while (x && (x->x_flags & XML_FLAG_HASHED)){
+	x->x_flags &= ~XML_FLAG_HASHED;
+	x = x->x_up;
+    }
+}
+
+/*! Drop typed value of the first key cached in a list entry
+ * Called when a child element of the entry is removed, replaced or renamed. If
+ * it is the first key, the cached value is stale.
+ * @param[in]  xp    xml list entry, or other node
+ * @param[in]  xc    child element of xp, or NULL
+ * @see xml_body_cv_reset
+ */
+static int
+xml_key_cv_reset(cxobj *xp,
+		 cxobj *xc)
+{
+    yang_stmt *y;
+
+    if (xc == NULL || xc->x_type != CX_ELMNT || xml_cv_get(xp) == NULL)
+	return 0;
+    if ((y = xp->x_spec) == NULL || y->ys_keyword != Y_LIST)
+	return 0;
+    if (y->ys_cvec == NULL || cvec_len(y->ys_cvec) == 0 ||
+	(xc->x_name && xml_name_eq(xc, cv_string_get(cvec_i(y->ys_cvec, 0)))))
+	xml_cv_set(xp, NULL);
+    return 0;
+}
+
+/*! Move the inline child of a node to an allocated child vector
+ * Needed before the value of the node is set, since they share memory. 
+ * @param[in]  x    XML node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_child_uninline(cxobj *x)
+{
+    cxobj **vec;
+
+    if (!XML_CHILD_INLINE(x))
+	return 0;
+    if ((vec = xml_mem_alloc(x->x_arena, 2*sizeof(cxobj*))) == NULL)
+	return -1;
+    vec[0] = x->x_u.xu_child;
+    x->x_u.xu_child = NULL;
+    x->x_childvec = vec;
+    x->x_childvec_max = 2;
+    return 0;
+}
+
+/*
+ * Interned names
+ * The name of an xml node whose yang spec is loaded is a pointer to a shared
+ * copy of the name (an atom) instead of a copy per node. Names of nodes can 
+ * then be compared as pointers before strcmp, see xml_name_eq().
+ */
+/*! Intern a name, xml nodes created with this name thereafter share one copy
+ * Interned names are never freed. Intern names from a closed set, such as a 
+ * yang spec, not names from input.
+ * @param[in]  name  Name
+ * @retval     atom  Interned copy of name
+ * @retval     NULL  Error
+ * @see xml_name_intern_yang
+ */
+char *
+xml_name_intern(char *name)
+{
+    clicon_hash_t h;
+    size_t        len;
+
+    if (xml_names == NULL && (xml_names = hash_init()) == NULL)
+	return NULL;
+    if ((h = hash_lookup(xml_names, name)) == NULL){
+	len = strlen(name);
+	if ((h = hash_add(xml_names, name, &len, sizeof(len))) == NULL)
+	    return NULL;
+    }
+    return h->h_key;
+}
+
+/*! Get interned copy of a name
+ * @param[in]  name  Name
+ * @retval     atom  Interned copy of name
+ * @retval     NULL  Name is not interned
+ * @see xml_name_intern
+ */
+char *
+xml_name_interned(char *name)
+{
+    clicon_hash_t h;
+
+    if (xml_names && (h = hash_lookup(xml_names, name)) != NULL)
+	return h->h_key;
+    return NULL;
+}
+
+/*! Intern name of a yang schema node, yang_apply() callback
+ */
+static int
+xml_name_intern_ys(yang_stmt *ys,
+		   void      *arg)
+{
+    if (yang_schemanode(ys) && ys->ys_argument &&
+	xml_name_intern(ys->ys_argument) == NULL)
+	return -1;
+    return 0;
+}
+
+/*! Intern the names of all schema nodes of a yang spec
+ * Called when a yang spec has been parsed.
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xml_name_intern_yang(yang_spec *yspec)
+{
+    int i;
+
+    for (i=0; xml_names_default[i]; i++)
+	if (xml_name_intern(xml_names_default[i]) == NULL)
+	    return -1;
+    return yang_apply((yang_node*)yspec, -1, xml_name_intern_ys, NULL);
+}
+
 /*
  * Access functions
  */
@@ -149,9 +582,45 @@ xml_name(cxobj *xn)
     return xn->x_name;
 }
 
+/*! Check if name of xnode is equal to a name
+ * Cheap if the name is the interned name of the node, eg xml_name() of 
+ * another node, see xml_name_intern().
+ * @param[in]  xn    xml node
+ * @param[in]  name  name
+ * @retval     1     Equal
+ * @retval     0     Not equal
+ */
+int
+xml_name_eq(cxobj *xn, 
+	    char  *name)
+{
+    return xn->x_name == name || strcmp(xn->x_name, name) == 0;
+}
+
+/*! Check if name of xnode is equal to a name, whose interned copy is known
+ * An interned node name is only equal to the interned copy of name, so no
+ * strcmp is needed. Look up the atom once before comparing many nodes.
+ * @param[in]  xn    xml node
+ * @param[in]  name  name
+ * @param[in]  atom  Interned copy of name, or NULL if name is not interned,
+ *                   see xml_name_interned()
+ * @retval     1     Equal
+ * @retval     0     Not equal
+ */
+int
+xml_name_eq_atom(cxobj *xn, 
+		 char  *name,
+		 char  *atom)
+{
+    if (xn->x_name_atom)
+	return xn->x_name == atom;
+    return strcmp(xn->x_name, name) == 0;
+}
+
 /*! Set name of xnode, name is copied
  * @param[in]  xn    xml node
- * @param[in]  name  new name, null-terminated string, copied by function
+ * @param[in]  name  new name, null-terminated string, copied by function,
+ *                   or shared if interned, see xml_name_intern()
  * @retval     -1    on error with clicon-err set
  * @retval     0     OK
  */
@@ -159,15 +628,24 @@ int
 xml_name_set(cxobj *xn, 
 	     char  *name)
 {
+    xml_hash_reset(xn);
+    if (xn->x_up) /* Renamed from first key */
+	xml_key_cv_reset(xn->x_up, xn);
+    if (xn->x_up && XML_INDEX(xn->x_up)) /* Name index of parent is stale */
+	xml_index_free(xn->x_up);
     if (xn->x_name){
-	free(xn->x_name);
+	if (!xn->x_name_atom)
+	    xml_mem_free(xn->x_arena, xn->x_name);
 	xn->x_name = NULL;
+	xn->x_name_atom = 0;
     }
     if (name){
-	if ((xn->x_name = strdup(name)) == NULL){
-	    clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
+	if ((xn->x_name = xml_name_interned(name)) != NULL)
+	    xn->x_name_atom = 1;
+	else if ((xn->x_name = xml_mem_strdup(xn->x_arena, name)) == NULL)
 	    return -1;
-	}
+	if (xn->x_up) /* Renamed to first key */
+	    xml_key_cv_reset(xn->x_up, xn);
     }
     return 0;
 }
@@ -179,7 +657,7 @@ xml_name_set(cxobj *xn,
 char*
 xml_namespace(cxobj *xn)
 {
-    return xn->x_namespace;
+    return xn->x_ext?xn->x_ext->xe_namespace:NULL;
 }
 
 /*! Set name of xnode, name is copied
@@ -192,15 +670,18 @@ int
 xml_namespace_set(cxobj *xn, 
 		  char  *namespace)
 {
-    if (xn->x_namespace){
-	free(xn->x_namespace);
-	xn->x_namespace = NULL;
+    struct xml_ext *xe;
+
+    xml_hash_reset(xn);
+    if ((xe = xn->x_ext) != NULL && xe->xe_namespace){
+	xml_mem_free(xn->x_arena, xe->xe_namespace);
+	xe->xe_namespace = NULL;
     }
     if (namespace){
-	if ((xn->x_namespace = strdup(namespace)) == NULL){
-	    clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
+	if ((xe = xml_ext_get(xn)) == NULL)
+	    return -1;
+	if ((xe->xe_namespace = xml_mem_strdup(xn->x_arena, namespace)) == NULL)
 	    return -1;
-	}
     }
     return 0;
 }
@@ -270,7 +751,27 @@ xml_flag_reset(cxobj   *xn,
 char*
 xml_value(cxobj *xn)
 {
-    return xn->x_value;
+    if (XML_CHILD_INLINE(xn))
+	return NULL;
+    return xn->x_u.xu_value;
+}
+
+/*! Drop typed values cached from the value of a body node
+ * The typed value is cached in the parent element, or for the first key of a
+ * list, in the list entry, ie the grandparent.
+ * @param[in]  xb    xml body node
+ * @see xml_cv_set
+ */
+static int
+xml_body_cv_reset(cxobj *xb)
+{
+    cxobj *xp;
+    int    i;
+
+    for (i=0, xp=xb->x_up; i<2 && xp; i++, xp=xp->x_up)
+	if (xml_cv_get(xp))
+	    xml_cv_set(xp, NULL);
+    return 0;
 }
 
 /*! Set value of xml node, value is copied
@@ -283,15 +784,22 @@ int
 xml_value_set(cxobj *xn, 
 	      char  *val)
 {
-    if (xn->x_value){
-	free(xn->x_value);
-	xn->x_value = NULL;
+    xml_hash_reset(xn);
+    if (xn->x_type == CX_BODY)
+	xml_body_cv_reset(xn);
+    if (XML_CHILD_INLINE(xn)){
+	if (val == NULL)
+	    return 0;
+	if (xml_child_uninline(xn) < 0)
+	    return -1;
+    }
+    if (xn->x_u.xu_value){
+	xml_mem_free(xn->x_arena, xn->x_u.xu_value);
+	xn->x_u.xu_value = NULL;
     }
     if (val){
-	if ((xn->x_value = strdup(val)) == NULL){
-	    clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
+	if ((xn->x_u.xu_value = xml_mem_strdup(xn->x_arena, val)) == NULL)
 	    return -1;
-	}
     }
     return 0;
 }
@@ -306,19 +814,30 @@ char *
 xml_value_append(cxobj *xn, 
 		 char  *val)
 {
-    int len0;
-    int len;
+    int   len0;
+    int   len;
+    char *value;
     
-    len0 = xn->x_value?strlen(xn->x_value):0;
+    xml_hash_reset(xn);
+    if (xn->x_type == CX_BODY)
+	xml_body_cv_reset(xn);
+    if (XML_CHILD_INLINE(xn)){
+	if (val == NULL)
+	    return NULL;
+	if (xml_child_uninline(xn) < 0)
+	    return NULL;
+    }
+    value = xn->x_u.xu_value;
+    len0 = value?strlen(value):0;
     if (val){
 	len = len0 + strlen(val);
-	if ((xn->x_value = realloc(xn->x_value, len+1)) == NULL){
-	    clicon_err(OE_XML, errno, "realloc");
+	if ((value = xml_mem_realloc(xn->x_arena, value,
+				     value?len0+1:0, len+1)) == NULL)
 	    return NULL;
-	}
-	strncpy(xn->x_value + len0, val, len-len0+1);
+	xn->x_u.xu_value = value;
+	strncpy(value + len0, val, len-len0+1);
     }
-    return xn->x_value;
+    return value;
 }
 
 /*! Get type of xnode
@@ -342,6 +861,7 @@ xml_type_set(cxobj          *xn,
 {
     enum cxobj_type old = xn->x_type;
 
+    xml_hash_reset(xn);
     xn->x_type = type;
     return old;
 }
@@ -354,24 +874,35 @@ xml_type_set(cxobj          *xn,
 cg_var *
 xml_cv_get(cxobj *xn)
 {
-  if (xn->x_cv)
-    return xn->x_cv;
+  if (xn->x_ext)
+    return xn->x_ext->xe_cv;
   else
     return NULL;
 }
 
 /*! Set cligen variable associated with node
  * @param[in]  xn    xml node
- * @param[in]  cv    Cligen variable or NULL
+ * @param[in]  cv    Cligen variable or NULL. Consumed by the node
  * @retval     0     if OK
+ * @note The cv is dropped when the body value of the node changes
  */
 int
 xml_cv_set(cxobj  *xn, 
 	   cg_var *cv)
 {
-  if (xn->x_cv)
-    free(xn->x_cv);
-  xn->x_cv = cv;
+  struct xml_ext *xe;
+
+  if ((xe = xn->x_ext) == NULL){
+      if (cv == NULL)
+	  return 0;
+      if ((xe = xml_ext_get(xn)) == NULL)
+	  return -1;
+  }
+  if (xe->xe_cv)
+    cv_free(xe->xe_cv);
+  if (xn->x_arena) /* Count cvs, they must be freed with the tree */
+      xn->x_arena->xa_ext += (cv != NULL) - (xe->xe_cv != NULL);
+  xe->xe_cv = cv;
   return 0;
 }
 
@@ -427,8 +958,15 @@ xml_child_i_set(cxobj *xt,
 		int    i, 
 		cxobj *xc)
 {
-    if (i < xt->x_childvec_len)
+    if (i < xt->x_childvec_len){
+	xml_hash_reset(xt);
+	xml_key_cv_reset(xt, xt->x_childvec[i]);
+	xml_key_cv_reset(xt, xc);
 	xt->x_childvec[i] = xc;
+	xml_index_free(xt);
+	if (xc && xc->x_arena != xt->x_arena)
+	    xml_arena_walk(xt);
+    }
     return 0;
 }
 
@@ -471,20 +1009,213 @@ xml_child_each(cxobj           *xparent,
     return xn;
 }
 
+/*
+ * Child name index. 
+ * A node with many children has an open-addressing hash table (linear
+ * probing) mapping a child name to the first child with that name. It is
+ * built lazily by xml_find() and kept up-to-date when children are appended
+ * or removed. Operations that reorder the child vector drop the index.
+ */
+
+/*! Hash function for child name index
+ */
+static inline uint32_t
+xml_index_hash(char *name)
+{
+    uint32_t h = 5381;
+
+    while (*name)
+	h = ((h << 5) + h) + (uint8_t)*name++;
+    return h;
+}
+
+/*! Find slot of a name in the child name index of a node
+ * @param[in]  x     XML node with index built
+ * @param[in]  name  Name of child
+ * @retval     i     Slot in index, either holding child with name, or empty
+ */
+static int
+xml_index_slot(cxobj *x,
+	       char  *name)
+{
+    int    mask = x->x_ext->xe_index_len-1;
+    int    i;
+    cxobj *xc;
+
+    i = xml_index_hash(name) & mask;
+    while ((xc = x->x_ext->xe_index[i]) != NULL){
+	if (xml_name_eq(xc, name))
+	    break;
+	i = (i+1) & mask;
+    }
+    return i;
+}
+
+/*! Free child name index of a node, it is rebuilt on demand by xml_find()
+ * @param[in]  x     XML node
+ */
+static int
+xml_index_free(cxobj *x)
+{
+    struct xml_ext *xe;
+
+    if ((xe = x->x_ext) == NULL)
+	return 0;
+    if (xe->xe_index){
+	free(xe->xe_index);
+	xe->xe_index = NULL;
+	if (x->x_arena)
+	    x->x_arena->xa_ext--;
+    }
+    xe->xe_index_len = 0;
+    xe->xe_index_nr = 0;
+    return 0;
+}
+
+/*! Add child to name index of a node, unless a child with same name exists
+ * @param[in]  x     XML node
+ * @param[in]  xc    Child xml node, last in child vector of x
+ * @retval     0     OK
+ * @retval    -1     Error, index is freed
+ */
+static int
+xml_index_add(cxobj *x,
+	      cxobj *xc)
+{
+    struct xml_ext *xe;
+    cxobj         **vec;
+    int             len;
+    int             i;
+
+    if (xc->x_name == NULL)
+	return 0;
+    if ((xe = xml_ext_get(x)) == NULL)
+	return -1;
+    if (xe->xe_index_len && xe->xe_index[xml_index_slot(x, xc->x_name)] != NULL)
+	return 0; /* Not first child with this name */
+    if (2*(xe->xe_index_nr+1) > xe->xe_index_len){ /* Grow: keep load below 1/2 */
+	vec = xe->xe_index;
+	len = xe->xe_index_len;
+	xe->xe_index_len = len?2*len:XML_INDEX_INITLEN;
+	if ((xe->xe_index = calloc(xe->xe_index_len, sizeof(cxobj*))) == NULL){
+	    clicon_err(OE_XML, errno, "%s: calloc", __FUNCTION__);
+	    xe->xe_index = vec;
+	    xml_index_free(x);
+	    return -1;
+	}
+	for (i=0; i<len; i++)
+	    if (vec[i] != NULL)
+		xe->xe_index[xml_index_slot(x, vec[i]->x_name)] = vec[i];
+	if (vec)
+	    free(vec);
+	else if (x->x_arena) /* Count index, it must be freed with the tree */
+	    x->x_arena->xa_ext++;
+    }
+    xe->xe_index[xml_index_slot(x, xc->x_name)] = xc;
+    xe->xe_index_nr++;
+    return 0;
+}
+
+/*! Remove child from name index of a node
+ * If xc is indexed, it is replaced by the next child with the same name, if
+ * any. Otherwise its slot is emptied by shifting back later entries in the
+ * probe sequence.
+ * @param[in]  x     XML node
+ * @param[in]  xc    Child xml node, already removed from child vector of x
+ * @param[in]  pos   Former position of xc in child vector of x
+ */
+static int
+xml_index_rm(cxobj *x,
+	     cxobj *xc,
+	     int    pos)
+{
+    struct xml_ext *xe = x->x_ext;
+    int             mask = xe->xe_index_len-1;
+    int             i;
+    int             j;
+    int             k;
+    cxobj          *xn;
+
+    if (xc->x_name == NULL)
+	return 0;
+    i = xml_index_slot(x, xc->x_name);
+    if (xe->xe_index[i] != xc) 
+	return 0; /* Not first child with this name */
+    for (; pos<x->x_childvec_len; pos++){
+	xn = x->x_childvec[pos];
+	if (xn->x_name && xml_name_eq(xn, xc->x_name)){
+	    xe->xe_index[i] = xn;
+	    return 0;
+	}
+    }
+    xe->xe_index[i] = NULL;
+    xe->xe_index_nr--;
+    j = i;
+    while ((xn = xe->xe_index[j = (j+1) & mask]) != NULL){
+	k = xml_index_hash(xn->x_name) & mask;
+	/* Entry stays if its home slot k is cyclically in (i,j] */
+	if (i<=j ? (i<k && k<=j) : (i<k || k<=j))
+	    continue;
+	xe->xe_index[i] = xn;
+	xe->xe_index[j] = NULL;
+	i = j;
+    }
+    return 0;
+}
+
+/*! Build child name index of a node
+ * @param[in]  x     XML node
+ * @retval     0     OK
+ * @retval    -1     Error, no index
+ */
+static int
+xml_index_build(cxobj *x)
+{
+    int i;
+
+    for (i=0; i<x->x_childvec_len; i++)
+	if (xml_index_add(x, x->x_childvec[i]) < 0)
+	    return -1;
+    return 0;
+}
+
 /*! Extend child vector with one and insert xml node there
+ * The child vector is doubled when full.
  * Note: does not do anything with child, you may need to set its parent, etc
  */
 static int
 xml_child_append(cxobj *x, 
 		 cxobj *xc)
 {
-    x->x_childvec_len++;
-    x->x_childvec = realloc(x->x_childvec, x->x_childvec_len*sizeof(cxobj*));
-    if (x->x_childvec == NULL){
-	clicon_err(OE_XML, errno, "%s: realloc", __FUNCTION__);
-	return -1;
+    cxobj **vec;
+    int     max;
+
+    if (x->x_childvec_len == x->x_childvec_max){
+	if (x->x_childvec_max == 0 && x->x_u.xu_value == NULL){
+	    /* First child of a node without value, eg body of leaf: inline */
+	    x->x_childvec = &x->x_u.xu_child;
+	    x->x_childvec_max = 1;
+	}
+	else if (XML_CHILD_INLINE(x)){
+	    if (xml_child_uninline(x) < 0)
+		return -1;
+	}
+	else {
+	    max = x->x_childvec_max ? 2*x->x_childvec_max : 1;
+	    if ((vec = xml_mem_realloc(x->x_arena, x->x_childvec, 
+				       x->x_childvec_max*sizeof(cxobj*),
+				       max*sizeof(cxobj*))) == NULL)
+		return -1;
+	    x->x_childvec = vec;
+	    x->x_childvec_max = max;
+	}
     }
-    x->x_childvec[x->x_childvec_len-1] = xc;
+    if (xc->x_arena != x->x_arena)
+	xml_arena_walk(x);
+    xml_hash_reset(x);
+    x->x_childvec[x->x_childvec_len++] = xc;
+    if (XML_INDEX(x) && xml_index_add(x, xc) < 0)
+	return -1;
     return 0;
 }
 
@@ -499,20 +1230,74 @@ int
 xml_childvec_set(cxobj *x, 
 		 int    len)
 {
-    x->x_childvec_len = len;
-    if ((x->x_childvec = calloc(len, sizeof(cxobj*))) == NULL){
-	clicon_err(OE_XML, errno, "calloc");
+    int i;
+
+    xml_hash_reset(x);
+    for (i=0; i<x->x_childvec_len; i++)
+	xml_key_cv_reset(x, x->x_childvec[i]);
+    xml_index_free(x);
+    if (XML_CHILD_INLINE(x))
+	x->x_u.xu_child = NULL;
+    else
+	xml_mem_free(x->x_arena, x->x_childvec);
+    x->x_childvec = NULL;
+    x->x_childvec_len = 0;
+    x->x_childvec_max = 0;
+    if (len == 0)
+	return 0;
+    if ((x->x_childvec = xml_mem_alloc(x->x_arena, len*sizeof(cxobj*))) == NULL)
 	return -1;
-    }
+    memset(x->x_childvec, 0, len*sizeof(cxobj*));
+    x->x_childvec_len = len;
+    x->x_childvec_max = len;
     return 0;
 }
 
+/*! Get the child vector of a node
+ * @param[in]  x     XML node
+ * @retval     vec   Child vector, length given by xml_child_nr()
+ * @note The caller may reorder the vector (eg xml_sort), therefore the child
+ *       name index and the hash of the node are dropped.
+ */
 cxobj **
 xml_childvec_get(cxobj *x)
 {
+    xml_hash_reset(x);
+    xml_index_free(x);
     return x->x_childvec;
 }
 
+/*! Create new xml node in an arena or with malloc
+ * @param[in]  name      Name of XML node
+ * @param[in]  xp        The parent where the new xml node will be appended
+ * @param[in]  yspec     Yang statement of this XML or NULL.
+ * @param[in]  xa        Arena or NULL
+ * @see xml_new
+ */
+static cxobj *
+xml_new1(char             *name, 
+	 cxobj            *xp,
+	 yang_stmt        *yspec,
+	 struct xml_arena *xa)
+{
+    cxobj *x;
+    
+    if ((x = xml_mem_alloc(xa, sizeof(cxobj))) == NULL)
+	return NULL;
+    memset(x, 0, sizeof(cxobj));
+    if ((x->x_arena = xa) != NULL)
+	xa->xa_nodes++;
+    if ((xml_name_set(x, name)) < 0)
+	return NULL;
+    if (xp){
+	xml_parent_set(x, xp);
+	if (xml_child_append(xp, x) < 0) 
+	    return NULL;
+    }
+    x->x_spec = yspec; /* Can be NULL */
+    return x;
+}
+
 /*! Create new xml node given a name and parent. Free with xml_free().
  *
  * @param[in]  name      Name of XML node
@@ -529,28 +1314,45 @@ xml_childvec_get(cxobj *x)
  * @endcode
  * @note yspec may be NULL either because it is not known or it is irrelevant, 
  *       eg for body or attribute
+ * @note The node is allocated in the arena of xp, if any
  * @see xml_sort_insert
+ * @see xml_new_arena
  */
 cxobj *
 xml_new(char      *name, 
 	cxobj     *xp,
 	yang_stmt *yspec)
 {
-    cxobj *x;
-    
-    if ((x = malloc(sizeof(cxobj))) == NULL){
-	clicon_err(OE_XML, errno, "%s: malloc", __FUNCTION__);
+    return xml_new1(name, xp, yspec, xp?xp->x_arena:NULL);
+}
+
+/*! Create new xml root node with an arena for the nodes of its tree
+ *
+ * Nodes created under the root, eg by the parser or xml_copy(), are allocated
+ * from the arena. Freeing the root with xml_free() frees the arena in one 
+ * operation instead of node by node. 
+ * @param[in]  name      Name of XML node
+ * @param[in]  yspec     Yang statement of this XML or NULL.
+ * @retval     xml       Created xml object if successful. Free with xml_free()
+ * @retval     NULL      Error and clicon_err() called
+ * @note Memory of removed nodes and replaced values is not reused until the 
+ *       tree is freed. Use for short-lived trees, not trees edited over time.
+ * @see xml_new
+ */
+cxobj *
+xml_new_arena(char      *name, 
+	      yang_stmt *yspec)
+{
+    struct xml_arena *xa;
+    cxobj            *x;
+
+    if ((xa = xml_arena_new()) == NULL)
 	return NULL;
-    }
-    memset(x, 0, sizeof(cxobj));
-    if ((xml_name_set(x, name)) < 0)
+    if ((x = xml_new1(name, NULL, yspec, xa)) == NULL){
+	xml_arena_free(xa);
 	return NULL;
-    if (xp){
-	xml_parent_set(x, xp);
-	if (xml_child_append(xp, x) < 0) 
-	    return NULL;
     }
-    x->x_spec = yspec; /* Can be NULL */
+    xa->xa_root = x;
     return x;
 }
 
@@ -581,6 +1383,8 @@ xml_spec_set(cxobj     *x,
  *
  * @retval xmlobj     if found.
  * @retval NULL       if no such node found.
+ * @note If x_up has many children (XML_INDEX_MIN), a child name index is built
+ *       and used for lookup instead of a linear search.
  */
 cxobj *
 xml_find(cxobj *x_up, 
@@ -588,8 +1392,12 @@ xml_find(cxobj *x_up,
 {
     cxobj *x = NULL;
 
+    if (XML_INDEX(x_up) == NULL && x_up->x_childvec_len >= XML_INDEX_MIN)
+	xml_index_build(x_up); /* On error, fall back to linear search */
+    if (XML_INDEX(x_up) != NULL)
+	return x_up->x_ext->xe_index[xml_index_slot(x_up, name)];
     while ((x = xml_child_each(x_up, x, -1)) != NULL) 
-	if (strcmp(name, xml_name(x)) == 0)
+	if (xml_name_eq(x, name))
 	    return x;
     return NULL;
 }
@@ -615,7 +1423,9 @@ xml_addsub(cxobj *xp,
 		break;
 	/* Remove xc from old parent */
 	if (i < xml_child_nr(oldp))
-	    xml_child_rm(oldp, i);
+	    xml_child_rm1(oldp, i);
+	if (xp == NULL || xp->x_arena != xc->x_arena)
+	    xml_arena_walk(xc);
     }
     /* Add xc to new parent */
     if (xp){
@@ -642,7 +1452,7 @@ xml_insert(cxobj *xp,
 {
     cxobj *xc; /* new child */
 
-    if ((xc = xml_new(tag, NULL, NULL)) == NULL)
+    if ((xc = xml_new1(tag, NULL, NULL, xp->x_arena)) == NULL)
 	goto catch;
     while (xp->x_childvec_len)
 	if (xml_addsub(xc, xml_child_i(xp, 0)) < 0)
@@ -677,7 +1487,7 @@ xml_purge(cxobj *xc)
 		break;
 	/* Remove xc from parent */
 	if (i < xml_child_nr(xp))
-	    if (xml_child_rm(xp, i) < 0)
+	    if (xml_child_rm1(xp, i) < 0)
 		goto done;
     }
     xml_free(xc);	    
@@ -686,19 +1496,13 @@ xml_purge(cxobj *xc)
     return retval; 
 }
 
-/*! Remove child xml node from parent xml node. No free and child is root
- * @param[in]   xp     xml parent node
- * @param[in]   i      Number of xml child node (to remove)
- * @retval      0      OK
- * @retval      -1
- * @note you should not remove xchild in loop (unless yoy keep track of xprev)
- *
- * @see xml_rootchild
- * @see xml_rm     Remove the node itself from parent
+/*! Remove child xml node from parent xml node, internal
+ * As xml_child_rm() but the caller frees the child or keeps it in the tree
+ * of its arena.
  */
-int
-xml_child_rm(cxobj *xp, 
-	     int    i)
+static int
+xml_child_rm1(cxobj *xp, 
+	      int    i)
 {
     int    retval = -1;
     cxobj *xc = NULL;
@@ -707,17 +1511,48 @@ xml_child_rm(cxobj *xp,
 	clicon_err(OE_XML, 0, "Child not found");
 	goto done;
     }
+    if (xc->x_type == CX_BODY)
+	xml_body_cv_reset(xc);
+    xml_key_cv_reset(xp, xc);
+    xml_hash_reset(xp);
     xp->x_childvec[i] = NULL;
     xml_parent_set(xc, NULL);
     xp->x_childvec_len--;
-    /* shift up, note same index i used but ok since we break */
-    for (; i<xp->x_childvec_len; i++)
-	xp->x_childvec[i] = xp->x_childvec[i+1];
+    /* shift up */
+    memmove(&xp->x_childvec[i], &xp->x_childvec[i+1],
+	    (xp->x_childvec_len-i)*sizeof(cxobj*));
+    if (XML_INDEX(xp))
+	xml_index_rm(xp, xc, i);
+    if (xp->x_childvec_len == 0 && XML_CHILD_INLINE(xp)){
+	xp->x_childvec = NULL; /* Value may be set again */
+	xp->x_childvec_max = 0;
+    }
     retval = 0;
  done:
     return retval;
 }
 
+/*! Remove child xml node from parent xml node. No free and child is root
+ * @param[in]   xp     xml parent node
+ * @param[in]   i      Number of xml child node (to remove)
+ * @retval      0      OK
+ * @retval      -1
+ * @note you should not remove xchild in loop (unless yoy keep track of xprev)
+ *
+ * @see xml_rootchild
+ * @see xml_rm     Remove the node itself from parent
+ */
+int
+xml_child_rm(cxobj *xp, 
+	     int    i)
+{
+    cxobj *xc;
+
+    if ((xc = xml_child_i(xp, i)) != NULL)
+	xml_arena_walk(xc); /* Child is kept outside the tree of its arena */
+    return xml_child_rm1(xp, i);
+}
+
 /*! Remove this xml node from parent xml node. No freeing and node is new root
  * @param[in]   xc     xml child node to be removed
  * @retval      0      OK
@@ -787,7 +1622,14 @@ xml_rootchild(cxobj  *xp,
 	clicon_err(OE_XML, 0, "Child not found");
 	goto done;
     }
-    if (xml_child_rm(xp, i) < 0)
+    if (xp->x_arena && xp->x_arena->xa_root == xp &&
+	xc->x_arena == xp->x_arena){
+	/* Child is new root of arena, parent and siblings are freed below */
+	if (xml_child_rm1(xp, i) < 0)
+	    goto done;
+	xp->x_arena->xa_root = xc;
+    }
+    else if (xml_child_rm(xp, i) < 0)
 	goto done;
     if (xml_free(xp) < 0)
 	goto done;
@@ -852,11 +1694,10 @@ char *
 xml_find_value(cxobj *xt, 
 	       char  *name)
 {
-    cxobj *x = NULL;
+    cxobj *x;
     
-    while ((x = xml_child_each(xt, x, -1)) != NULL) 
-	if (strcmp(name, xml_name(x)) == 0)
-	    return xml_value(x);
+    if ((x = xml_find(xt, name)) != NULL)
+	return xml_value(x);
     return NULL;
 }
 
@@ -876,11 +1717,10 @@ char *
 xml_find_body(cxobj *xt, 
 	      char  *name)
 {
-    cxobj *x=NULL;
+    cxobj *x;
 
-    while ((x = xml_child_each(xt, x, -1)) != NULL) 
-	if (strcmp(name, xml_name(x)) == 0)
-	    return xml_body(x);
+    if ((x = xml_find(xt, name)) != NULL)
+	return xml_body(x);
     return NULL;
 }
 
@@ -905,9 +1745,10 @@ xml_find_body_obj(cxobj *xt,
 {
     cxobj *x = NULL;
     char  *bstr;
+    char  *atom = xml_name_interned(name);
 
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-	if (strcmp(name, xml_name(x)))
+	if (!xml_name_eq_atom(x, name, atom))
 	    continue;
 	if ((bstr = xml_body(x)) == NULL)
 	    continue;
@@ -924,26 +1765,40 @@ xml_find_body_obj(cxobj *xt,
 int
 xml_free(cxobj *x)
 {
-    int i;
-    cxobj *xc;
-
-    if (x->x_name)
-	free(x->x_name);
-    if (x->x_value)
-	free(x->x_value);
-    if (x->x_namespace)
-	free(x->x_namespace);
-    if (x->x_cv)
-	cv_free(x->x_cv);
+    int               i;
+    cxobj            *xc;
+    struct xml_arena *xa = x->x_arena;
+
+    /* All nodes of the arena are in this tree and have nothing malloced */
+    if (xa && xa->xa_root == x && xa->xa_ext == 0 && !xa->xa_walk)
+	return xml_arena_free(xa);
+    if (!x->x_name_atom)
+	xml_mem_free(xa, x->x_name);
+    if (!XML_CHILD_INLINE(x))
+	xml_mem_free(xa, x->x_u.xu_value);
     for (i=0; i<x->x_childvec_len; i++){
 	if ((xc = x->x_childvec[i]) != NULL){
 	    xml_free(xc);
 	    x->x_childvec[i] = NULL;
 	}
     }
-    if (x->x_childvec)
-	free(x->x_childvec);
-    free(x);
+    if (!XML_CHILD_INLINE(x))
+	xml_mem_free(xa, x->x_childvec);
+    if (x->x_ext){
+	xml_mem_free(xa, x->x_ext->xe_namespace);
+	xml_mem_free(xa, x->x_ext->xe_hash);
+	xml_cv_set(x, NULL);
+	xml_index_free(x);
+	xml_mem_free(xa, x->x_ext);
+    }
+    if (xa == NULL)
+	free(x);
+    else{
+	if (xa->xa_root == x)
+	    xa->xa_root = NULL;
+	if (--xa->xa_nodes == 0)
+	    xml_arena_free(xa);
+    }
     return 0;
 }
 
@@ -951,58 +1806,89 @@ xml_free(cxobj *x)
  * XML printing functions. Output a parse tree to file, string cligen buf
  *------------------------------------------------------------------------*/
 
-/*! Print an XML tree structure to an output stream
- *
- * Uses clicon_xml2cbuf internally
+/*! Print the name of a node, with namespace prefix if any */
+static int
+xml_name2sink(clicon_sink *cs,
+	      cxobj       *x)
+{
+    char *namespace;
+
+    if ((namespace = xml_namespace(x)) != NULL){
+	if (clicon_sink_puts(cs, namespace) < 0 ||
+	    clicon_sink_putc(cs, ':') < 0)
+	    return -1;
+    }
+    return clicon_sink_puts(cs, xml_name(x));
+}
+
+/*! Print an end tag of an element */
+static int
+xml_endtag2sink(clicon_sink *cs,
+		cxobj       *x)
+{
+    if (clicon_sink_write(cs, "</", 2) < 0 ||
+	xml_name2sink(cs, x) < 0 ||
+	clicon_sink_putc(cs, '>') < 0)
+	return -1;
+    return 0;
+}
+
+/*! Print an XML tree structure to an output sink
  *
- * @param[in]   f           UNIX output stream
- * @param[in]   xn          clicon xml tree
- * @param[in]   level       how many spaces to insert before each line
- * @param[in]   prettyprint insert \n and spaces tomake the xml more readable.
+ * @param[in]     cs          Output sink, eg clicon_sink_msg() for a reply
+ * @param[in]     xn          Clicon xml tree
+ * @param[in]     level       Indentation level
+ * @param[in]     prettyprint insert \n and spaces tomake the xml more readable.
+ * @code
+ *   if ((cs = clicon_sink_fd(s)) == NULL)
+ *      err;
+ *   if (clicon_xml2sink(cs, xn, 0, 0) < 0)
+ *      err;
+ *   if (clicon_sink_close(cs) < 0)
+ *      err;
+ * @endcode
  * @see clicon_xml2cbuf
- * One can use clicon_xml2cbuf to get common code, but using fprintf is
- * much faster than using cbuf and then printing that,...
  */
 int
-clicon_xml2file(FILE  *f, 
-		cxobj *x, 
-		int    level, 
-		int    prettyprint)
+clicon_xml2sink(clicon_sink *cs, 
+		cxobj       *x, 
+		int          level, 
+		int          prettyprint)
 {
     int    retval = -1;
-    char  *name;
-    char  *namespace;
     cxobj *xc;
     int    hasbody;
     int    haselement;
     char  *val;
 
-    name = xml_name(x);
-    namespace = xml_namespace(x);
     switch(xml_type(x)){
     case CX_BODY:
 	if ((val = xml_value(x)) != NULL) /* incomplete tree */
-	    fprintf(f, "%s", xml_value(x));
+	    if (clicon_sink_puts(cs, val) < 0)
+		goto done;
 	break;
     case CX_ATTR:
-	fprintf(f, " ");
-	if (namespace)
-	    fprintf(f, "%s:", namespace);
-	fprintf(f, "%s=\"%s\"", name, xml_value(x));
+	if (clicon_sink_putc(cs, ' ') < 0 ||
+	    xml_name2sink(cs, x) < 0 ||
+	    clicon_sink_write(cs, "=\"", 2) < 0 ||
+	    clicon_sink_puts(cs, xml_value(x)?xml_value(x):"") < 0 ||
+	    clicon_sink_putc(cs, '"') < 0)
+	    goto done;
 	break;
     case CX_ELMNT:
-	fprintf(f, "%*s<", prettyprint?(level*XML_INDENT):0, "");
-	if (namespace)
-	    fprintf(f, "%s:", namespace);
-	fprintf(f, "%s", name);
+	if (prettyprint && clicon_sink_indent(cs, level*XML_INDENT) < 0)
+	    goto done;
+	if (clicon_sink_putc(cs, '<') < 0 ||
+	    xml_name2sink(cs, x) < 0)
+	    goto done;
 	hasbody = 0;
 	haselement = 0;
 	xc = NULL;
 	/* print attributes only */
-	while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+	while ((xc = xml_child_each(x, xc, -1)) != NULL) 
 	    switch (xc->x_type){
 	    case CX_ATTR:
-		if (clicon_xml2file(f, xc, level+1, prettyprint) <0)
+		if (clicon_xml2sink(cs, xc, level+1, prettyprint) < 0)
 		    goto done;
 		break;
 	    case CX_BODY:
@@ -1014,31 +1900,29 @@ clicon_xml2file(FILE  *f,
 	    default:
 		break;
 	    }
+	/* Check for special case <a/> instead of <a></a> */
+	if (hasbody==0 && haselement==0){
+	    if (clicon_sink_write(cs, "/>", 2) < 0)
+		goto done;
 	}
-	/* Check for special case <a/> instead of <a></a>:
-	 * Ie, no CX_BODY or CX_ELMNT child.
-	 */
-	if (hasbody==0 && haselement==0) 
-	    fprintf(f, "/>");
 	else{
-	    fprintf(f, ">");
-	    if (prettyprint && hasbody == 0)
-		    fprintf(f, "\n");
+	    if (clicon_sink_putc(cs, '>') < 0)
+		goto done;
+	    if (prettyprint && hasbody == 0 && clicon_sink_putc(cs, '\n') < 0)
+		goto done;
 	    xc = NULL;
-	    while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+	    while ((xc = xml_child_each(x, xc, -1)) != NULL) 
 		if (xml_type(xc) != CX_ATTR)
-		    if (clicon_xml2file(f, xc, level+1, prettyprint) <0)
+		    if (clicon_xml2sink(cs, xc, level+1, prettyprint) < 0)
 			goto done;
-	    }
-	    if (prettyprint && hasbody==0)
-		fprintf(f, "%*s", level*XML_INDENT, "");
-	    fprintf(f, "</");
-	    if (namespace)
-		fprintf(f, "%s:", namespace);
-	    fprintf(f, "%s>", name);
+	    if (prettyprint && hasbody == 0 &&
+		clicon_sink_indent(cs, level*XML_INDENT) < 0)
+		goto done;
+	    if (xml_endtag2sink(cs, x) < 0)
+		goto done;
 	}
-	if (prettyprint)
-	    fprintf(f, "\n");
+	if (prettyprint && clicon_sink_putc(cs, '\n') < 0)
+	    goto done;
 	break;
     default:
 	break;
@@ -1048,6 +1932,32 @@ clicon_xml2file(FILE  *f,
     return retval;
 }
 
+/*! Print an XML tree structure to an output stream
+ *
+ * @param[in]   f           UNIX output stream
+ * @param[in]   xn          clicon xml tree
+ * @param[in]   level       how many spaces to insert before each line
+ * @param[in]   prettyprint insert \n and spaces tomake the xml more readable.
+ * @see clicon_xml2sink
+ */
+int
+clicon_xml2file(FILE  *f, 
+		cxobj *x, 
+		int    level, 
+		int    prettyprint)
+{
+    int          retval = -1;
+    clicon_sink *cs;
+
+    if ((cs = clicon_sink_file(f)) == NULL)
+	goto done;
+    retval = clicon_xml2sink(cs, x, level, prettyprint);
+    if (clicon_sink_close(cs) < 0)
+	retval = -1;
+ done:
+    return retval;
+}
+
 /*! Print an XML tree structure to an output stream
  *
  * Uses clicon_xml2file internally
@@ -1081,6 +1991,7 @@ xml_print(FILE  *f,
  * cbuf_free(cb);
  * @endcode
  * @see  clicon_xml2file
+ * @see  clicon_xml2sink  to print a large tree without a copy in memory
  */
 int
 clicon_xml2cbuf(cbuf  *cb, 
@@ -1088,79 +1999,310 @@ clicon_xml2cbuf(cbuf  *cb,
 		int    level, 
 		int    prettyprint)
 {
-    int    retval = -1;
-    cxobj *xc;
-    char  *name;
-    int    hasbody;
-    int    haselement;
-    char  *namespace;
+    int          retval = -1;
+    clicon_sink *cs;
+
+    if ((cs = clicon_sink_cbuf(cb)) == NULL)
+	goto done;
+    retval = clicon_xml2sink(cs, x, level, prettyprint);
+    if (clicon_sink_close(cs) < 0)
+	retval = -1;
+ done:
+    return retval;
+}
+
+/*! Check if an element child is part of a view, see clicon_xml2cbuf_view
+ * @param[in]  xc      Child element
+ * @param[in]  y       Yang spec of parent (or NULL)
+ * @param[in]  all     Parent is in a selected subtree
+ * @param[in]  config  Skip state data
+ * @retval     1       Print xc
+ * @retval     0       Skip xc
+ */
+static int
+xml_view_child(cxobj     *xc,
+	       yang_stmt *y,
+	       int        all,
+	       int        config)
+{
+    yang_stmt *yc;
+
+    if ((yc = xml_spec(xc)) != NULL && config && !yang_config(yc))
+	return 0;
+    if (all || xml_flag(xc, XML_FLAG_MARK|XML_FLAG_CHANGE))
+	return 1;
+    /* Keys are printed for all list entries on the path to a selected node */
+    if (y != NULL && y->ys_keyword == Y_LIST &&
+	yang_key_match((yang_node*)y, xml_name(xc)) == 1)
+	return 1;
+    return 0;
+}
+
+/*! Get next leaf with a default value that is not set in an element
+ * @param[in]     x       XML element
+ * @param[in]     y       Yang spec of x (or NULL)
+ * @param[in,out] i       Index of next yang child of y to check
+ * @param[in]     config  Skip state data
+ * @retval        yc      Yang leaf, not set in x
+ * @retval        NULL    No more defaults
+ * @see xml_default  which adds default values to an xml tree
+ */
+static yang_stmt *
+xml_view_default(cxobj     *x,
+		 yang_stmt *y,
+		 int       *i,
+		 int        config)
+{
+    yang_stmt *yc;
 
-    name = xml_name(x);
+    if (y == NULL || (y->ys_keyword != Y_CONTAINER && y->ys_keyword != Y_LIST))
+	return NULL;
+    while (*i < y->ys_len){
+	yc = y->ys_stmt[(*i)++];
+	if (yc->ys_keyword != Y_LEAF || cv_flag(yc->ys_cv, V_UNSET))
+	    continue;
+	if (config && !yang_config(yc))
+	    continue;
+	if (xml_find(x, yc->ys_argument) == NULL)
+	    return yc;
+    }
+    return NULL;
+}
+
+/*! Print a default value leaf, see clicon_xml2sink_view */
+static int
+xml_view_default2sink(clicon_sink *cs,
+		      yang_stmt   *y,
+		      int          level,
+		      int          prettyprint)
+{
+    int   retval = -1;
+    char *str;
+
+    if ((str = cv2str_dup(y->ys_cv)) == NULL){
+	clicon_err(OE_UNIX, errno, "cv2str_dup");
+	return -1;
+    }
+    if (prettyprint && clicon_sink_indent(cs, level*XML_INDENT) < 0)
+	goto done;
+    if (clicon_sink_printf(cs, "<%s>%s</%s>", 
+			   y->ys_argument, str, y->ys_argument) < 0)
+	goto done;
+    if (prettyprint && clicon_sink_putc(cs, '\n') < 0)
+	goto done;
+    retval = 0;
+ done:
+    free(str);
+    return retval;
+}
+
+/*! Print an element of a view, see clicon_xml2sink_view */
+static int
+xml2sink_view1(clicon_sink *cs, 
+	       cxobj       *x,
+	       char        *name,
+	       int          all,
+	       int          config,
+	       int          level, 
+	       int          prettyprint)
+{
+    int        retval = -1;
+    cxobj     *xc;
+    yang_stmt *y;
+    yang_stmt *yc;
+    yang_stmt *yd;
+    int        i = 0;
+    int        hasbody;
+    int        haselement;
+    char      *namespace;
+
+    y = xml_spec(x);
+    if (xml_flag(x, XML_FLAG_MARK))
+	all = 1;
     namespace = xml_namespace(x);
-    switch(xml_type(x)){
-    case CX_BODY:
-	cprintf(cb, "%s", xml_value(x));
-	break;
-    case CX_ATTR:
-	cprintf(cb, " ");
-	if (namespace)
-	    cprintf(cb, "%s:", namespace);
-	cprintf(cb, "%s=\"%s\"", name, xml_value(x));
-	break;
-    case CX_ELMNT:
-	cprintf(cb, "%*s<", prettyprint?(level*XML_INDENT):0, "");
-	if (namespace)
-	    cprintf(cb, "%s:", namespace);
-	cprintf(cb, "%s", name);
-	hasbody = 0;
-	haselement = 0;
+    if (prettyprint && clicon_sink_indent(cs, level*XML_INDENT) < 0)
+	goto done;
+    if (clicon_sink_putc(cs, '<') < 0)
+	goto done;
+    if (namespace && (clicon_sink_puts(cs, namespace) < 0 ||
+		      clicon_sink_putc(cs, ':') < 0))
+	goto done;
+    if (clicon_sink_puts(cs, name) < 0)
+	goto done;
+    hasbody = 0;
+    haselement = 0;
+    xc = NULL;
+    /* print attributes only */
+    while ((xc = xml_child_each(x, xc, -1)) != NULL) 
+	switch (xc->x_type){
+	case CX_ATTR:
+	    if (clicon_xml2sink(cs, xc, level+1, prettyprint) < 0)
+		goto done;
+	    break;
+	case CX_BODY:
+	    hasbody=1;
+	    break;
+	case CX_ELMNT:
+	    if (!haselement && xml_view_child(xc, y, all, config))
+		haselement=1;
+	    break;
+	default:
+	    break;
+	}
+    if ((yd = xml_view_default(x, y, &i, config)) != NULL)
+	haselement = 1;
+    /* Check for special case <a/> instead of <a></a> */
+    if (hasbody==0 && haselement==0){
+	if (clicon_sink_write(cs, "/>", 2) < 0)
+	    goto done;
+    }
+    else{
+	if (clicon_sink_putc(cs, '>') < 0)
+	    goto done;
+	if (prettyprint && hasbody == 0 && clicon_sink_putc(cs, '\n') < 0)
+	    goto done;
 	xc = NULL;
-	/* print attributes only */
 	while ((xc = xml_child_each(x, xc, -1)) != NULL) 
 	    switch (xc->x_type){
-	    case CX_ATTR:
-		if (clicon_xml2cbuf(cb, xc, level+1, prettyprint) < 0)
-		    goto done;
-		break;
 	    case CX_BODY:
-		hasbody=1;
+		if (clicon_xml2sink(cs, xc, level+1, prettyprint) < 0)
+		    goto done;
 		break;
 	    case CX_ELMNT:
-		haselement=1;
+		if (!xml_view_child(xc, y, all, config))
+		    break;
+		/* Default values are printed in yang order */
+		while (yd != NULL && (yc = xml_spec(xc)) != NULL &&
+		       yang_order(yd) < yang_order(yc)){
+		    if (xml_view_default2sink(cs, yd, level+1, prettyprint) < 0)
+			goto done;
+		    yd = xml_view_default(x, y, &i, config);
+		}
+		if (xml2sink_view1(cs, xc, xml_name(xc), all, config,
+				   level+1, prettyprint) < 0)
+		    goto done;
 		break;
 	    default:
 		break;
 	    }
-	
-	/* Check for special case <a/> instead of <a></a> */
-	if (hasbody==0 && haselement==0) 
-	    cprintf(cb, "/>");
-	else{
-	    cprintf(cb, ">");
-	    if (prettyprint && hasbody == 0)
-		cprintf(cb, "\n");
-	    xc = NULL;
-	    while ((xc = xml_child_each(x, xc, -1)) != NULL) 
-		if (xml_type(xc) != CX_ATTR)
-		    if (clicon_xml2cbuf(cb, xc, level+1, prettyprint) < 0)
-			goto done;
-	    if (prettyprint && hasbody == 0)
-		cprintf(cb, "%*s", level*XML_INDENT, "");
-	    cprintf(cb, "</");
-	    if (namespace)
-		cprintf(cb, "%s:", namespace);
-	    cprintf(cb, "%s>", name);
-	}
-	if (prettyprint)
-	    cprintf(cb, "\n");
-	break;
-    default:
-	break;
-    }/* switch */
+	for (; yd != NULL; yd = xml_view_default(x, y, &i, config))
+	    if (xml_view_default2sink(cs, yd, level+1, prettyprint) < 0)
+		goto done;
+	if (prettyprint && hasbody == 0 &&
+	    clicon_sink_indent(cs, level*XML_INDENT) < 0)
+	    goto done;
+	if (clicon_sink_write(cs, "</", 2) < 0)
+	    goto done;
+	if (namespace && (clicon_sink_puts(cs, namespace) < 0 ||
+			  clicon_sink_putc(cs, ':') < 0))
+	    goto done;
+	if (clicon_sink_puts(cs, name) < 0 ||
+	    clicon_sink_putc(cs, '>') < 0)
+	    goto done;
+    }
+    if (prettyprint && clicon_sink_putc(cs, '\n') < 0)
+	goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Print selected parts of an XML tree to an output sink without copying it
+ *
+ * Prints the same as clicon_xml2sink() would for the tree that xmldb_get() 
+ * returns, but without copying or modifying the tree, eg a snapshot from
+ * xmldb_snapshot():
+ * - Only the nodes in xvec and their ancestors (with list keys) are printed.
+ * - State data is skipped if config is set.
+ * - Leafs with default values are printed if not set.
+ * @param[in]     cs          Output sink, eg clicon_sink_msg() for a reply
+ * @param[in]     xt          Top of XML tree
+ * @param[in]     name        Name to print top element with, or NULL
+ * @param[in]     xvec        Nodes in xt to print, eg from xpath_vec()
+ * @param[in]     xlen        Length of xvec
+ * @param[in]     config      If set, skip state data
+ * @param[in]     prettyprint insert \n and spaces tomake the xml more readable.
+ * @code
+ *   if (xmldb_snapshot(h, "running", &xt) < 0)
+ *      err;
+ *   if (xpath_vec(xt, "/", &xvec, &xlen) < 0)
+ *      err;
+ *   if (clicon_xml2sink_view(cs, xt, "data", xvec, xlen, 1, 0) < 0)
+ *      err;
+ *   free(xvec);
+ *   xmldb_release(h, "running", xt);
+ * @endcode
+ * @note The children of the tree are assumed to be in yang order, ie sorted
+ * @note XML_FLAG_MARK and XML_FLAG_CHANGE are used while printing
+ * @see clicon_xml2cbuf_view
+ */
+int
+clicon_xml2sink_view(clicon_sink *cs, 
+		     cxobj       *xt,
+		     char        *name,
+		     cxobj      **xvec,
+		     size_t       xlen,
+		     int          config,
+		     int          prettyprint)
+{
+    int    retval = -1;
+    cxobj *x;
+    int    i;
+
+    /* Mark the selected nodes and their ancestors */
+    for (i=0; i<xlen; i++){
+	xml_flag_set(xvec[i], XML_FLAG_MARK);
+	for (x = xml_parent(xvec[i]); 
+	     x != NULL && !xml_flag(x, XML_FLAG_CHANGE);
+	     x = xml_parent(x))
+	    xml_flag_set(x, XML_FLAG_CHANGE);
+    }
+    if (xml2sink_view1(cs, xt, name?name:xml_name(xt), 0, config, 
+		       0, prettyprint) < 0)
+	goto done;
     retval = 0;
  done:
+    for (i=0; i<xlen; i++){
+	xml_flag_reset(xvec[i], XML_FLAG_MARK);
+	for (x = xml_parent(xvec[i]); 
+	     x != NULL && xml_flag(x, XML_FLAG_CHANGE);
+	     x = xml_parent(x))
+	    xml_flag_reset(x, XML_FLAG_CHANGE);
+    }
     return retval;
 }
+
+/*! Print selected parts of an XML tree to a cligen buffer without copying it
+ * @param[in,out] cb          Cligen buffer to write to
+ * @param[in]     xt          Top of XML tree
+ * @param[in]     name        Name to print top element with, or NULL
+ * @param[in]     xvec        Nodes in xt to print, eg from xpath_vec()
+ * @param[in]     xlen        Length of xvec
+ * @param[in]     config      If set, skip state data
+ * @param[in]     prettyprint insert \n and spaces tomake the xml more readable.
+ * @see clicon_xml2sink_view
+ */
+int
+clicon_xml2cbuf_view(cbuf   *cb, 
+		     cxobj  *xt,
+		     char   *name,
+		     cxobj **xvec,
+		     size_t  xlen,
+		     int     config,
+		     int     prettyprint)
+{
+    int          retval = -1;
+    clicon_sink *cs;
+
+    if ((cs = clicon_sink_cbuf(cb)) == NULL)
+	goto done;
+    retval = clicon_xml2sink_view(cs, xt, name, xvec, xlen, config, prettyprint);
+    if (clicon_sink_close(cs) < 0)
+	retval = -1;
+ done:
+    return retval;
+}
+
 /*! Print actual xml tree datastructures (not xml), mainly for debugging
  * @param[in,out] cb          Cligen buffer to write to
  * @param[in]     xn          Clicon xml tree
@@ -1203,20 +2345,23 @@ xmltree2cbuf(cbuf  *cb,
 /*--------------------------------------------------------------------
  * XML parsing functions. Create XML parse tree from string and file.
  *--------------------------------------------------------------------*/
-/*! Common internal xml parsing function string to parse-tree
+/*! Common internal xml parsing function buffer to parse-tree
  *
- * Given a string containing XML, parse into existing XML tree and return
- * @param[in]     str   Pointer to string containing XML definition. 
+ * Given a buffer containing XML, parse into existing XML tree and return.
+ * The buffer is handed to the scanner as is, without copying.
+ * @param[in]     buf   Buffer containing XML definition followed by two NUL 
+ *                      bytes. The scanner may modify it while parsing.
+ * @param[in]     len   Length of XML definition in buf, excluding the NULs
  * @param[in]     yspec Yang specification or NULL
  * @param[in,out] xtop  Top of XML parse tree. Assume created. Holds new tree.
  * @see xml_parse_file
- * @see xml_parse_string
- * @see xml_parse_va
+ * @see clicon_file_map
  */
 static int 
-_xml_parse(const char *str, 
-	  yang_spec   *yspec,
-	  cxobj       *xt)
+_xml_parse_buf(char        *buf, 
+	       size_t       len,
+	       yang_spec   *yspec,
+	       cxobj       *xt)
 {
     int                       retval = -1;
     struct xml_parse_yacc_arg ya = {0,};
@@ -1225,10 +2370,8 @@ _xml_parse(const char *str,
 	clicon_err(OE_XML, errno, "Unexpected NULL XML");
 	return -1;	
     }
-    if ((ya.ya_parse_string = strdup(str)) == NULL){
-	clicon_err(OE_XML, errno, "strdup");
-	return -1;
-    }
+    ya.ya_parse_string = buf;
+    ya.ya_parse_len = len + 2;
     ya.ya_xparent = xt;
     ya.ya_skipspace = 1;  /* remove all non-terminal bodies (strip pretty-print) */
     ya.ya_yspec = yspec;
@@ -1246,22 +2389,38 @@ _xml_parse(const char *str,
     retval = 0;
   done:
     clixon_xml_parsel_exit(&ya);
-    if(ya.ya_parse_string != NULL)
-	free(ya.ya_parse_string);
     return retval; 
 }
 
-/*! FSM to detect substring
+/*! Common internal xml parsing function string to parse-tree
+ *
+ * Given a string containing XML, parse into existing XML tree and return
+ * @param[in]     str   Pointer to string containing XML definition. 
+ * @param[in]     yspec Yang specification or NULL
+ * @param[in,out] xtop  Top of XML parse tree. Assume created. Holds new tree.
+ * @see xml_parse_file
+ * @see xml_parse_string
+ * @see xml_parse_va
  */
-static inline int
-FSM(char *tag, 
-    char  ch, 
-    int   state)
+static int 
+_xml_parse(const char *str, 
+	  yang_spec   *yspec,
+	  cxobj       *xt)
 {
-    if (tag[state] == ch)
-	return state+1;
-    else
-	return 0;
+    int     retval = -1;
+    size_t  len = strlen(str);
+    char   *buf;
+
+    if ((buf = malloc(len + 2)) == NULL){
+	clicon_err(OE_XML, errno, "malloc");
+	return -1;
+    }
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+    buf[len+1] = '\0';
+    retval = _xml_parse_buf(buf, len, yspec, xt);
+    free(buf);
+    return retval;
 }
 
 /*! Read an XML definition from file and parse it into a parse-tree. 
@@ -1280,8 +2439,12 @@ FSM(char *tag,
  * @endcode
  * @see xml_parse_string
  * @see xml_parse_va
+ * @see clicon_file_map  Regular files are memory mapped, streams read in blocks
  * @note, If xt empty, a top-level symbol will be added so that <tree../> will be:  <top><tree.../></tree></top>
+ *        The top is created with an arena, see xml_new_arena(). For a tree 
+ *        that is kept and edited, create the top with xml_new() instead.
  * @note May block on file I/O
+ * @note With endtag, nothing after it is consumed from a socket or pipe
  */
 int 
 xml_parse_file(int        fd, 
@@ -1289,66 +2452,27 @@ xml_parse_file(int        fd,
 	       yang_spec *yspec,
 	       cxobj    **xt)
 {
-    int   retval = -1;
-    int   ret;
-    int   len = 0;
-    char  ch;
-    char *xmlbuf = NULL;
-    char *ptr;
-    int   xmlbuflen = BUFLEN; /* start size */
-    int   endtaglen = 0;
-    int   state = 0;
-    int   oldxmlbuflen;
-
-    if (endtag != NULL)
-	endtaglen = strlen(endtag);
-    if ((xmlbuf = malloc(xmlbuflen)) == NULL){
-	clicon_err(OE_XML, errno, "%s: malloc", __FUNCTION__);
+    int    retval = -1;
+    char  *buf = NULL;
+    size_t len = 0;
+    size_t maplen = 0;
+    cxobj *xtop = NULL;
+
+    if (clicon_file_map(fd, endtag, &buf, &len, &maplen) < 0)
+	goto done;
+    if (*xt == NULL)
+	if ((*xt = xtop = xml_new_arena(XML_TOP_SYMBOL, NULL)) == NULL)
+	    goto done;
+    if (_xml_parse_buf(buf, len, yspec, *xt) < 0)
 	goto done;
-    }
-    memset(xmlbuf, 0, xmlbuflen);
-    ptr = xmlbuf;
-    while (1){
-	if ((ret = read(fd, &ch, 1)) < 0){
-	    clicon_err(OE_XML, errno, "%s: read: [pid:%d]\n", 
-		    __FUNCTION__,
-		    (int)getpid());
-	    break;
-	}
-	if (ret != 0){
-	    if (endtag)
-		state = FSM(endtag, ch, state);
-	    xmlbuf[len++] = ch;
-	}
-	if (ret == 0 ||
-	    (endtag && (state == endtaglen))){
-	    state = 0;
-	    if (*xt == NULL)
-		if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, NULL)) == NULL)
-		    goto done;
-	    if (_xml_parse(ptr, yspec, *xt) < 0)
-		goto done;
-	    break;
-	}
-	if (len>=xmlbuflen-1){ /* Space: one for the null character */
-	    oldxmlbuflen = xmlbuflen;
-	    xmlbuflen *= 2;
-	    if ((xmlbuf = realloc(xmlbuf, xmlbuflen)) == NULL){
-		clicon_err(OE_XML, errno, "%s: realloc", __FUNCTION__);
-		goto done;
-	    }
-	    memset(xmlbuf+oldxmlbuflen, 0, xmlbuflen-oldxmlbuflen);
-	    ptr = xmlbuf;
-	}
-    } /* while */
     retval = 0;
  done:
-    if (retval < 0 && *xt){
-	free(*xt);
+    if (retval < 0 && xtop){
+	xml_free(xtop);
 	*xt = NULL;
     }
-    if (xmlbuf)
-	free(xmlbuf);
+    if (buf)
+	clicon_file_unmap(buf, maplen);
     return retval;
 }
 
@@ -1369,7 +2493,8 @@ xml_parse_file(int        fd,
  * @see xml_parse_file
  * @see xml_parse_va
  * @note You need to free the xml parse tree after use, using xml_free()
- * @note If empty on entry, a new TOP xml will be created named "top"
+ * @note If empty on entry, a new TOP xml will be created named "top", with an
+ *       arena, see xml_new_arena()
  */
 int 
 xml_parse_string(const char *str, 
@@ -1377,7 +2502,7 @@ xml_parse_string(const char *str,
 		 cxobj     **xtop)
 {
     if (*xtop == NULL)
-	if ((*xtop = xml_new(XML_TOP_SYMBOL, NULL, NULL)) == NULL)
+	if ((*xtop = xml_new_arena(XML_TOP_SYMBOL, NULL)) == NULL)
 	    return -1;
     return _xml_parse(str, yspec, *xtop);
 }
@@ -1414,20 +2539,20 @@ xml_parse_va(cxobj     **xtop,
     int     len;
 
     va_start(args, format);
-    len = vsnprintf(NULL, 0, format, args) + 1;
+    len = vsnprintf(NULL, 0, format, args);
     va_end(args);
-    if ((str = malloc(len)) == NULL){
+    if ((str = malloc(len + 2)) == NULL){ /* Two NULs for in-place scanning */
 	clicon_err(OE_UNIX, errno, "malloc");
 	goto done;
     }
-    memset(str, 0, len);
+    memset(str, 0, len + 2);
     va_start(args, format);
-    len = vsnprintf(str, len, format, args) + 1;
+    vsnprintf(str, len + 1, format, args);
     va_end(args);
     if (*xtop == NULL)
-	if ((*xtop = xml_new(XML_TOP_SYMBOL, NULL, NULL)) == NULL)
+	if ((*xtop = xml_new_arena(XML_TOP_SYMBOL, NULL)) == NULL)
 	    goto done;
-    if (_xml_parse(str, yspec, *xtop) < 0)
+    if (_xml_parse_buf(str, len, yspec, *xtop) < 0)
 	goto done;
     retval = 0;
  done:
@@ -1444,12 +2569,12 @@ xml_copy_one(cxobj *x0,
 {
     cg_var *cv1;
 
-    xml_type_set(x1, xml_type(x0));
+    xml_type_set(x1, xml_type(x0)); /* Also drops hash of x1 */
     if (xml_value(x0)){ /* malloced string */
-	if ((x1->x_value = strdup(x0->x_value)) == NULL){
-	    clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
+	if (xml_child_uninline(x1) < 0)
+	    return -1;
+	if ((x1->x_u.xu_value = xml_mem_strdup(x1->x_arena, xml_value(x0))) == NULL)
 	    return -1;
-	}
     }
     if (xml_name(x0)) /* malloced string */
 	if ((xml_name_set(x1, xml_name(x0))) < 0)
@@ -1465,10 +2590,13 @@ xml_copy_one(cxobj *x0,
     return 0;
 }
 
+static int xml_hash_copy(cxobj *x0, cxobj *x1);
+
 /*! Copy xml tree x0 to other existing tree x1
  *
  * x1 should be a created placeholder. If x1 is non-empty,
  * the copied tree is appended to the existing tree.
+ * A computed hash of x0 is also valid for the copy, see xml_hash().
  * @code
  *   x1 = xml_new("new", xparent, NULL);
  *   if (xml_copy(x0, x1) < 0)
@@ -1482,7 +2610,11 @@ xml_copy(cxobj *x0,
     int    retval = -1;
     cxobj *x;
     cxobj *xcopy;
+    int    hashed;
 
+    /* Namespace is not copied, then neither is the hash */
+    hashed = (x0->x_flags & XML_FLAG_HASHED) && x1->x_childvec_len == 0 &&
+	xml_namespace(x0) == NULL && xml_namespace(x1) == NULL;
     if (xml_copy_one(x0, x1) <0)
 	goto done;
     x = NULL;
@@ -1491,7 +2623,11 @@ xml_copy(cxobj *x0,
 	    goto done;
 	if (xml_copy(x, xcopy) < 0) /* recursion */
 	    goto done;
+	if (!(xcopy->x_flags & XML_FLAG_HASHED))
+	    hashed = 0;
     }
+    if (hashed && xml_hash_copy(x0, x1) < 0)
+	goto done;
     retval = 0;
   done:
     return retval;
@@ -1504,20 +2640,218 @@ xml_copy(cxobj *x0,
  *   x1 = xml_dup(x0);
  * @endcode
  * Note, returned tree should be freed as: xml_free(x1)
+ * If x0 is allocated in an arena, the copy gets an arena of its own
+ * @see xml_new_arena
  */
 cxobj *
 xml_dup(cxobj *x0)
 {
     cxobj *x1;
 
-    if ((x1 = xml_new("new", NULL, xml_spec(x0))) == NULL)
+    if (x0->x_arena)
+	x1 = xml_new_arena("new", xml_spec(x0));
+    else
+	x1 = xml_new("new", NULL, xml_spec(x0));
+    if (x1 == NULL)
 	return NULL;
     if (xml_copy(x0, x1) < 0)
 	return NULL;
     return x1;
 }
 
+/*! Buffer of hashed content, used as a stack by xml_hash_put() */
+struct xml_hash_buf{
+    unsigned char *hb_buf;
+    size_t         hb_len;
+    size_t         hb_max;
+};
+
+/*! Append bytes to hash buffer */
+static int
+xml_hash_append(struct xml_hash_buf *hb,
+		const void          *p,
+		size_t               len)
+{
+    unsigned char *buf;
+    size_t         max;
+
+    if (hb->hb_len + len > hb->hb_max){
+	max = hb->hb_max ? hb->hb_max : 1024;
+	while (max < hb->hb_len + len)
+	    max *= 2;
+	if ((buf = realloc(hb->hb_buf, max)) == NULL){
+	    clicon_err(OE_XML, errno, "%s: realloc", __FUNCTION__);
+	    return -1;
+	}
+	hb->hb_buf = buf;
+	hb->hb_max = max;
+    }
+    memcpy(hb->hb_buf + hb->hb_len, p, len);
+    hb->hb_len += len;
+    return 0;
+}
+
+/*! Append a string, or NULL, with its length to hash buffer */
+static int
+xml_hash_append_str(struct xml_hash_buf *hb,
+		    char                *str)
+{
+    uint32_t len = str ? strlen(str) : 0xffffffff;
+    unsigned char lenb[4];
+
+    lenb[0] = len >> 24; lenb[1] = len >> 16; lenb[2] = len >> 8; lenb[3] = len;
+    if (xml_hash_append(hb, lenb, 4) < 0)
+	return -1;
+    return str ? xml_hash_append(hb, str, len) : 0;
+}
+
+/*! Node has element children, and then its hash is cached */
+static int
+xml_hash_interior(cxobj *x)
+{
+    int i;
+
+    for (i=0; i<x->x_childvec_len; i++)
+	if (x->x_childvec[i]->x_type == CX_ELMNT)
+	    return 1;
+    return 0;
+}
+
+static int xml_hash_put(cxobj *x, struct xml_hash_buf *hb);
+
+/*! Append type, name, namespace, value and children of a node to hash buffer
+ * The children end with a ')' so that content of siblings is not confused
+ * with content of children.
+ */
+static int
+xml_hash_content(cxobj               *x,
+		 struct xml_hash_buf *hb)
+{
+    unsigned char type = x->x_type;
+    int           i;
+
+    if (xml_hash_append(hb, &type, 1) < 0 ||
+	xml_hash_append_str(hb, x->x_name) < 0 ||
+	xml_hash_append_str(hb, xml_namespace(x)) < 0 ||
+	xml_hash_append_str(hb, xml_value(x)) < 0)
+	return -1;
+    for (i=0; i<x->x_childvec_len; i++)
+	if (xml_hash_put(x->x_childvec[i], hb) < 0)
+	    return -1;
+    return xml_hash_append(hb, ")", 1);
+}
+
+/*! Append a node to the hash buffer of its parent
+ * A node with element children is represented by its digest, which is
+ * computed and cached if not valid, using the buffer after the content of
+ * the parent. Leafs, bodies and attributes are represented by their content.
+ */
+static int
+xml_hash_put(cxobj               *x,
+	     struct xml_hash_buf *hb)
+{
+    struct xml_ext *xe;
+    size_t          start = hb->hb_len;
+
+    if (!xml_hash_interior(x)){
+	if (xml_hash_content(x, hb) < 0)
+	    return -1;
+	x->x_flags |= XML_FLAG_HASHED;
+	return 0;
+    }
+    if (!(x->x_flags & XML_FLAG_HASHED)){
+	if ((xe = xml_ext_get(x)) == NULL)
+	    return -1;
+	if (xe->xe_hash == NULL &&
+	    (xe->xe_hash = xml_mem_alloc(x->x_arena, CLICON_SHA1_LEN)) == NULL)
+	    return -1;
+	if (xml_hash_content(x, hb) < 0)
+	    return -1;
+	if (clicon_sha1(hb->hb_buf + start, hb->hb_len - start, xe->xe_hash) < 0)
+	    return -1;
+	hb->hb_len = start;
+	x->x_flags |= XML_FLAG_HASHED;
+    }
+    if (xml_hash_append(hb, "#", 1) < 0 ||
+	xml_hash_append(hb, x->x_ext->xe_hash, CLICON_SHA1_LEN) < 0)
+	return -1;
+    return 0;
+}
+
+/*! Copy valid hash of x0 to its copy x1 */
+static int
+xml_hash_copy(cxobj *x0,
+	      cxobj *x1)
+{
+    struct xml_ext *xe;
+
+    if (xml_hash_interior(x0)){
+	if ((xe = xml_ext_get(x1)) == NULL)
+	    return -1;
+	if (xe->xe_hash == NULL &&
+	    (xe->xe_hash = xml_mem_alloc(x1->x_arena, CLICON_SHA1_LEN)) == NULL)
+	    return -1;
+	memcpy(xe->xe_hash, x0->x_ext->xe_hash, CLICON_SHA1_LEN);
+    }
+    x1->x_flags |= XML_FLAG_HASHED;
+    return 0;
+}
+
+/*! Compute hash of the content of an xml tree
+ * The hash covers type, name, namespace and value of the node and of all its
+ * descendants, in order. It is cached in the nodes that have element children
+ * (a Merkle tree): a modification invalidates the hash of the modified node
+ * and its ancestors only, so a new hash of a mostly unchanged tree is computed
+ * in time proportional to the change. The hash is also valid for a copy
+ * made with xml_copy().
+ * @param[in]  x       XML tree
+ * @param[out] digest  XML_HASH_LEN bytes, or NULL to only compute the hash
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xml_hash_eq    Compare the hash of two trees
+ */
+int
+xml_hash(cxobj         *x,
+	 unsigned char *digest)
+{
+    int                 retval = -1;
+    struct xml_hash_buf hb = {NULL, 0, 0};
+
+    if (xml_hash_put(x, &hb) < 0)
+	goto done;
+    if (digest){
+	if (xml_hash_interior(x))
+	    memcpy(digest, x->x_ext->xe_hash, XML_HASH_LEN);
+	else if (clicon_sha1(hb.hb_buf, hb.hb_len, digest) < 0)
+	    goto done;
+    }
+    retval = 0;
+ done:
+    if (hb.hb_buf)
+	free(hb.hb_buf);
+    return retval;
+}
+
+/*! Check if two xml trees are equal by their cached hash
+ * Does not compute any hash, see xml_hash().
+ * @param[in]  x1    XML tree
+ * @param[in]  x2    XML tree
+ * @retval     1     Trees have valid and equal hashes, their content is equal
+ * @retval     0     Trees differ, or one has no valid cached hash
+ */
+int
+xml_hash_eq(cxobj *x1,
+	    cxobj *x2)
+{
+    if (!(x1->x_flags & XML_FLAG_HASHED) || !(x2->x_flags & XML_FLAG_HASHED))
+	return 0;
+    if (!xml_hash_interior(x1) || !xml_hash_interior(x2))
+	return 0;
+    return memcmp(x1->x_ext->xe_hash, x2->x_ext->xe_hash, CLICON_SHA1_LEN) == 0;
+}
+
 /*! Copy XML vector from vec0 to vec1
+ * The copy is allocated so that it can be appended to with cxvec_append()
  * @param[in]  vec0    Source XML tree vector
  * @param[in]  len0    Length of source XML tree vector
  * @param[out] vec1    Destination XML tree vector
@@ -1529,11 +2863,16 @@ cxvec_dup(cxobj  **vec0,
 	  cxobj ***vec1, 
 	  size_t  *len1)
 {
-    int retval = -1;
+    int    retval = -1;
+    size_t size = 1;
 
+    while (size < len0)
+	size *= 2;
     *len1 = len0;
-    if ((*vec1 = calloc(len0, sizeof(cxobj*))) == NULL)
+    if ((*vec1 = calloc(size, sizeof(cxobj*))) == NULL){
+	clicon_err(OE_UNIX, errno, "calloc");
 	goto done;
+    }
     memcpy(*vec1, vec0, len0*sizeof(cxobj*));
     retval = 0;
  done:
@@ -1541,6 +2880,11 @@ cxvec_dup(cxobj  **vec0,
 }
 
 /*! Append a new xml tree to an existing xml vector
+ * The vector is allocated in powers of two: it is doubled when its length 
+ * reaches a power of two, so appending n trees makes O(log n) reallocs.
+ * Therefore the vector must be NULL, or created by cxvec_append() or 
+ * cxvec_dup(), or be allocated with a length that is a power of two (eg a
+ * single element). Its length may be decreased, and it is freed with free().
  * @param[in]      x      XML tree (append this to vector)
  * @param[in,out]  vec    XML tree vector
  * @param[in,out]  len    Length of XML tree vector
@@ -1550,11 +2894,16 @@ cxvec_append(cxobj   *x,
 	     cxobj ***vec, 
 	     size_t  *len)
 {
-    int retval = -1;
+    int     retval = -1;
+    size_t  n = *len;
+    cxobj **v;
 
-    if ((*vec = realloc(*vec, sizeof(cxobj *) * (*len+1))) == NULL){
-	clicon_err(OE_XML, errno, "%s: realloc", __FUNCTION__);
-	goto done;
+    if ((n & (n-1)) == 0){ /* 0, 1, 2, 4, 8,.. ie vector is full */
+	if ((v = realloc(*vec, sizeof(cxobj *) * (n?2*n:1))) == NULL){
+	    clicon_err(OE_XML, errno, "%s: realloc", __FUNCTION__);
+	    goto done;
+	}
+	*vec = v;
     }
     (*vec)[(*len)++] = x;
     retval = 0;
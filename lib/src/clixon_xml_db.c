@@ -685,3 +685,142 @@ xmldb_create(clicon_handle h,
  done:
     return retval;
 }
+
+/*! Get the nodes of a database modified since it was copied from a base database
+ *
+ * A datastore may keep track of which parts of a database have been modified
+ * since it was copied from another, eg candidate from running. This makes it
+ * possible to compute the difference between them without comparing the 
+ * complete trees, see xml_diff_dirty().
+ * @param[in]  h       CLICON handle
+ * @param[in]  db      Database, eg candidate
+ * @param[in]  base    Database that db was copied from, eg running
+ * @param[out] xdirty  Tree of modified nodes (see xml_diff_dirty), or NULL if 
+ *                     unknown. Free with xml_free()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @code
+ *   cxobj *xd = NULL;
+ *   if (xmldb_dirty(h, "candidate", "running", &xd) < 0)
+ *      err;
+ *   if (xd == NULL)
+ *      full diff;
+ *   else
+ *      xml_free(xd);
+ * @endcode
+ * @note xdirty is NULL if the datastore plugin does not track modifications, 
+ * or if db or base has been modified in other ways (eg re-read from file).
+ */
+int 
+xmldb_dirty(clicon_handle h, 
+	    const char   *db,
+	    const char   *base,
+	    cxobj       **xdirty)
+{
+    int               retval = -1;
+    xmldb_handle      xh;
+    struct xmldb_api *xa;
+
+    *xdirty = NULL;
+    if ((xa = clicon_xmldb_api_get(h)) == NULL){
+	clicon_err(OE_DB, 0, "No xmldb plugin");
+	goto done;
+    }
+    if (xa->xa_dirty_fn == NULL){ /* Optional: not tracked by plugin */
+	retval = 0;
+	goto done;
+    }
+    if ((xh = clicon_xmldb_handle_get(h)) == NULL){
+	clicon_err(OE_DB, 0, "Not connected to datastore plugin");
+	goto done;
+    }
+    retval = xa->xa_dirty_fn(xh, db, base, xdirty);
+ done:
+    return retval;
+}
+
+/*! Get a read-only snapshot of a database without copying it
+ *
+ * The snapshot is the complete database tree as stored, ie default values are
+ * not added and state data is not removed as in xmldb_get(). Use 
+ * clicon_xml2cbuf_view() to print it as xmldb_get() would have returned it.
+ * The snapshot is not affected by later modifications of the database: the
+ * datastore keeps the tree until xmldb_release() is called. Several snapshots
+ * of the same tree may be held.
+ * @param[in]  h     CLICON handle
+ * @param[in]  db    Database, eg running
+ * @param[out] xt    Snapshot tree: <config>...</config>. Do not modify or free,
+ *                   but release with xmldb_release()
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @code
+ *   cxobj *xt;
+ *   if (xmldb_snapshot(h, "running", &xt) < 0)
+ *      err;
+ *   ...
+ *   xmldb_release(h, "running", xt);
+ * @endcode
+ * @note Flags of the snapshot tree may be used temporarily, eg to mark xpath
+ * results, but must be reset before the snapshot is released.
+ * @see xmldb_get  which returns a modifiable copy
+ */
+int 
+xmldb_snapshot(clicon_handle h, 
+	       const char   *db,
+	       cxobj       **xt)
+{
+    int               retval = -1;
+    xmldb_handle      xh;
+    struct xmldb_api *xa;
+
+    if ((xa = clicon_xmldb_api_get(h)) == NULL){
+	clicon_err(OE_DB, 0, "No xmldb plugin");
+	goto done;
+    }
+    if ((xh = clicon_xmldb_handle_get(h)) == NULL){
+	clicon_err(OE_DB, 0, "Not connected to datastore plugin");
+	goto done;
+    }
+    if (xa->xa_snapshot_fn == NULL) /* Optional: use a copy */
+	retval = xa->xa_get_fn(xh, db, "/", 0, xt);
+    else
+	retval = xa->xa_snapshot_fn(xh, db, xt);
+ done:
+    return retval;
+}
+
+/*! Release a snapshot of a database
+ *
+ * @param[in]  h     CLICON handle
+ * @param[in]  db    Database given to xmldb_snapshot()
+ * @param[in]  xt    Snapshot tree returned by xmldb_snapshot()
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_snapshot
+ */
+int 
+xmldb_release(clicon_handle h, 
+	      const char   *db,
+	      cxobj        *xt)
+{
+    int               retval = -1;
+    xmldb_handle      xh;
+    struct xmldb_api *xa;
+
+    if ((xa = clicon_xmldb_api_get(h)) == NULL){
+	clicon_err(OE_DB, 0, "No xmldb plugin");
+	goto done;
+    }
+    if (xa->xa_release_fn == NULL){ /* Optional: snapshot was a copy */
+	xml_free(xt);
+	retval = 0;
+	goto done;
+    }
+    if ((xh = clicon_xmldb_handle_get(h)) == NULL){
+	clicon_err(OE_DB, 0, "Not connected to datastore plugin");
+	goto done;
+    }
+    retval = xa->xa_release_fn(xh, db, xt);
+ done:
+    return retval;
+}
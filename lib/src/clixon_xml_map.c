@@ -251,23 +251,195 @@ xml2cli(FILE              *f,
     return retval;
 }
 
+/* Values of the leafs that a leafref path refers to, see struct leafref_index */
+struct leafref_set{
+    char  **ls_vec;   /* Sorted values, pointing to bodies in the xml tree */
+    size_t  ls_len;   /* Length of ls_vec */
+};
+
+/* Index of the target values of leafref paths, created when validating a tree
+ * Without it, every leafref evaluates its path and compares with all targets.
+ * With it, the values of each path are collected and sorted once, and each 
+ * leafref is a binary search.
+ * The index refers to the xml tree and must be freed before the tree is 
+ * modified.
+ * @see xml_yang_validate_all
+ */
+struct leafref_index{
+    clicon_hash_t *li_hash; /* "<context> <path>" -> struct leafref_set* */
+};
+
+static int
+leafref_strcmp(const void *a, 
+	       const void *b)
+{
+    return strcmp(*(char**)a, *(char**)b);
+}
+
+/*! Get context of a leafref path, all leafrefs with same path and context 
+ * refer to the same leafs
+ * The context is the root for absolute paths, and the ancestor reached by the
+ * leading "../" of relative paths.
+ * @param[in]  xt    XML leaf node of type leafref
+ * @param[in]  path  Leafref path
+ * @retval     xc    Context node
+ * @retval     NULL  Path refers to the leafref itself, eg current(), not indexed
+ */
+static cxobj *
+leafref_context(cxobj *xt,
+		char  *path)
+{
+    cxobj *x = xt;
+
+    if (strchr(path, '[') != NULL) /* Predicates with current() */
+	return NULL;
+    if (*path == '/'){
+	while (xml_parent(x) != NULL)
+	    x = xml_parent(x);
+	return x;
+    }
+    while (strncmp(path, "../", 3) == 0){
+	if ((x = xml_parent(x)) == NULL)
+	    return NULL;
+	path += 3;
+    }
+    return x;
+}
+
+/*! Get values of leafs a leafref path refers to, from index or evaluate it
+ * @param[in]  li    Leafref index
+ * @param[in]  xt    XML leaf node of type leafref
+ * @param[in]  xc    Context of path, see leafref_context
+ * @param[in]  path  Leafref path
+ * @param[out] ls0   Sorted values
+ */
+static int
+leafref_set_get(struct leafref_index *li,
+		cxobj                *xt,
+		cxobj                *xc,
+		char                 *path,
+		struct leafref_set  **ls0)
+{
+    int                 retval = -1;
+    cbuf               *cb = NULL;
+    struct leafref_set *ls = NULL;
+    void               *v;
+    cxobj             **xvec = NULL;
+    size_t              xlen = 0;
+    char               *body;
+    int                 i;
+
+    if ((cb = cbuf_new()) == NULL){
+	clicon_err(OE_XML, errno, "cbuf_new");
+	goto done;
+    }
+    cprintf(cb, "%p %s", xc, path);
+    if ((v = hash_value(li->li_hash, cbuf_get(cb), NULL)) != NULL){
+	*ls0 = *(struct leafref_set **)v;
+	goto ok;
+    }
+    if (xpath_vec(xt, path, &xvec, &xlen) < 0) 
+	goto done;
+    if ((ls = malloc(sizeof(*ls))) == NULL){
+	clicon_err(OE_XML, errno, "malloc");
+	goto done;
+    }
+    memset(ls, 0, sizeof(*ls));
+    if (xlen && (ls->ls_vec = malloc(xlen*sizeof(char*))) == NULL){
+	clicon_err(OE_XML, errno, "malloc");
+	goto done;
+    }
+    for (i = 0; i < xlen; i++)
+	if ((body = xml_body(xvec[i])) != NULL)
+	    ls->ls_vec[ls->ls_len++] = body;
+    if (ls->ls_len)
+	qsort(ls->ls_vec, ls->ls_len, sizeof(char*), leafref_strcmp);
+    if (hash_add(li->li_hash, cbuf_get(cb), &ls, sizeof(ls)) == NULL)
+	goto done;
+    *ls0 = ls;
+    ls = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (ls){
+	if (ls->ls_vec)
+	    free(ls->ls_vec);
+	free(ls);
+    }
+    if (xvec)
+	free(xvec);
+    if (cb)
+	cbuf_free(cb);
+    return retval;
+}
+
+/*! Create an index of leafref target values, for validating a tree
+ * @retval  li    Leafref index, free with leafref_index_free
+ * @retval  NULL  Error
+ * @see xml_yang_validate_all
+ */
+struct leafref_index *
+leafref_index_new(void)
+{
+    struct leafref_index *li;
+
+    if ((li = malloc(sizeof(*li))) == NULL){
+	clicon_err(OE_XML, errno, "malloc");
+	return NULL;
+    }
+    if ((li->li_hash = hash_init()) == NULL){
+	free(li);
+	return NULL;
+    }
+    return li;
+}
+
+/*! Free an index of leafref target values
+ * @param[in]  li    Leafref index
+ */
+int
+leafref_index_free(struct leafref_index *li)
+{
+    char              **keys;
+    size_t              nkeys = 0;
+    struct leafref_set *ls;
+    int                 i;
+
+    if ((keys = hash_keys(li->li_hash, &nkeys)) != NULL){
+	for (i = 0; i < nkeys; i++){
+	    ls = *(struct leafref_set **)hash_value(li->li_hash, keys[i], NULL);
+	    if (ls->ls_vec)
+		free(ls->ls_vec);
+	    free(ls);
+	}
+	free(keys);
+    }
+    hash_free(li->li_hash);
+    free(li);
+    return 0;
+}
+
 /*! Validate an xml node of type leafref, ensure the value is one of that path's reference
  * @param[in]  xt    XML leaf node of type leafref
  * @param[in]  ytype Yang type statement belonging to the XML node
+ * @param[in]  li    Leafref index, or NULL
  */
 static int
-validate_leafref(cxobj     *xt,
-		 yang_stmt *ytype)
+validate_leafref(cxobj                *xt,
+		 yang_stmt            *ytype,
+		 struct leafref_index *li)
 {
-    int          retval = -1;
-    yang_stmt   *ypath;
-    cxobj      **xvec = NULL;
-    cxobj       *x;
-    int          i;
-    size_t       xlen = 0;
-    char        *leafrefbody;
-    char        *leafbody;
-
+    int                 retval = -1;
+    yang_stmt          *ypath;
+    cxobj             **xvec = NULL;
+    cxobj              *x;
+    cxobj              *xc;
+    int                 i;
+    size_t              xlen = 0;
+    char               *leafrefbody;
+    char               *leafbody;
+    struct leafref_set *ls;
+    int                 found;
 
     if ((leafrefbody = xml_body(xt)) == NULL)
 	return 0;
@@ -275,16 +447,26 @@ validate_leafref(cxobj     *xt,
 	clicon_err(OE_DB, 0, "Leafref %s requires path statement", ytype->ys_argument);
 	goto done;
     }
-    if (xpath_vec(xt, ypath->ys_argument, &xvec, &xlen) < 0) 
-	goto done;
-    for (i = 0; i < xlen; i++) {
-	x = xvec[i];
-	if ((leafbody = xml_body(x)) == NULL)
-	    continue;
-	if (strcmp(leafbody, leafrefbody) == 0)
-	    break;
+    if (li && (xc = leafref_context(xt, ypath->ys_argument)) != NULL){
+	if (leafref_set_get(li, xt, xc, ypath->ys_argument, &ls) < 0)
+	    goto done;
+	found = ls->ls_len && 
+	    bsearch(&leafrefbody, ls->ls_vec, ls->ls_len, sizeof(char*), 
+		    leafref_strcmp) != NULL;
     }
-    if (i==xlen){
+    else{
+	if (xpath_vec(xt, ypath->ys_argument, &xvec, &xlen) < 0) 
+	    goto done;
+	for (i = 0; i < xlen; i++) {
+	    x = xvec[i];
+	    if ((leafbody = xml_body(x)) == NULL)
+		continue;
+	    if (strcmp(leafbody, leafrefbody) == 0)
+		break;
+	}
+	found = i < xlen;
+    }
+    if (!found){
 	clicon_err(OE_DB, 0, "Leafref validation failed, no such leaf: %s",
 		   leafrefbody);
 	goto done;
@@ -373,9 +555,19 @@ xml_yang_validate_add(cxobj   *xt,
 /*! Validate a single XML node with yang specification for all (not only added) entries
  * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
  * @param[in]  xt  XML node to be validated
+ * @param[in]  arg Leafref index (struct leafref_index*), or NULL. Use an index 
+ *                 when validating a whole tree with many leafrefs.
  * @retval     0   Valid OK
  * @retval    -1   Validation failed
  * @see xml_yang_validate_add
+ * @code
+ *   struct leafref_index *li;
+ *   if ((li = leafref_index_new()) == NULL)
+ *      err;
+ *   if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_yang_validate_all, li) < 0)
+ *      err;
+ *   leafref_index_free(li);
+ * @endcode
  */
 int
 xml_yang_validate_all(cxobj   *xt, 
@@ -396,7 +588,7 @@ xml_yang_validate_all(cxobj   *xt,
 	    */
 	    if ((ytype = yang_find((yang_node*)ys, Y_TYPE, NULL)) != NULL &&
 		strcmp(ytype->ys_argument, "leafref") == 0)
-		if (validate_leafref(xt, ytype) < 0)
+		if (validate_leafref(xt, ytype, (struct leafref_index*)arg) < 0)
 		    goto done;
 	    break;
 	default:
@@ -595,7 +787,193 @@ yang_next(yang_node *y,
     return ys;
 }
 
+static int xml_diff1(yang_stmt *ys, cxobj *x1, cxobj *x2,
+		     cxobj ***x1vec, size_t *x1veclen,
+		     cxobj ***x2vec, size_t *x2veclen,
+		     cxobj ***changed_x1, cxobj ***changed_x2,
+		     size_t *changedlen);
+
+/*! Compute differences between two matching children, see xml_diff1
+ * @param[in]  yc       Yang spec of children
+ * @param[in]  x1c      Child of first XML tree
+ * @param[in]  x2c      Matching child of second XML tree
+ */
+static int
+xml_diff_match(yang_stmt *yc,
+	       cxobj     *x1c, 
+	       cxobj     *x2c,
+	       cxobj   ***x1vec,
+	       size_t    *x1veclen,
+	       cxobj   ***x2vec,
+	       size_t    *x2veclen,
+	       cxobj   ***changed_x1,
+	       cxobj   ***changed_x2,
+	       size_t    *changedlen)
+{
+    char *b1;
+    char *b2;
+
+    /* Equal cached hashes: subtrees are equal, skip them */
+    if (xml_hash_eq(x1c, x2c))
+	return 0;
+    if (yc->ys_keyword == Y_LEAF){
+	b1 = xml_body(x1c);
+	b2 = xml_body(x2c);
+	if (b1 == NULL && b2 == NULL)
+	    ; /* empty type */
+	else if (b1 == NULL || b2 == NULL || strcmp(b1, b2)){
+	    if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
+		return -1;
+	    (*changedlen)--; /* append two vectors */
+	    if (cxvec_append(x2c, changed_x2, changedlen) < 0) 
+		return -1;
+	}
+	return 0;
+    }
+    return xml_diff1(yc, x1c, x2c,   
+		     x1vec, x1veclen, 
+		     x2vec, x2veclen, 
+		     changed_x1, changed_x2, changedlen);
+}
+
+/*! All element children of an xml node have a yang spec, and the order of
+ * the children identifies their spec, see xml_diff_merge */
+static int
+xml_diff_spec(cxobj *x)
+{
+    cxobj     *xc = NULL;
+    yang_stmt *y;
+    yang_stmt *yprev = NULL;
+
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+	if ((y = xml_spec(xc)) == NULL)
+	    return 0;
+	if (yprev && y != yprev && yang_order(y) == yang_order(yprev))
+	    return 0;
+	yprev = y;
+    }
+    return 1;
+}
+
+/*! Compute differences between the sorted children of two xml trees
+ * Merge join: both child vectors are in xml_sort() order, ie yang order and
+ * key order, and are walked together once. Children of an ordered-by user
+ * list or leaf-list are in the order given by the user and are matched with
+ * match_base_child() instead.
+ * Children with different yang specs may have the same yang_order(), eg the
+ * data nodes in a case of a choice and the other children. Then the order of
+ * such children is arbitrary, and the diff of x1 and x2 is undone.
+ * @retval     1    Children with different specs have the same order, not done
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_diff1
+ */
+static int
+xml_diff_merge(cxobj     *x1, 
+	       cxobj     *x2,
+	       cxobj   ***x1vec,
+	       size_t    *x1veclen,
+	       cxobj   ***x2vec,
+	       size_t    *x2veclen,
+	       cxobj   ***changed_x1,
+	       cxobj   ***changed_x2,
+	       size_t    *changedlen)
+{
+    int        retval = -1;
+    int        n1 = xml_child_nr(x1);
+    int        n2 = xml_child_nr(x2);
+    int        i1 = 0;
+    int        i2 = 0;
+    int        j;
+    cxobj     *x1c;
+    cxobj     *x2c;
+    cxobj     *xc;
+    yang_stmt *yc;
+    int        cmp;
+    size_t     len1 = *x1veclen;
+    size_t     len2 = *x2veclen;
+    size_t     clen = *changedlen;
+
+    while (i1 < n1 || i2 < n2){
+	x1c = i1 < n1 ? xml_child_i(x1, i1) : NULL;
+	x2c = i2 < n2 ? xml_child_i(x2, i2) : NULL;
+	if (x1c && xml_type(x1c) != CX_ELMNT){
+	    i1++;
+	    continue;
+	}
+	if (x2c && xml_type(x2c) != CX_ELMNT){
+	    i2++;
+	    continue;
+	}
+	if (x1c && x2c && xml_spec(x1c) != xml_spec(x2c) &&
+	    yang_order(xml_spec(x1c)) == yang_order(xml_spec(x2c))){
+	    *x1veclen = len1;
+	    *x2veclen = len2;
+	    *changedlen = clen;
+	    retval = 1;
+	    goto done;
+	}
+	if (x2c == NULL)
+	    cmp = -1;
+	else if (x1c == NULL)
+	    cmp = 1;
+	else
+	    cmp = xml_cmp(&x1c, &x2c);
+	if (cmp < 0){ /* Only in x1 */
+	    if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+		goto done;
+	    i1++;
+	}
+	else if (cmp > 0){ /* Only in x2 */
+	    if (cxvec_append(x2c, x2vec, x2veclen) < 0) 
+		goto done;
+	    i2++;
+	}
+	else if (((yc = xml_spec(x1c))->ys_keyword == Y_LIST ||
+		  yc->ys_keyword == Y_LEAF_LIST) &&
+		 yang_find((yang_node*)yc, Y_ORDERED_BY, "user") != NULL){
+	    /* Match the segments of the list in x1 and x2 */
+	    for (j=i1; j<n1 && xml_spec(xc = xml_child_i(x1, j)) == yc; j++){
+		if (match_base_child(x2, xc, &x2c, yc) < 0)
+		    goto done;
+		if (x2c == NULL){
+		    if (cxvec_append(xc, x1vec, x1veclen) < 0) 
+			goto done;
+		}
+		else if (xml_diff_match(yc, xc, x2c,
+					x1vec, x1veclen, 
+					x2vec, x2veclen, 
+					changed_x1, changed_x2, changedlen) < 0)
+		    goto done;
+	    }
+	    i1 = j;
+	    for (j=i2; j<n2 && xml_spec(xc = xml_child_i(x2, j)) == yc; j++){
+		if (match_base_child(x1, xc, &x1c, yc) < 0)
+		    goto done;
+		if (x1c == NULL && cxvec_append(xc, x2vec, x2veclen) < 0) 
+		    goto done;
+	    }
+	    i2 = j;
+	}
+	else {
+	    if (xml_diff_match(yc, x1c, x2c,
+			       x1vec, x1veclen, 
+			       x2vec, x2veclen, 
+			       changed_x1, changed_x2, changedlen) < 0)
+		goto done;
+	    i1++;
+	    i2++;
+	}
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Recursive help function to compute differences between two xml trees
+ * If the children are sorted (xml_child_sort), they are compared by
+ * xml_diff_merge() in one pass, otherwise, or if their order does not 
+ * identify them, each child is looked up in the other tree.
  * @param[in]  x1       First XML tree
  * @param[in]  x2       Second XML tree
  * @param[out] x1vec     Pointervector to XML nodes existing in only first tree
@@ -622,13 +1000,18 @@ xml_diff1(yang_stmt *ys,
     cxobj     *x1c = NULL; /* x1 child */
     cxobj     *x2c = NULL; /* x2 child */
     yang_stmt *yc;
-    char      *b1;
-    char      *b2;
+    int        ret;
 
     clicon_debug(2, "%s: %s", __FUNCTION__, ys->ys_argument?ys->ys_argument:"yspec");
+    if (xml_child_sort && xml_diff_spec(x1) && xml_diff_spec(x2)){
+	if ((ret = xml_diff_merge(x1, x2,
+				  x1vec, x1veclen, 
+				  x2vec, x2veclen, 
+				  changed_x1, changed_x2, changedlen)) != 1)
+	    return ret;
+    }
     /* Check nodes present in x1 and x2 + nodes only in x1
      * Loop over x1
-     * XXX: room for improvement. Compare with match_base_child()
      */
     x1c = NULL;
     while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL){
@@ -640,26 +1023,11 @@ xml_diff1(yang_stmt *ys,
 	    if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
 		goto done;
 	}
-	else{
-	    if (yc->ys_keyword == Y_LEAF){
-		if ((b1 = xml_body(x1c)) == NULL) /* empty type */
-		    break;
-		if ((b2 = xml_body(x2c)) == NULL) /* empty type */
-		    break;
-		if (strcmp(b1, b2)){
-		    if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
-			goto done;
-		    (*changedlen)--; /* append two vectors */
-		    if (cxvec_append(x2c, changed_x2, changedlen) < 0) 
-			goto done;
-		}
-	    }
-	    if (xml_diff1(yc, x1c, x2c,   
-			  x1vec, x1veclen, 
-			  x2vec, x2veclen, 
-			  changed_x1, changed_x2, changedlen)< 0)
-		goto done;
-	}
+	else if (xml_diff_match(yc, x1c, x2c,
+				x1vec, x1veclen, 
+				x2vec, x2veclen, 
+				changed_x1, changed_x2, changedlen) < 0)
+	    goto done;
     } /* while x1 */
     /* Check nodes present only in x2
      * Loop over x2
@@ -692,6 +1060,9 @@ xml_diff1(yang_stmt *ys,
  * @param[out] changedlen Length of changed vector
  * All xml vectors should be freed after use.
  * Bot xml trees should be freed with xml_free()
+ * Subtrees with equal cached hashes are not compared, eg unchanged parts of
+ * copies of a datastore, so hashing both trees first with xml_hash() makes
+ * the diff proportional to the changes.
  */
 int
 xml_diff(yang_spec *yspec, 
@@ -722,6 +1093,8 @@ xml_diff(yang_spec *yspec,
 	    goto done;
 	goto ok;
     }
+    if (xml_hash_eq(x1, x2))
+	goto ok;
     if (xml_diff1((yang_stmt*)yspec, x1, x2,
 		  first, firstlen, 
 		  second, secondlen, 
@@ -733,6 +1106,153 @@ xml_diff(yang_spec *yspec,
     return retval;
 }
 
+/*! Recursive help function to compute differences guided by modified nodes
+ * @param[in]  ys   Yang statement of x1 and x2
+ * @param[in]  x1   Node in first XML tree
+ * @param[in]  x2   Corresponding node in second XML tree
+ * @param[in]  xd   Corresponding node in tree of modified nodes
+ * Only children of xd marked with XML_FLAG_DIRTY are visited. Children of x1
+ * are only checked for removal if xd is also marked with XML_FLAG_DEL.
+ * @see xml_diff1  for the other parameters
+ */
+static int
+xml_diff_dirty1(yang_stmt *ys, 
+		cxobj     *x1, 
+		cxobj     *x2,
+		cxobj     *xd,
+		cxobj   ***x1vec,
+		size_t    *x1veclen,
+		cxobj   ***x2vec,
+		size_t    *x2veclen,
+		cxobj   ***changed_x1,
+		cxobj   ***changed_x2,
+		size_t    *changedlen)
+{
+    int        retval = -1;
+    cxobj     *x1c;
+    cxobj     *x2c;
+    cxobj     *xdc;
+    yang_stmt *yc;
+    char      *b1;
+    char      *b2;
+    int        del;
+
+    /* Children of x1 removed (or leafs changed, eg to default) in x2 */
+    if ((del = xml_flag(xd, XML_FLAG_DEL)) != 0){
+	x1c = NULL;
+	while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL){
+	    if ((yc = yang_next((yang_node*)ys, xml_name(x1c))) == NULL)
+		goto done;
+	    if (match_base_child(x2, x1c, &x2c, yc) < 0)
+		goto done;
+	    if (x2c == NULL){
+		if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+		    goto done;
+	    }
+	    else if (yc->ys_keyword == Y_LEAF &&
+		     (b1 = xml_body(x1c)) != NULL &&
+		     (b2 = xml_body(x2c)) != NULL &&
+		     strcmp(b1, b2)){
+		if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
+		    goto done;
+		(*changedlen)--; /* append two vectors */
+		if (cxvec_append(x2c, changed_x2, changedlen) < 0) 
+		    goto done;
+	    }
+	}
+    }
+    /* Modified children: added, changed or with modified descendants */
+    xdc = NULL;
+    while ((xdc = xml_child_each(xd, xdc, CX_ELMNT)) != NULL){
+	if (!xml_flag(xdc, XML_FLAG_DIRTY)) /* eg list key */
+	    continue;
+	if ((yc = yang_next((yang_node*)ys, xml_name(xdc))) == NULL)
+	    goto done;
+	if (match_base_child(x2, xdc, &x2c, yc) < 0)
+	    goto done;
+	if (x2c == NULL) /* eg state data not in x2 */
+	    continue;
+	if (match_base_child(x1, xdc, &x1c, yc) < 0)
+	    goto done;
+	if (x1c == NULL){
+	    if (cxvec_append(x2c, x2vec, x2veclen) < 0) 
+		goto done;
+	    continue;
+	}
+	if (yc->ys_keyword == Y_LEAF){
+	    if (!del && 
+		(b1 = xml_body(x1c)) != NULL &&
+		(b2 = xml_body(x2c)) != NULL &&
+		strcmp(b1, b2)){
+		if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
+		    goto done;
+		(*changedlen)--; /* append two vectors */
+		if (cxvec_append(x2c, changed_x2, changedlen) < 0) 
+		    goto done;
+	    }
+	}
+	else if (xml_diff_dirty1(yc, x1c, x2c, xdc,
+				 x1vec, x1veclen, 
+				 x2vec, x2veclen, 
+				 changed_x1, changed_x2, changedlen) < 0)
+	    goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Compute differences between two xml trees given the modified nodes of the second
+ *
+ * Same as xml_diff() but only visits the parts of x2 that are modified 
+ * according to xd, so that the cost is proportional to the modifications,
+ * not to the size of the trees.
+ * xd has the same top as x2 and contains the nodes of x2 that are added or
+ * changed, or have such descendants, marked with XML_FLAG_DIRTY. Nodes 
+ * from which children were removed are also marked with XML_FLAG_DEL.
+ * List entries need to include their keys. See xmldb_dirty().
+ * @param[in]  yspec     Yang specification
+ * @param[in]  x1        First XML tree
+ * @param[in]  x2        Second XML tree
+ * @param[in]  xd        Tree of modified nodes of x2 relative to x1
+ * @param[out] first     Pointervector to XML nodes existing in only first tree
+ * @param[out] firstlen  Length of first vector
+ * @param[out] second    Pointervector to XML nodes existing in only second tree
+ * @param[out] secondlen Length of second vector
+ * @param[out] changed1  Pointervector to XML nodes changed orig value
+ * @param[out] changed2  Pointervector to XML nodes changed wanted value
+ * @param[out] changedlen Length of changed vector
+ * @see xml_diff
+ */
+int
+xml_diff_dirty(yang_spec *yspec, 
+	       cxobj     *x1, 
+	       cxobj     *x2,
+	       cxobj     *xd,
+	       cxobj   ***first,
+	       size_t    *firstlen,
+	       cxobj   ***second,
+	       size_t    *secondlen,
+	       cxobj   ***changed1,
+	       cxobj   ***changed2,
+	       size_t    *changedlen)
+{
+    if (x1 == NULL || x2 == NULL || xd == NULL)
+	return xml_diff(yspec, x1, x2, 
+			first, firstlen, 
+			second, secondlen, 
+			changed1, changed2, changedlen);
+    *firstlen = 0;
+    *secondlen = 0;    
+    *changedlen = 0;
+    if (!xml_flag(xd, XML_FLAG_DIRTY))
+	return 0;
+    return xml_diff_dirty1((yang_stmt*)yspec, x1, x2, xd,
+			   first, firstlen, 
+			   second, secondlen, 
+			   changed1, changed2, changedlen);
+}
+
 /*! Construct an xml key format from yang statement using wildcards for keys
  * Recursively construct it to the top.
  * Example: 
@@ -1751,6 +2271,246 @@ xml_merge(cxobj     *x0,
     return retval;
 }
 
+/*! Return body of a subtree filter or data node if it is a leaf with a value
+ * @param[in]  x   XML node
+ * @retval     str Value, content match node if x is a filter node
+ * @retval     NULL Not a leaf or no value
+ */
+static char *
+subtree_leafstring(cxobj *x)
+{
+    cxobj *xb = NULL;
+    cxobj *xc = NULL;
+
+    while ((xc = xml_child_each(x, xc, -1)) != NULL)
+	switch (xml_type(xc)){
+	case CX_ELMNT:
+	    return NULL;
+	case CX_BODY:
+	    xb = xc;
+	    break;
+	default:
+	    break;
+	}
+    return xb?xml_value(xb):NULL;
+}
+
+/*! Check attribute and content match nodes of a subtree filter node
+ * xmlns attributes of the filter are namespace declarations and not matched.
+ * @param[in]  xf  Subtree filter node
+ * @param[in]  x   XML node with the same name
+ * @retval     1   Match
+ * @retval     0   No match
+ * @see RFC 6241 Sec 6.2.3 and 6.2.5
+ */
+static int
+subtree_match(cxobj *xf,
+	      cxobj *x)
+{
+    cxobj *f = NULL;
+    cxobj *s;
+    char  *fstr;
+    char  *sstr;
+    char  *prefix;
+    char  *atom;
+
+    while ((f = xml_child_each(xf, f, CX_ATTR)) != NULL){
+	if (strcmp(xml_name(f), "xmlns") == 0 ||
+	    ((prefix = xml_namespace(f)) != NULL && strcmp(prefix, "xmlns") == 0))
+	    continue;
+	s = NULL;
+	atom = xml_name_interned(xml_name(f));
+	while ((s = xml_child_each(x, s, CX_ATTR)) != NULL)
+	    if (xml_name_eq_atom(s, xml_name(f), atom))
+		break;
+	if (s == NULL || xml_value(s) == NULL || xml_value(f) == NULL ||
+	    strcmp(xml_value(s), xml_value(f)))
+	    return 0;
+    }
+    f = NULL;
+    while ((f = xml_child_each(xf, f, CX_ELMNT)) != NULL){
+	if ((fstr = subtree_leafstring(f)) == NULL)
+	    continue;
+	s = NULL;
+	atom = xml_name_interned(xml_name(f));
+	while ((s = xml_child_each(x, s, CX_ELMNT)) != NULL)
+	    if (xml_name_eq_atom(s, xml_name(f), atom) &&
+		(sstr = subtree_leafstring(s)) != NULL &&
+		strcmp(fstr, sstr) == 0)
+		break;
+	if (s == NULL)
+	    return 0;
+    }
+    return 1;
+}
+
+/*! Find the only child of x that can match a subtree filter node, if any
+ * Containers, leafs, leaf-list content match nodes and list entries whose
+ * keys are all content match nodes are looked up with match_base_child(),
+ * ie binary search in sorted trees.
+ * @param[in]  x      XML node, parent
+ * @param[in]  f      Subtree filter node, child of filter node matching x
+ * @param[in]  yspec  Yang spec, to look up top-level symbols
+ * @param[out] xc     Matching child, or NULL
+ * @retval     1      Looked up, xc set
+ * @retval     0      All children with the name of f must be checked
+ * @retval    -1      Error
+ */
+static int
+subtree_search(cxobj     *x,
+	       cxobj     *f,
+	       yang_spec *yspec,
+	       cxobj    **xc)
+{
+    yang_stmt *yc;
+    cg_var    *cvi = NULL;
+    cxobj     *fk;
+
+    if (xml_child_spec(xml_name(f), x, yspec, &yc) < 0)
+	return -1;
+    if (yc == NULL)
+	return 0;
+    switch (yc->ys_keyword){
+    case Y_CONTAINER:
+    case Y_LEAF:
+	break;
+    case Y_LEAF_LIST:
+	if (subtree_leafstring(f) == NULL)
+	    return 0;
+	break;
+    case Y_LIST:
+	while ((cvi = cvec_each(yc->ys_cvec, cvi)) != NULL)
+	    if ((fk = xml_find(f, cv_string_get(cvi))) == NULL ||
+		subtree_leafstring(fk) == NULL)
+		return 0;
+	break;
+    default:
+	return 0;
+    }
+    if (match_base_child(x, f, xc, yc) < 0)
+	return -1;
+    return 1;
+}
+
+/* Forward */
+static int subtree_filter_node(cxobj *xf, cxobj *x, yang_spec *yspec,
+			       cxobj ***vec, size_t *veclen);
+
+/*! Match the children of a subtree filter node against the children of x
+ * @see xml_subtree_filter
+ */
+static int
+subtree_filter_children(cxobj     *xf,
+			cxobj     *x,
+			yang_spec *yspec,
+			cxobj   ***vec,
+			size_t    *veclen)
+{
+    int    retval = -1;
+    cxobj *f = NULL;
+    cxobj *s;
+    char  *atom;
+    int    ret;
+
+    while ((f = xml_child_each(xf, f, CX_ELMNT)) != NULL){
+	if ((ret = subtree_search(x, f, yspec, &s)) < 0)
+	    goto done;
+	if (ret == 1){
+	    if (s != NULL && subtree_filter_node(f, s, yspec, vec, veclen) < 0)
+		goto done;
+	    continue;
+	}
+	s = NULL;
+	atom = xml_name_interned(xml_name(f));
+	while ((s = xml_child_each(x, s, CX_ELMNT)) != NULL){
+	    if (!xml_name_eq_atom(s, xml_name(f), atom))
+		continue;
+	    if (subtree_filter_node(f, s, yspec, vec, veclen) < 0)
+		goto done;
+	}
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Match a subtree filter node against an XML node with the same name
+ * @see xml_subtree_filter
+ */
+static int
+subtree_filter_node(cxobj     *xf,
+		    cxobj     *x,
+		    yang_spec *yspec,
+		    cxobj   ***vec,
+		    size_t    *veclen)
+{
+    int    retval = -1;
+    cxobj *f = NULL;
+    char  *fstr;
+    char  *sstr;
+
+    if ((fstr = subtree_leafstring(xf)) != NULL){ /* Content match node */
+	if ((sstr = subtree_leafstring(x)) != NULL && strcmp(fstr, sstr) == 0)
+	    if (cxvec_append(x, vec, veclen) < 0)
+		goto done;
+	goto ok;
+    }
+    if (!subtree_match(xf, x))
+	goto ok;
+    /* Selection node, or only content match nodes: select all of x */
+    while ((f = xml_child_each(xf, f, CX_ELMNT)) != NULL)
+	if (subtree_leafstring(f) == NULL)
+	    break;
+    if (f == NULL){
+	if (cxvec_append(x, vec, veclen) < 0)
+	    goto done;
+	goto ok;
+    }
+    /* Containment nodes: content match nodes are selected with the rest */
+    if (subtree_filter_children(xf, x, yspec, vec, veclen) < 0)
+	goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Select the nodes of an XML tree matching a NETCONF subtree filter
+ *
+ * The result is a vector of nodes, like xpath_vec(), where each node is 
+ * selected with its whole subtree. Print the filter result with eg
+ * clicon_xml2sink_view(), which also prints the ancestors of the nodes.
+ * @param[in]  xt      Top of XML tree, eg a datastore snapshot
+ * @param[in]  xfilter Filter element, its children are matched against the
+ *                     children of xt
+ * @param[in]  yspec   Yang spec
+ * @param[out] vec     Vector of selected nodes. Free after use
+ * @param[out] veclen  Length of vec
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @code
+ *   if (xml_subtree_filter(xt, xfilter, yspec, &xvec, &xlen) < 0)
+ *      err;
+ *   if (clicon_xml2sink_view(cs, xt, "data", xvec, xlen, 1, 0) < 0)
+ *      err;
+ *   free(xvec);
+ * @endcode
+ * @note Children of list entries given by their keys are looked up directly,
+ *       other siblings are matched one by one
+ * @see RFC 6241 Sec 6 Subtree Filtering
+ */
+int
+xml_subtree_filter(cxobj     *xt,
+		   cxobj     *xfilter,
+		   yang_spec *yspec,
+		   cxobj   ***vec,
+		   size_t    *veclen)
+{
+    *vec = NULL;
+    *veclen = 0;
+    return subtree_filter_children(xfilter, xt, yspec, vec, veclen);
+}
+
 /*! Get integer value from xml node from yang enumeration 
  * @param[in]  node XML node in a tree
  * @param[out] val  Integer value returned
@@ -44,6 +44,8 @@
 /*! XML parser yacc handler struct */
 struct xml_parse_yacc_arg{
     char       *ya_parse_string; /* original (copy of) parse string */
+    size_t      ya_parse_len;    /* If set, parse string is scanned in place: 
+				    length including two trailing NULs */
     int         ya_linenum;      /* Number of \n in parsed buffer */
     void       *ya_lexbuf;       /* internal parse buffer from lex */
 
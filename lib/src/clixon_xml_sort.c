@@ -100,6 +100,183 @@ xml_child_spec(char       *name,
     return 0;
 }
 
+/*! Check if a cligen type is compared by value rather than as a string
+ * @param[in]  cvtype  Cligen variable type
+ * @retval     1       Numeric type, parse and compare values
+ * @retval     0       Compare as strings
+ */
+static int
+xml_cvtype_numeric(enum cv_type cvtype)
+{
+    switch (cvtype){
+    case CGV_INT8:
+    case CGV_INT16:
+    case CGV_INT32:
+    case CGV_INT64:
+    case CGV_UINT8:
+    case CGV_UINT16:
+    case CGV_UINT32:
+    case CGV_UINT64:
+    case CGV_DEC64:
+    case CGV_BOOL:
+	return 1;
+    default:
+	break;
+    }
+    return 0;
+}
+
+/*! Parse a string as a typed value according to a yang leaf or leaf-list
+ * @param[in]  str  String, eg xml body or key value
+ * @param[in]  y    Yang leaf or leaf-list with a populated ys_cv
+ * @retval     cv   Typed value. Free with cv_free
+ * @retval     NULL Not a numeric type or parse error: compare strings
+ */
+static cg_var *
+xml_str2cv(char      *str,
+	   yang_stmt *y)
+{
+    cg_var      *cv;
+    enum cv_type cvtype;
+    char        *reason = NULL;
+
+    if (str == NULL || y == NULL || y->ys_cv == NULL)
+	return NULL;
+    cvtype = cv_type_get(y->ys_cv);
+    if (!xml_cvtype_numeric(cvtype))
+	return NULL;
+    if ((cv = cv_new(cvtype)) == NULL)
+	return NULL;
+    if (cvtype == CGV_DEC64)
+	cv_dec64_n_set(cv, cv_dec64_n_get(y->ys_cv));
+    if (cv_parse1(str, cv, &reason) <= 0){ /* Error or invalid value */
+	if (reason)
+	    free(reason);
+	cv_free(cv);
+	return NULL;
+    }
+    return cv;
+}
+
+/*! Get typed value of body of an XML element, parse and cache it if needed
+ * The value is cached in x_cv of holder, see xml_cv_set(). The holder is either
+ * the element itself (leaf-list entry or key leaf) or, for the first key of
+ * a list, the list entry.
+ * @param[in]  xh   XML node holding the cached typed value
+ * @param[in]  xb   XML element with body, eg key leaf or leaf-list entry
+ * @retval     cv   Typed value
+ * @retval     NULL Not a numeric type, or invalid value: compare strings
+ */
+static cg_var *
+xml_body_cv(cxobj *xh,
+	    cxobj *xb)
+{
+    cg_var *cv;
+
+    if ((cv = xml_cv_get(xh)) != NULL)
+	return cv;
+    if ((cv = xml_str2cv(xml_body(xb), xml_spec(xb))) != NULL)
+	xml_cv_set(xh, cv);
+    return cv;
+}
+
+/*! Get typed value of a key of a list entry
+ * @param[in]  x       List entry
+ * @param[in]  keyname Name of key leaf
+ * @param[in]  first   Set if first key, then its typed value is cached in x
+ * @param[out] xkp     Key leaf, if looked up, for string compare if NULL 
+ *                     is returned. NULL if no key.
+ * @retval     cv      Typed value
+ * @retval     NULL    Not a numeric type or no key: compare strings
+ */
+static cg_var *
+xml_key_cv(cxobj  *x,
+	   char   *keyname,
+	   int     first,
+	   cxobj **xkp)
+{
+    cg_var *cv;
+    cxobj  *xk;
+
+    *xkp = NULL;
+    if (first && (cv = xml_cv_get(x)) != NULL)
+	return cv;
+    if ((xk = xml_find(x, keyname)) == NULL)
+	return NULL;
+    *xkp = xk;
+    return xml_body_cv(first?x:xk, xk);
+}
+
+/*! Compare two typed values of same type
+ * A value that could not be parsed (NULL), eg an invalid value in candidate
+ * before validate, is greater than all typed values. Two such values are
+ * compared by the caller as strings. This keeps the order total, as needed by
+ * qsort() and binary search, also if only some values are valid.
+ * @param[in]  cv1 Typed value or NULL, not both cv1 and cv2 NULL
+ * @param[in]  cv2 Typed value or NULL
+ * @retval  0  If equal
+ * @retval <0  if cv1 is less than cv2
+ * @retval >0  if cv1 is greater than cv2
+ */
+static int
+xml_cv_cmp(cg_var *cv1,
+	   cg_var *cv2)
+{
+    int64_t  i1;
+    int64_t  i2;
+    uint64_t u1;
+    uint64_t u2;
+
+    if (cv1 == NULL || cv2 == NULL)
+	return (cv1 == NULL) - (cv2 == NULL);
+    switch (cv_type_get(cv1)){
+    case CGV_INT8:
+	return cv_int8_get(cv1) - cv_int8_get(cv2);
+    case CGV_INT16:
+	return cv_int16_get(cv1) - cv_int16_get(cv2);
+    case CGV_INT32:
+	i1 = cv_int32_get(cv1);
+	i2 = cv_int32_get(cv2);
+	break;
+    case CGV_INT64:
+	i1 = cv_int64_get(cv1);
+	i2 = cv_int64_get(cv2);
+	break;
+    case CGV_DEC64: /* Same yang type, same fraction-digits */
+	i1 = cv_dec64_i_get(cv1);
+	i2 = cv_dec64_i_get(cv2);
+	break;
+    case CGV_UINT8:
+	return cv_uint8_get(cv1) - cv_uint8_get(cv2);
+    case CGV_UINT16:
+	return cv_uint16_get(cv1) - cv_uint16_get(cv2);
+    case CGV_UINT32:
+	u1 = cv_uint32_get(cv1);
+	u2 = cv_uint32_get(cv2);
+	return (u1 > u2) - (u1 < u2);
+    case CGV_UINT64:
+	u1 = cv_uint64_get(cv1);
+	u2 = cv_uint64_get(cv2);
+	return (u1 > u2) - (u1 < u2);
+    case CGV_BOOL:
+	return cv_bool_get(cv1) - cv_bool_get(cv2);
+    default:
+	return 0;
+    }
+    return (i1 > i2) - (i1 < i2);
+}
+
+/*! Compare two strings, where NULL is less than any string
+ */
+static int
+xml_str_cmp(char *s1,
+	    char *s2)
+{
+    if (s1 == NULL || s2 == NULL)
+	return (s1 != NULL) - (s2 != NULL);
+    return strcmp(s1, s2);
+}
+
 /*! Help function to qsort for sorting entries in xml child vector
  * @param[in]  arg1 - actually cxobj**
  * @param[in]  arg2 - actually cxobj**
@@ -107,6 +284,8 @@ xml_child_spec(char       *name,
  * @retval <0  if arg1 is less than arg2
  * @retval >0  if arg1 is greater than arg2
  * @note args are pointer ot pointers, to fit into qsort cmp function
+ * @note leaf-list values and list keys of numeric yang types are compared as
+ *       typed values, cached in the xml nodes, otherwise as strings.
  * @see xml_cmp1   Similar, but for one object
  */
 int
@@ -121,9 +300,12 @@ xml_cmp(const void* arg1,
     int         yi2;
     cvec       *cvk = NULL; /* vector of index keys */
     cg_var     *cvi;
+    cg_var     *cv1;
+    cg_var     *cv2;
+    cxobj      *xk1;
+    cxobj      *xk2;
     int         equal = 0;
-    char       *b1;
-    char       *b2;
+    int         first;
     char       *keyname;
     
     assert(x1&&x2);
@@ -144,19 +326,31 @@ xml_cmp(const void* arg1,
 	return 0; /* Ordered by user: maintain existing order */
     switch (y1->ys_keyword){
     case Y_LEAF_LIST: /* Match with name and value */
-	equal = strcmp(xml_body(x1), xml_body(x2));
+	cv1 = xml_body_cv(x1, x1);
+	cv2 = xml_body_cv(x2, x2);
+	if (cv1 || cv2)
+	    equal = xml_cv_cmp(cv1, cv2);
+	else
+	    equal = xml_str_cmp(xml_body(x1), xml_body(x2));
 	break;
     case Y_LIST: /* Match with key values 
 		  * Use Y_LIST cache (see struct yang_stmt)
 		  */
 	cvk = y1->ys_cvec; /* Use Y_LIST cache, see ys_populate_list() */
 	cvi = NULL;
+	first = 1;
 	while ((cvi = cvec_each(cvk, cvi)) != NULL) {
 	    keyname = cv_string_get(cvi);
-	    b1 = xml_find_body(x1, keyname);
-	    b2 = xml_find_body(x2, keyname);
-	    if ((equal = strcmp(b1,b2)) != 0)
+	    cv1 = xml_key_cv(x1, keyname, first, &xk1);
+	    cv2 = xml_key_cv(x2, keyname, first, &xk2);
+	    if (cv1 || cv2)
+		equal = xml_cv_cmp(cv1, cv2);
+	    else
+		equal = xml_str_cmp(xk1?xml_body(xk1):NULL,
+				    xk2?xml_body(xk2):NULL);
+	    if (equal != 0)
 		goto done;
+	    first = 0;
 	}
 	equal = 0;
 	break;
@@ -167,11 +361,66 @@ xml_cmp(const void* arg1,
     return equal;
 }
 
+/*! Parse key values of a search into typed values
+ * @param[in]  y        Yang spec of list or leaf-list
+ * @param[in]  keynr    Length of keyvec/keyval vector
+ * @param[in]  keyvec   Array of of yang key identifiers
+ * @param[in]  keyval   Array of of yang key values
+ * @param[out] keycvp   Array of typed values, NULL entries are compared as 
+ *                      strings. Free with xml_keycv_free
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+xml_keycv_new(yang_stmt *y,
+	      int        keynr,
+	      char     **keyvec,
+	      char     **keyval,
+	      cg_var  ***keycvp)
+{
+    cg_var   **keycv;
+    yang_stmt *yk;
+    int        i;
+
+    if ((keycv = calloc(keynr+1, sizeof(cg_var*))) == NULL){
+	clicon_err(OE_UNIX, errno, "calloc");
+	return -1;
+    }
+    for (i=0; i<keynr; i++){
+	if (y->ys_keyword == Y_LEAF_LIST)
+	    yk = y;
+	else if ((yk = yang_find((yang_node*)y, Y_LEAF, keyvec[i])) == NULL)
+	    continue;
+	keycv[i] = xml_str2cv(keyval[i], yk);
+    }
+    *keycvp = keycv;
+    return 0;
+}
+
+/*! Free array of typed key values
+ * @see xml_keycv_new
+ */
+static int
+xml_keycv_free(cg_var **keycv,
+	       int      keynr)
+{
+    int i;
+
+    if (keycv == NULL)
+	return 0;
+    for (i=0; i<keynr; i++)
+	if (keycv[i])
+	    cv_free(keycv[i]);
+    free(keycv);
+    return 0;
+}
+
 /*!
  * @param[in] yangi  Yang order
  * @param[in]  keynr    Length of keyvec/keyval vector when applicable
  * @param[in]  keyvec   Array of of yang key identifiers
  * @param[in]  keyval   Array of of yang key values
+ * @param[in]  keycv    Array of typed key values (entries may be NULL), or NULL
  * @param[out] userorder If set, this yang order is user ordered, linear search
  * @retval  0  If equal (or userorder set)
  * @retval <0  if arg1 is less than arg2
@@ -186,24 +435,33 @@ xml_cmp1(cxobj        *x,
 	 int           keynr,
 	 char        **keyvec,
 	 char        **keyval,
+	 cg_var      **keycv,
 	 int          *userorder)
 {
-    char *b;
-    int   i;
-    char *keyname;
-    char *key;
+    char   *b;
+    int     i;
+    char   *keyname;
+    char   *key;
+    cg_var *cv;
+    cxobj  *xk;
+    int     cmp;
 
     /* Check if same yang spec (order in yang stmt list) */
     switch (keyword){
     case Y_CONTAINER: /* Match with name */
     case Y_LEAF: /* Match with name */
+	if (xml_name_eq(x, name))
+	    return 0;
 	return strcmp(name, xml_name(x));
 	break;
     case Y_LEAF_LIST: /* Match with name and value */
 	if (userorder && yang_find((yang_node*)y, Y_ORDERED_BY, "user") != NULL)
 	    *userorder=1;
+	cv = xml_body_cv(x, x);
+	if ((keycv && keycv[0]) || cv)
+	    return xml_cv_cmp(keycv?keycv[0]:NULL, cv);
 	b=xml_body(x);
-	return strcmp(keyval[0], b);
+	return xml_str_cmp(keyval[0], b);
 	break;
     case Y_LIST: /* Match with array of key values */
 	if (userorder && yang_find((yang_node*)y, Y_ORDERED_BY, "user") != NULL)
@@ -211,10 +469,17 @@ xml_cmp1(cxobj        *x,
 	for (i=0; i<keynr; i++){
 	    keyname = keyvec[i];
 	    key = keyval[i];
-	    /* Eg return "e0" in <if><name>e0</name></name></if> given "name" */
-	    if ((b = xml_find_body(x, keyname)) == NULL)
-		break; /* error case */
-	    return strcmp(key, b);
+	    cv = xml_key_cv(x, keyname, i==0, &xk);
+	    if ((keycv && keycv[i]) || cv)
+		cmp = xml_cv_cmp(keycv?keycv[i]:NULL, cv);
+	    else{
+		/* Eg return "e0" in <if><name>e0</name></name></if> given "name" */
+		if (xk == NULL || (b = xml_body(xk)) == NULL)
+		    break; /* error case */
+		cmp = strcmp(key, b);
+	    }
+	    if (cmp != 0)
+		return cmp;
 	}
 	return 0;
 	break;
@@ -226,6 +491,8 @@ xml_cmp1(cxobj        *x,
 
 /*! Sort children of an XML node
  * Assume populated by yang spec.
+ * Children that are already sorted, eg in a copy of a sorted tree, are not
+ * touched, which keeps the name index and hash of the node, see xml_hash().
  * @param[in] x0   XML node
  * @param[in] arg  Dummy so it can be called by xml_apply()
  */
@@ -233,7 +500,19 @@ int
 xml_sort(cxobj *x,
 	 void  *arg)
 {
-    qsort(xml_childvec_get(x), xml_child_nr(x), sizeof(cxobj *), xml_cmp);
+    int    i;
+    int    n = xml_child_nr(x);
+    cxobj *xprev;
+    cxobj *xc;
+
+    for (i=1; i<n; i++){
+	xprev = xml_child_i(x, i-1);
+	xc = xml_child_i(x, i);
+	if (xml_cmp(&xprev, &xc) > 0)
+	    break;
+    }
+    if (i < n)
+	qsort(xml_childvec_get(x), n, sizeof(cxobj *), xml_cmp);
     return 0;
 }
 
@@ -248,7 +527,8 @@ xml_search_userorder(cxobj        *x0,
 		     enum rfc_6020 keyword,   
 		     int           keynr,
 		     char        **keyvec,
-		     char        **keyval)
+		     char        **keyval,
+		     cg_var      **keycv)
 {
     int    i;
     cxobj *xc;
@@ -258,7 +538,7 @@ xml_search_userorder(cxobj        *x0,
 	y = xml_spec(xc);
 	if (yangi!=yang_order(y))
 	    break;
-	if (xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, NULL) == 0)
+	if (xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, keycv, NULL) == 0)
 	    return xc;
     }
     for (i=mid-1; i>=0; i--){ /* Then decrement */
@@ -266,7 +546,7 @@ xml_search_userorder(cxobj        *x0,
 	y = xml_spec(xc);
 	if (yangi!=yang_order(y))
 	    break;
-	if (xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, NULL) == 0)
+	if (xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, keycv, NULL) == 0)
 	    return xc;
     }
     return NULL; /* Not found */
@@ -277,6 +557,7 @@ xml_search_userorder(cxobj        *x0,
  * @param[in]  keynr    Length of keyvec/keyval vector when applicable
  * @param[in]  keyvec   Array of of yang key identifiers
  * @param[in]  keyval   Array of of yang key values
+ * @param[in,out] keycvp Typed key values, parsed on first yang order match
  * @param[in] low    Lower bound of childvec search interval 
  * @param[in] upper  Lower bound of childvec search interval 
  */
@@ -288,6 +569,7 @@ xml_search1(cxobj        *x0,
 	    int           keynr,
 	    char        **keyvec,
 	    char        **keyval,
+	    cg_var     ***keycvp,
 	    int           low, 
 	    int           upper)
 {
@@ -306,18 +588,21 @@ xml_search1(cxobj        *x0,
     assert(y = xml_spec(xc));
     cmp = yangi-yang_order(y);
     if (cmp == 0){
-	cmp = xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, &userorder);
+	if (keynr && *keycvp == NULL &&
+	    xml_keycv_new(y, keynr, keyvec, keyval, keycvp) < 0)
+	    return NULL;
+	cmp = xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, *keycvp, &userorder);
 	if (userorder && cmp)	    /* Look inside this yangi order */
-	    return xml_search_userorder(x0, y, name, yangi, mid, keyword, keynr, keyvec, keyval);
+	    return xml_search_userorder(x0, y, name, yangi, mid, keyword, keynr, keyvec, keyval, *keycvp);
     }
     if (cmp == 0)
 	return xc;
     else if (cmp < 0)
 	return xml_search1(x0, name, yangi, keyword,
-			   keynr, keyvec, keyval, low, mid-1);
+			   keynr, keyvec, keyval, keycvp, low, mid-1);
     else 
 	return xml_search1(x0, name, yangi, keyword,
-			   keynr, keyvec, keyval, mid+1, upper);
+			   keynr, keyvec, keyval, keycvp, mid+1, upper);
     return NULL;
 }
 
@@ -326,6 +611,8 @@ xml_search1(cxobj        *x0,
  * @param[in]  keynr    Length of keyvec/keyval vector when applicable
  * @param[in]  keyvec   Array of of yang key identifiers
  * @param[in]  keyval   Array of of yang key values
+ * @note Key values of numeric yang types are parsed once and compared as typed
+ *       values, consistent with xml_cmp()
  */
 cxobj *
 xml_search(cxobj        *x0,
@@ -336,30 +623,29 @@ xml_search(cxobj        *x0,
 	   char        **keyvec,
 	   char        **keyval)
 {
-    return xml_search1(x0, name, yangi, keyword, keynr, keyvec, keyval,
-		       0, xml_child_nr(x0));
-}
+    cxobj   *xc;
+    cg_var **keycv = NULL;
 
+    xc = xml_search1(x0, name, yangi, keyword, keynr, keyvec, keyval, &keycv,
+		     0, xml_child_nr(x0));
+    xml_keycv_free(keycv, keynr);
+    return xc;
+}
 
 /*! Position where to insert xml object into a list of children nodes
- * @note EXPERIMENTAL
- * Insert after position returned
- * @param[in]  x0       XML parent node.
- * @param[in]  low       Lower bound
- * @param[in]  upper     Upper bound (+1)
- * @retval     position 
- * XXX: Problem with this is that evrything must be known before insertion
+ * @see xml_insert_pos
  */
-int
-xml_insert_pos(cxobj        *x0,
-	       char         *name,
-	       int           yangi,
-	       enum rfc_6020 keyword,   
-	       int           keynr,
-	       char        **keyvec,
-	       char        **keyval,
-	       int           low, 
-	       int           upper)
+static int
+xml_insert_pos1(cxobj        *x0,
+		char         *name,
+		int           yangi,
+		enum rfc_6020 keyword,   
+		int           keynr,
+		char        **keyvec,
+		char        **keyval,
+		cg_var     ***keycvp,
+		int           low, 
+		int           upper)
 {
     int        mid;
     cxobj     *xc;
@@ -377,12 +663,15 @@ xml_insert_pos(cxobj        *x0,
     y = xml_spec(xc);
     cmp = yangi-yang_order(y);
     if (cmp == 0){
-	cmp = xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, &userorder);
+	if (keynr && *keycvp == NULL &&
+	    xml_keycv_new(y, keynr, keyvec, keyval, keycvp) < 0)
+	    return -1;
+	cmp = xml_cmp1(xc, y, name, keyword, keynr, keyvec, keyval, *keycvp, &userorder);
 	if (userorder){	    /* Look inside this yangi order */
 	    /* Special case: append last of equals if ordered by user */
 	    for (i=mid+1;i<xml_child_nr(x0);i++){
 		xc = xml_child_i(x0, i);
-		if (strcmp(xml_name(xc), name))
+		if (!xml_name_eq(xc, name))
 		    break;
 		mid=i; /* still ok */
 	    }
@@ -392,11 +681,40 @@ xml_insert_pos(cxobj        *x0,
     if (cmp == 0)
 	return mid;
     else if (cmp < 0)
-	return xml_insert_pos(x0, name, yangi, keyword,
-			      keynr, keyvec, keyval, low, mid-1);
+	return xml_insert_pos1(x0, name, yangi, keyword,
+			       keynr, keyvec, keyval, keycvp, low, mid-1);
     else
-	return xml_insert_pos(x0, name, yangi, keyword,
-			      keynr, keyvec, keyval, mid+1, upper);
+	return xml_insert_pos1(x0, name, yangi, keyword,
+			       keynr, keyvec, keyval, keycvp, mid+1, upper);
+}
+
+/*! Position where to insert xml object into a list of children nodes
+ * @note EXPERIMENTAL
+ * Insert after position returned
+ * @param[in]  x0       XML parent node.
+ * @param[in]  low       Lower bound
+ * @param[in]  upper     Upper bound (+1)
+ * @retval     position 
+ * XXX: Problem with this is that evrything must be known before insertion
+ */
+int
+xml_insert_pos(cxobj        *x0,
+	       char         *name,
+	       int           yangi,
+	       enum rfc_6020 keyword,   
+	       int           keynr,
+	       char        **keyvec,
+	       char        **keyval,
+	       int           low, 
+	       int           upper)
+{
+    int      pos;
+    cg_var **keycv = NULL;
+
+    pos = xml_insert_pos1(x0, name, yangi, keyword, keynr, keyvec, keyval,
+			  &keycv, low, upper);
+    xml_keycv_free(keycv, keynr);
+    return pos;
 }
 
 /*! Find matching xml child given name and optional key values
@@ -436,6 +754,8 @@ xml_insert_pos(cxobj        *x0,
  *   - list, keyvec and keyval should be an array with keynr length
  *   - leaf_list, keyval should be 1 and keyval should contain one element
  *   - otherwise, keyval should be 0 and keyval and keyvec should be both NULL.
+ * @note Keys of numeric yang types are compared as typed values, as in
+ *       xml_search(), if the children of x0 have yang specs.
  */
 cxobj *
 xml_match(cxobj        *x0,
@@ -445,12 +765,14 @@ xml_match(cxobj        *x0,
 	  char        **keyvec,
 	  char        **keyval)
 {
-    char  *key;
-    char  *keyname;
-    char  *b0;
-    cxobj *x = NULL;
-    int    equal;
-    int    i;
+    char    *b0;
+    cxobj   *x = NULL;
+    cxobj   *xk;
+    cg_var **keycv = NULL;
+    cg_var  *cv;
+    char    *atom;
+    int      parsed = 0;
+    int      i;
     
     x = NULL;
     switch (keyword){
@@ -465,26 +787,55 @@ xml_match(cxobj        *x0,
     case Y_LEAF_LIST: /* Match with name and value */
 	if (keynr != 1)
 	    goto ok;
-	x = xml_find_body_obj(x0, name, keyval[0]);
+	if ((x = xml_find(x0, name)) == NULL)
+	    break;
+	if (xml_spec(x) != NULL &&
+	    xml_keycv_new(xml_spec(x), keynr, keyvec, keyval, &keycv) < 0){
+	    x = NULL;
+	    goto ok;
+	}
+	if (keycv == NULL || keycv[0] == NULL){ /* Not numeric: strings */
+	    x = xml_find_body_obj(x0, name, keyval[0]);
+	    break;
+	}
+	x = NULL;
+	atom = xml_name_interned(name);
+	while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL){
+	    if (!xml_name_eq_atom(x, name, atom))
+		continue;
+	    if ((cv = xml_body_cv(x, x)) != NULL &&
+		xml_cv_cmp(keycv[0], cv) == 0)
+		break;
+	}
 	break;
     case Y_LIST: /* Match with array of key values */
-	i = 0;
+	atom = xml_name_interned(name);
 	while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL){
-	    equal = 0;
-	    if (strcmp(xml_name(x), name))
+	    if (!xml_name_eq_atom(x, name, atom))
 		continue;
+	    if (!parsed && xml_spec(x) != NULL){ /* Typed key values, once */
+		if (xml_keycv_new(xml_spec(x), keynr, keyvec, keyval, &keycv) < 0){
+		    x = NULL;
+		    goto ok;
+		}
+		parsed++;
+	    }
 	    /* Must be inner loop */
 	    for (i=0; i<keynr; i++){
-		keyname = keyvec[i];
-		key = keyval[i];
-		equal = 0;
-		if ((b0 = xml_find_body(x, keyname)) == NULL)
+		cv = keycv ? xml_key_cv(x, keyvec[i], i==0, &xk) : NULL;
+		if ((keycv && keycv[i]) || cv){
+		    if (xml_cv_cmp(keycv?keycv[i]:NULL, cv) != 0)
+			break;
+		    continue;
+		}
+		if (keycv == NULL)
+		    xk = xml_find(x, keyvec[i]);
+		if (xk == NULL || (b0 = xml_body(xk)) == NULL)
 		    break; /* error case */
-		if (strcmp(b0, key))
+		if (strcmp(b0, keyval[i]))
 		    break; /* stop as soon as inequal key found */
-		equal=1; /* reaches here for all keynames, x is found. */
 	    }
-	    if (equal) /* x matches, oyherwise look for other */
+	    if (i == keynr) /* x matches, otherwise look for other */
 		break;
 	} /* while x */
 	break;
@@ -492,6 +843,7 @@ xml_match(cxobj        *x0,
 	break;
     }
  ok:
+    xml_keycv_free(keycv, keynr);
     return x;
 }
 
@@ -107,11 +107,18 @@ in
 #include "clixon_handle.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
+#include "clixon_xml_sort.h"
 #include "clixon_xsl.h"
 
 /* Constants */
 #define XPATH_VEC_START 128
 
+/* Number of compiled xpaths kept in cache, see xpath_compile() */
+#define XPATH_CACHE_MAX 128
+
+/* Max number of list keys looked up with binary search, see xpath_find_keys() */
+#define XPATH_KEYS_MAX 8
+
 /*
  * Types 
  */
@@ -149,6 +156,8 @@ static const map_str2int axismap[] = {
 struct xpath_predicate{
     struct xpath_predicate *xp_next;
     char                   *xp_expr;
+    char                   *xp_tag; /* <tag> if xp_expr is <tag>=<value> */
+    char                   *xp_val; /* <value> (in same string as xp_tag) */
 };
 
 struct xpath_element{
@@ -156,9 +165,26 @@ struct xpath_element{
     enum axis_type          xe_type;
     char                   *xe_prefix; /* eg for namespaces */
     char                   *xe_str; /* eg for child */
+    char                   *xe_name; /* xe_str if not a pattern, interned if 
+					possible, see xml_name_intern() */
     struct xpath_predicate *xe_predicate; /* eg within [] */
 };
 
+/* Compiled xpath expression, see xpath_compile() */
+struct xpath_compiled{
+    qelem_t                xc_qelem; /* LRU list of cache. Must be first */
+    char                  *xc_str;   /* xpath expression, key of cache */
+    int                    xc_refs;  /* References, from cache and users */
+    int                    xc_len;   /* Number of alternatives, ie "a | b" */
+    struct xpath_element **xc_vec;   /* Parsed alternatives */
+};
+
+/* Cache of compiled xpaths: xpath string -> struct xpath_compiled * */
+static clicon_hash_t         *xpath_cache = NULL;
+/* Cached xpaths, most recently used first */
+static struct xpath_compiled *xpath_lru = NULL;
+static int                    xpath_cache_len = 0;
+
 static int xpath_split(char *xpathstr, char **pathexpr);
 
 static int 
@@ -176,6 +202,42 @@ xpath_print(FILE *f, struct xpath_element *xplist)
     return 0;
 }
 
+/*! Split a predicate of the form <tag>=<value> into tag and value
+ * Same split as in xpath_expr(), but not for @<attr>, <number> or 
+ * current() expressions, which leave xp_tag NULL.
+ * @param[in,out] xp  Predicate
+ */
+static int
+xpath_parse_tagval(struct xpath_predicate *xp)
+{
+    int   retval = -1;
+    char *tag;
+    char *val;
+
+    if (*xp->xp_expr == '@' || strchr(xp->xp_expr, '=') == NULL)
+	goto ok;
+    if ((tag = strdup(xp->xp_expr)) == NULL){
+	clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
+	goto done;
+    }
+    val = tag;
+    strsep(&val, "=");
+    while (strlen(tag) && tag[strlen(tag)-1] == ' ')
+	tag[strlen(tag)-1] = '\0';
+    while (val[0]==' ')
+	val++;
+    if (strncmp(val, "current()", strlen("current()")) == 0){
+	free(tag);
+	goto ok;
+    }
+    xp->xp_tag = tag;
+    xp->xp_val = val;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Extract PredicateExpr (Expr) from a Predicate within [] 
  * @see xpath_expr  For evaluation of predicate 
  */
@@ -209,6 +271,8 @@ xpath_parse_predicate(struct xpath_element *xe,
 	    }
 	    xp->xp_next = xe->xe_predicate;
 	    xe->xe_predicate = xp;
+	    if (xpath_parse_tagval(xp) < 0)
+		goto done;
 	}
     }
     retval = 0;
@@ -256,6 +320,10 @@ xpath_element_new(enum axis_type          atype,
 		clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
 		goto done;
 	    }
+	    /* Names are matched with xml_name_eq_atom(), patterns with fnmatch() */
+	    if (strpbrk(local, "*?[\\") == NULL &&
+		(xe->xe_name = xml_name_interned(local)) == NULL)
+		xe->xe_name = xe->xe_str;
 	}
 	else{
 	    if ((xe->xe_str = strdup("*")) == NULL){
@@ -290,6 +358,8 @@ xpath_element_free(struct xpath_element *xe)
 	xe->xe_predicate = xp->xp_next;
 	if (xp->xp_expr)
 	    free(xp->xp_expr);
+	if (xp->xp_tag)
+	    free(xp->xp_tag);
 	free(xp);
     }
     free(xe);
@@ -400,12 +470,30 @@ xpath_parse(char                  *xpath,
     return retval;
 }
 
+/*! Match name of xml node with xpath element
+ * Names are compared with xml_name_eq_atom(), patterns with fnmatch()
+ * @param[in]  xe   Xpath element
+ * @param[in]  x    XML node
+ * @retval     1    Match
+ * @retval     0    No match
+ */
+static inline int
+xpath_name_match(struct xpath_element *xe,
+		 cxobj                *x)
+{
+    if (xe->xe_name) /* Interned unless it is xe_str */
+	return xml_name_eq_atom(x, xe->xe_name, 
+				xe->xe_name!=xe->xe_str?xe->xe_name:NULL);
+    return fnmatch(xe->xe_str, xml_name(x), 0) == 0;
+}
+
 /*! Find a node 'deep' in an XML tree
  *
  * The xv_* arguments are filled in  nodes found earlier.
  * args:
  *  @param[in]    xn_parent  Base XML object
- *  @param[in]    name       shell wildcard pattern to match with node name
+ *  @param[in]    xe         xpath element with name or shell wildcard pattern
+ *                           to match with node name
  *  @param[in]    node_type  CX_ELMNT, CX_ATTR or CX_BODY
  *  @param[in,out] vec1      internal buffers with results
  *  @param[in,out] vec0      internal buffers with results
@@ -416,7 +504,7 @@ xpath_parse(char                  *xpath,
  */
 static int
 recursive_find(cxobj   *xn, 
-	       char    *pattern, 
+	       struct xpath_element *xe, 
 	       int      node_type,
 	       uint16_t flags,
 	       cxobj ***vec0,
@@ -426,19 +514,17 @@ recursive_find(cxobj   *xn,
     cxobj  *xsub; 
     cxobj **vec = *vec0;
     size_t  veclen = *vec0len;
-    char   *name;
 
     xsub = NULL;
     while ((xsub = xml_child_each(xn, xsub, node_type)) != NULL) {
-	name = xml_name(xsub);
-	if (fnmatch(pattern, name, 0) == 0){
+	if (xpath_name_match(xe, xsub)){
 	    clicon_debug(2, "%s %x %x", __FUNCTION__, flags, xml_flag(xsub, flags));
 	    if (flags==0x0 || xml_flag(xsub, flags))
 		if (cxvec_append(xsub, &vec, &veclen) < 0)
 		    goto done;
 	    //	    continue; /* Dont go deeper */
 	}
-	if (recursive_find(xsub, pattern, node_type, flags, &vec, &veclen) < 0)
+	if (recursive_find(xsub, xe, node_type, flags, &vec, &veclen) < 0)
 	    goto done;
     }
     retval = 0;
@@ -450,8 +536,8 @@ recursive_find(cxobj   *xn,
 
 /* forward */
 static int
-xpath_exec(cxobj *xcur, char *xpath, cxobj **vec0, size_t vec0len,
-	   uint16_t flags, cxobj ***vec2, size_t *vec2len);
+xpath_exec(cxobj *xcur, struct xpath_compiled *xc, cxobj **vec0, 
+	   size_t vec0len, uint16_t flags, cxobj ***vec2, size_t *vec2len);
 
 /*! XPath predicate expression check
  * @param[in]  xcur  xml-tree where to search
@@ -557,6 +643,8 @@ xpath_expr(cxobj    *xcur,
 		cxobj    **svec1 = NULL;
 		size_t     svec1len = 0;
 		char      *ebody;
+		xpath_compiled *sxc;
+		int        ret;
 
 		e += strlen("current("); /* e is path expression */
 		*e = '.';
@@ -567,9 +655,19 @@ xpath_expr(cxobj    *xcur,
 		svec0[0] = xcur;
 		svec0len++;
 		/* Recursive invocation */
-		if (xpath_exec(xcur, e, svec0, svec0len,
-			       flags, &svec1, &svec1len) < 0)
+		if ((sxc = xpath_compile(e)) == NULL){
+		    free(svec0);
 		    goto done;
+		}
+		ret = xpath_exec(xcur, sxc, svec0, svec0len,
+				 flags, &svec1, &svec1len);
+		xpath_compiled_free(sxc);
+		free(svec0);
+		if (ret < 0){
+		    if (svec1)
+			free(svec1);
+		    goto done;
+		}
 		for (j=0; j<svec1len; j++){
 		    ebody = xml_body(svec1[j]);
 		    for (i=0; i<*vec0len; i++){
@@ -589,6 +687,8 @@ xpath_expr(cxobj    *xcur,
 			}
 		    }
 		}
+		if (svec1)
+		    free(svec1);
 	    }
 	    else { /* name = value */
 		for (i=0; i<*vec0len; i++){
@@ -622,6 +722,65 @@ xpath_expr(cxobj    *xcur,
     return retval;
 }
 
+/*! Find a list entry by the key values in the predicates of an xpath step
+ * Binary search is used instead of checking all children if the step is a
+ * yang list and its predicates give the values of all keys of the list, eg
+ * x/y[a=42] if a is the key of list y.
+ * Other predicates are applied to the result as usual.
+ * @param[in]  xv    XML node whose children are searched
+ * @param[in]  xe    xpath child step, eg y[a=42]
+ * @param[out] xp    Matching child, or NULL if none
+ * @retval     1     Searched, result in xp
+ * @retval     0     Not applicable, check all children
+ * @see xml_search
+ */
+static int
+xpath_find_keys(cxobj                *xv,
+		struct xpath_element *xe,
+		cxobj               **xp)
+{
+    cxobj                  *x0c;
+    yang_stmt              *yp;
+    yang_stmt              *y;
+    cg_var                 *cvi;
+    struct xpath_predicate *xpr;
+    char                   *keyvec[XPATH_KEYS_MAX];
+    char                   *keyval[XPATH_KEYS_MAX];
+    int                     keynr = 0;
+
+    if (!xml_child_sort || xe->xe_predicate == NULL || xe->xe_name == NULL)
+	return 0;
+    /* Positional and other predicates may select among several entries */
+    for (xpr = xe->xe_predicate; xpr; xpr = xpr->xp_next)
+	if (xpr->xp_tag == NULL)
+	    return 0;
+    /* Children are sorted if populated by yang, see match_base_child() */
+    if ((x0c = xml_child_i(xv, 0)) == NULL || xml_spec(x0c) == NULL)
+	return 0;
+    if ((yp = xml_spec(xv)) != NULL)
+	y = yang_find_datanode((yang_node*)yp, xe->xe_str);
+    else
+	y = yang_find_topnode(ys_spec(xml_spec(x0c)), xe->xe_str, 0);
+    if (y == NULL || y->ys_keyword != Y_LIST)
+	return 0;
+    cvi = NULL;
+    while ((cvi = cvec_each(y->ys_cvec, cvi)) != NULL) {
+	if (keynr == XPATH_KEYS_MAX)
+	    return 0;
+	keyvec[keynr] = cv_string_get(cvi);
+	for (xpr = xe->xe_predicate; xpr; xpr = xpr->xp_next)
+	    if (strcmp(xpr->xp_tag, keyvec[keynr]) == 0)
+		break;
+	if (xpr == NULL) /* Not a key */
+	    return 0;
+	keyval[keynr++] = xpr->xp_val;
+    }
+    if (keynr == 0)
+	return 0;
+    *xp = xml_search(xv, xe->xe_name, yang_order(y), Y_LIST, keynr, keyvec, keyval);
+    return 1;
+}
+
 /*! Given vec0, add matches to vec1
  * @param[in]   xcur  xml-tree where to search
  * @param[in]   xe      XPATH in structured (parsed) form
@@ -656,10 +815,19 @@ xpath_find(cxobj                *xcur,
     char          *name;
 
     if (xe == NULL){
+	/* First result: hand over vec0 instead of copying it */
+	if (flags == 0x0 && *vec2 == NULL){
+	    *vec2 = vec0;
+	    *vec2len = vec0len;
+	    return 0;
+	}
 	for (i=0; i<vec0len; i++){
 	    xv = vec0[i];
 	    if (flags==0x0 || xml_flag(xv, flags))
-		cxvec_append(xv, vec2, vec2len);
+		if (cxvec_append(xv, vec2, vec2len) < 0){
+		    free(vec0);
+		    goto done;
+		}
 	}
 	free(vec0);
 	return 0;
@@ -697,17 +865,23 @@ xpath_find(cxobj                *xcur,
 	if (descendants0){
 	    for (i=0; i<vec0len; i++){
 		xv = vec0[i];
-		if (recursive_find(xv, xe->xe_str, CX_ELMNT, flags, &vec1, &vec1len) < 0)
+		if (recursive_find(xv, xe, CX_ELMNT, flags, &vec1, &vec1len) < 0)
 		    goto done;
 	    }
 	}
 	else{
 	    for (i=0; i<vec0len; i++){
 		xv = vec0[i];
+		if (xpath_find_keys(xv, xe, &x) == 1){
+		    if (x && (flags==0x0 || xml_flag(x, flags)))
+			if (cxvec_append(x, &vec1, &vec1len) < 0)
+			    goto done;
+		    continue;
+		}
 		x = NULL;
 		while ((x = xml_child_each(xv, x, -1)) != NULL) {
 		    name = xml_name(x);
-		    if (name && fnmatch(xe->xe_str, name, 0) == 0) {
+		    if (name && xpath_name_match(xe, x)) {
 				clicon_debug(2, "%s %x %x", __FUNCTION__, flags, xml_flag(x, flags));
 				if (flags==0x0 || xml_flag(x, flags))
 				    if (cxvec_append(x, &vec1, &vec1len) < 0)
@@ -792,42 +966,207 @@ xpath_split(char  *xpathstr,
     return retval;
 }
 
-/*! Process single xpath expression on xml tree
- * @param[in]  xcur  xml-tree where to search
- * @param[in]  xpath   string with XPATH syntax
+/*! Create a compiled xpath by parsing an xpath expression
+ * @param[in]  xpath  String with XPATH syntax
+ * @retval     xc     Compiled xpath with one reference
+ * @retval     NULL   Error
+ * For example: xpath = //a | //b is parsed into two alternatives, whose
+ * results are concatenated.
+ */
+static struct xpath_compiled *
+xpath_compiled_new(char *xpath)
+{
+    struct xpath_compiled *xc = NULL;
+    struct xpath_element **vec;
+    char                  *s0 = NULL;
+    char                  *s1;
+    char                  *s2;
+
+    if ((xc = malloc(sizeof(*xc))) == NULL){
+	clicon_err(OE_UNIX, errno, "malloc");
+	goto done;
+    }
+    memset(xc, 0, sizeof(*xc));
+    xc->xc_refs = 1;
+    if ((xc->xc_str = strdup(xpath)) == NULL ||
+	(s0 = strdup(xpath)) == NULL){
+	clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
+	goto err;
+    }
+    s1 = s0;
+    while (s1 != NULL){
+	if ((s2 = strstr(s1, " | ")) != NULL){
+	    *s2 = '\0'; /* terminate xpath */
+	    s2 += 3;
+	}
+	if ((vec = realloc(xc->xc_vec, (xc->xc_len+1)*sizeof(*vec))) == NULL){
+	    clicon_err(OE_UNIX, errno, "realloc");
+	    goto err;
+	}
+	xc->xc_vec = vec;
+	if (xpath_parse(s1, &xc->xc_vec[xc->xc_len]) < 0)
+	    goto err;
+	if (debug > 1)
+	    xpath_print(stderr, xc->xc_vec[xc->xc_len]);
+	xc->xc_len++;
+	s1 = s2;
+    }
+ done:
+    if (s0)
+	free(s0);
+    return xc;
+ err:
+    xpath_compiled_free(xc);
+    xc = NULL;
+    goto done;
+}
+
+/*! Release a compiled xpath
+ * The compiled xpath is freed when it is not referenced by the cache or by 
+ * any other user.
+ * @param[in]  xc   Compiled xpath
+ * @see xpath_compile
+ */
+int
+xpath_compiled_free(xpath_compiled *xc)
+{
+    int i;
+
+    if (--xc->xc_refs > 0)
+	return 0;
+    for (i=0; i<xc->xc_len; i++)
+	xpath_free(xc->xc_vec[i]);
+    if (xc->xc_vec)
+	free(xc->xc_vec);
+    if (xc->xc_str)
+	free(xc->xc_str);
+    free(xc);
+    return 0;
+}
+
+/*! Compile an xpath expression, or get it from the cache of compiled xpaths
+ * The XPATH_CACHE_MAX most recently used expressions are kept compiled, so
+ * that xpath_first(), xpath_vec(), etc do not parse the same expression again.
+ * @param[in]  xpath  String with XPATH syntax
+ * @retval     xc     Compiled xpath. Release with xpath_compiled_free()
+ * @retval     NULL   Error
+ * @code
+ *   xpath_compiled *xc;
+ *   if ((xc = xpath_compile("/interfaces/interface[name=eth0]")) == NULL)
+ *      err;
+ *   if (xpath_vec_compiled(xt, xc, 0, &vec, &veclen) < 0)
+ *      err;
+ *   xpath_compiled_free(xc);
+ * @endcode
+ */
+xpath_compiled *
+xpath_compile(char *xpath)
+{
+    struct xpath_compiled *xc = NULL;
+    struct xpath_compiled *xlast;
+    void                  *p;
+
+    if (xpath_cache == NULL && (xpath_cache = hash_init()) == NULL)
+	goto done;
+    if ((p = hash_value(xpath_cache, xpath, NULL)) != NULL){
+	xc = *(struct xpath_compiled **)p;
+	DELQ(xc, xpath_lru, struct xpath_compiled *);
+    }
+    else{
+	if ((xc = xpath_compiled_new(xpath)) == NULL)
+	    goto done;
+	if (hash_add(xpath_cache, xpath, &xc, sizeof(xc)) == NULL){
+	    xpath_compiled_free(xc);
+	    xc = NULL;
+	    goto done;
+	}
+	if (xpath_cache_len == XPATH_CACHE_MAX){ /* Remove least recently used */
+	    xlast = (struct xpath_compiled *)xpath_lru->xc_qelem.q_prev;
+	    DELQ(xlast, xpath_lru, struct xpath_compiled *);
+	    hash_del(xpath_cache, xlast->xc_str);
+	    xpath_compiled_free(xlast);
+	}
+	else
+	    xpath_cache_len++;
+    }
+    INSQ(xc, xpath_lru);
+    xc->xc_refs++;
+ done:
+    return xc;
+}
+
+/*! Process compiled xpath expression on xml tree
+ * @param[in]  xcur    xml-tree where to search
+ * @param[in]  xc      Compiled xpath
  * @param[in]  vec0    vector of XML trees
  * @param[in]  vec0len length of XML trees
  * @param[in]  flags   if != 0, only match xml nodes matching flags
  * @param[out] vec2    Result XML node vector
  * @param[out] vec2len Length of result vector.
+ * Note: if a match is found in several alternatives, two (or more) same 
+ * results will be returned.
  */
 static int
-xpath_exec(cxobj        *xcur, 
-	   char         *xpath, 
-	   cxobj       **vec0, 
-	   size_t        vec0len,
-	   uint16_t      flags,
-	   cxobj      ***vec2, 
-	   size_t       *vec2len)
+xpath_exec(cxobj                 *xcur, 
+	   struct xpath_compiled *xc,
+	   cxobj                **vec0, 
+	   size_t                 vec0len,
+	   uint16_t               flags,
+	   cxobj               ***vec2, 
+	   size_t                *vec2len)
 {
-    struct xpath_element *xplist;
-    cxobj               **vec1;
-    size_t                vec1len;
+    int     retval = -1;
+    cxobj **vec1;
+    size_t  vec1len;
+    int     i;
 
-    if (cxvec_dup(vec0, vec0len, &vec1, &vec1len) < 0)
-	goto done;
-    if (xpath_parse(xpath, &xplist) < 0)
-	goto done;
-    if (debug > 1)
-	xpath_print(stderr, xplist);
-    if (xpath_find(xcur, xplist, 0, vec1, vec1len, flags, vec2, vec2len) < 0)
-	goto done;
-    if (xpath_free(xplist) < 0)
-	goto done;
+    for (i=0; i<xc->xc_len; i++){
+	if (cxvec_dup(vec0, vec0len, &vec1, &vec1len) < 0)
+	    goto done;
+	if (xpath_find(xcur, xc->xc_vec[i], 0, vec1, vec1len, flags, vec2, vec2len) < 0)
+	    goto done;
+    }
+    retval = 0;
   done:
-    return 0;
+    return retval;
 } /* xpath_exec */
 
+/*! A restricted xpath function that returns a vector of matches of a 
+ * compiled xpath (only nodes marked with flags)
+ * @param[in]  xcur    xml-tree where to search
+ * @param[in]  xc      Compiled xpath, see xpath_compile()
+ * @param[in]  flags   Set of flags that return nodes must match (0 if all)
+ * @param[out] vec     vector of xml-trees. Vector must be free():d after use
+ * @param[out] veclen  returns length of vector in return value
+ * @retval     0       OK
+ * @retval     -1      error.
+ * @see xpath_vec_flag
+ */
+int
+xpath_vec_compiled(cxobj          *xcur, 
+		   xpath_compiled *xc,
+		   uint16_t        flags,
+		   cxobj        ***vec, 
+		   size_t         *veclen)
+{
+    int     retval = -1;
+    cxobj **vec0 = NULL;
+
+    *vec = NULL;
+    *veclen = 0;
+    if ((vec0 = calloc(1, sizeof(cxobj *))) == NULL){
+	clicon_err(OE_UNIX, errno, "calloc");
+	goto done;
+    }
+    vec0[0] = xcur;
+    if (xpath_exec(xcur, xc, vec0, 1, flags, vec, veclen) < 0)
+	goto done;
+    retval = 0;
+  done:
+    if (vec0)
+	free(vec0);
+    return retval;
+}
 
 /*! Intermediate xpath function to handle 'conditional' cases. 
  * @param[in]  xcur  xml-tree where to search
@@ -836,11 +1175,8 @@ xpath_exec(cxobj        *xcur,
  * @param[in]  vec1    vector of XML trees
  * @param[in]  vec1len length of XML trees
  * For example: xpath = //a | //b. 
- * xpath_first+ splits xpath up in several subcalls
- * (eg xpath=//a and xpath=//b) and collects the results.
- * Note: if a match is found in both, two (or more) same results will be 
- * returned.
- * Note, this could be 'folded' into xpath1 but I judged it too complex.
+ * The xpath is compiled into several alternatives
+ * (eg xpath=//a and xpath=//b) and the results are collected.
  */
 static int
 xpath_choice(cxobj   *xcur, 
@@ -849,42 +1185,14 @@ xpath_choice(cxobj   *xcur,
 	     cxobj ***vec1, 
 	     size_t  *vec1len)
 {
-    int               retval = -1;
-    char             *s0;
-    char             *s1;
-    char             *s2;
-    char             *xpath;
-    cxobj           **vec0 = NULL;
-    size_t            vec0len = 0;
-
-    if ((s0 = strdup(xpath0)) == NULL){
-	clicon_err(OE_XML, errno, "%s: strdup", __FUNCTION__);
-	goto done;
-    }
-    s2 = s1 = s0;
-    if ((vec0 = calloc(1, sizeof(cxobj *))) == NULL){
-	clicon_err(OE_UNIX, errno, "calloc");
+    int             retval = -1;
+    xpath_compiled *xc;
+
+    if ((xc = xpath_compile(xpath0)) == NULL)
 	goto done;
-    }
-    vec0[0] = xcur;
-    vec0len++;
-    while (s1 != NULL){
-	s2 = strstr(s1, " | ");
-	if (s2 != NULL){
-	    *s2 = '\0'; /* terminate xpath */
-	    s2 += 3;
-	}
-	xpath = s1;
-	s1 = s2;
-	if (xpath_exec(xcur, xpath, vec0, vec0len, flags, vec1, vec1len) < 0)
-	    goto done;
-    }
-    retval = 0;
+    retval = xpath_vec_compiled(xcur, xc, flags, vec1, vec1len);
+    xpath_compiled_free(xc);
   done:
-    if (s0)
-	free(s0);
-    if (vec0)
-	free(vec0);
     return retval;
 }
 
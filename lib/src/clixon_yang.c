@@ -66,6 +66,7 @@
 #include "clixon_file.h"
 #include "clixon_yang.h"
 #include "clixon_hash.h"
+#include "clixon_xml.h"
 #include "clixon_plugin.h"
 #include "clixon_options.h"
 #include "clixon_yang_type.h"
@@ -177,6 +178,7 @@ ys_new(enum rfc_6020 keyw)
     }
     memset(ys, 0, sizeof(*ys));
     ys->ys_keyword    = keyw;
+    ys->ys_order      = -1;
     /* The cvec contains stmt-specific variables. Only few stmts need variables so the
        cvec could be lazily created to save some heap and cycles. */
     if ((ys->ys_cvec = cvec_new(0)) == NULL){ 
@@ -263,6 +265,7 @@ ys_cp(yang_stmt *ynew,
 
     memcpy(ynew, yold, sizeof(*yold)); 
     ynew->ys_parent = NULL;
+    ynew->ys_order = -1;
     if (yold->ys_stmt)
 	if ((ynew->ys_stmt = calloc(yold->ys_len, sizeof(yang_stmt *))) == NULL){
 	    clicon_err(OE_YANG, errno, "%s: calloc", __FUNCTION__);
@@ -339,6 +342,7 @@ yn_insert(yang_node *yn_parent,
 	return -1;
     yn_parent->yn_stmt[pos] = ys_child;
     ys_child->ys_parent = yn_parent;
+    ys_child->ys_order = -1; /* Appended last: order of siblings unchanged */
     return 0;
 }
 
@@ -557,6 +561,8 @@ yang_find_myprefix(yang_stmt *ys)
 }
 
 /*! Find matching y in yp:s children, return 0 and index or -1 if not found.
+ * Data nodes in choices and cases are counted as children of yp, since they
+ * are siblings in xml.
  * @retval 0 not found
  * @retval 1 found
  */
@@ -570,6 +576,11 @@ order1(yang_node *yp,
     
     for (i=0; i<yp->yn_len; i++){
 	ys = yp->yn_stmt[i];
+	if (ys->ys_keyword == Y_CHOICE || ys->ys_keyword == Y_CASE){
+	    if (order1((yang_node*)ys, y, index) == 1)
+		return 1;
+	    continue;
+	}
 	if (!yang_datanode(ys))
 	    continue;
 	if (ys==y)
@@ -580,8 +591,12 @@ order1(yang_node *yp,
 }
 
 /*! Return order of yang statement y in parents child vector
+ * Only data nodes are counted. Top-level data nodes are ordered across all
+ * (sub)modules of the yang spec.
  * @retval  i  Order of child with specified argument
  * @retval -1  Not found
+ * @note Data nodes have their order cached when the spec is loaded, see
+ *       yang_order_populate(), otherwise it is computed here.
  */
 int
 yang_order(yang_stmt *y)
@@ -592,7 +607,11 @@ yang_order(yang_stmt *y)
     int         i;
     int         j=0;
     
+    if (y->ys_order >= 0)
+	return y->ys_order;
     yp = y->ys_parent;
+    while (yp->yn_keyword == Y_CHOICE || yp->yn_keyword == Y_CASE)
+	yp = yp->yn_parent;
     if (yp->yn_keyword == Y_MODULE ||yp->yn_keyword == Y_SUBMODULE){
 	ypp = yp->yn_parent;
 	for (i=0; i<ypp->yn_len; i++){
@@ -605,6 +624,63 @@ yang_order(yang_stmt *y)
     return j;
 }
 
+/*! Number data node children of a yang statement, including those in 
+ * choices and cases, see order1()
+ * @param[in]     ys   Yang statement, its children are numbered
+ * @param[in,out] j    Next order
+ */
+static void
+ys_order_populate1(yang_stmt *ys,
+		   int       *j)
+{
+    yang_stmt *yc;
+    int        i;
+
+    for (i=0; i<ys->ys_len; i++){
+	yc = ys->ys_stmt[i];
+	if (yc->ys_keyword == Y_CHOICE || yc->ys_keyword == Y_CASE)
+	    ys_order_populate1(yc, j);
+	else if (yang_datanode(yc))
+	    yc->ys_order = (*j)++;
+    }
+}
+
+/*! Cache order of data node children of a non-top-level yang statement
+ * @param[in]  ys   Yang statement, its children are numbered
+ * @param[in]  arg  Dummy so it can be called by yang_apply()
+ * @see yang_order_populate
+ */
+static int
+ys_order_populate(yang_stmt *ys,
+		  void      *arg)
+{
+    int j = 0;
+
+    if (ys->ys_keyword == Y_MODULE || ys->ys_keyword == Y_SUBMODULE)
+	return 0; /* Top-level, see yang_order_populate */
+    if (ys->ys_keyword == Y_CHOICE || ys->ys_keyword == Y_CASE)
+	return 0; /* Numbered with the parent */
+    ys_order_populate1(ys, &j);
+    return 0;
+}
+
+/*! Compute and cache yang_order() of all data nodes in a yang spec
+ * Must be called when the spec has been modified, ie after expansion and
+ * augmentation.
+ * @param[in]  ysp  Yang specification
+ * @see yang_order
+ */
+static int
+yang_order_populate(yang_spec *ysp)
+{
+    int        i;
+    int        j = 0;
+
+    for (i=0; i<ysp->yp_len; i++) /* Top-level: numbered across modules */
+	ys_order_populate1(ysp->yp_stmt[i], &j);
+    return yang_apply((yang_node*)ysp, -1, ys_order_populate, NULL);
+}
+
 /*! Reset flag in complete tree, arg contains flag */
 static int
 ys_flag_reset(yang_stmt *ys, 
@@ -1718,7 +1794,7 @@ yang_parse(clicon_handle h,
 	goto done;
     yang_apply((yang_node*)ymod, -1, ys_flag_reset, (void*)YANG_FLAG_MARK);
 
-    /* Step 4: Top-level augmentation of all modules */
+    /* Step 5: Top-level augmentation of all modules */
     if (yang_augment_spec(ysp) < 0)
 	goto done;
 
@@ -1726,6 +1802,14 @@ yang_parse(clicon_handle h,
     if (yang_apply((yang_node*)ysp, -1, ys_schemanode_check, NULL) < 0)
 	goto done;
 
+    /* Step 6: Cache data node order now that the tree is complete */
+    if (yang_order_populate(ysp) < 0)
+	goto done;
+
+    /* Step 7: Share names of schema nodes between xml nodes */
+    if (xml_name_intern_yang(ysp) < 0)
+	goto done;
+
     retval = 0;
   done:
     return retval;
@@ -107,6 +107,347 @@ yang_builtin(char *type)
     return 0;
 }
 
+/* XSD character categories \p{X} as POSIX character classes, ASCII only */
+static const struct {
+    char *xc_category;
+    char *xc_class;
+} xsd_categories[] = {
+    {"L",  "[:alpha:]"},
+    {"Lu", "[:upper:]"},
+    {"Ll", "[:lower:]"},
+    {"N",  "[:digit:]"},
+    {"Nd", "[:digit:]"},
+    {"P",  "[:punct:]"},
+    {"Z",  "[:space:]"},
+    {"C",  "[:cntrl:]"},
+    {"Cc", "[:cntrl:]"},
+    {NULL, NULL}
+};
+
+/*! Translate a YANG (XSD) class escape to a POSIX bracket expression body
+ * @param[in,out] pp   Pattern after the backslash. Advanced past the escape
+ * @param[out]    neg  Set if the escape is negated, eg \D or \P{L}
+ * @retval        str  Bracket expression body, any '-' is last
+ * @retval        NULL Not a class escape or unknown category
+ * XSD classes are restricted to ASCII here, eg \w is [[:alnum:]]
+ */
+static char *
+xsd_class_escape(char **pp,
+		 int   *neg)
+{
+    char *p = *pp;
+    char *body = NULL;
+    char *end;
+    char  c = *p++;
+    int   i;
+
+    *neg = isupper(c);
+    switch (tolower(c)){
+    case 'd':
+	body = "0-9";
+	break;
+    case 's':
+	body = " \t\n\r";
+	break;
+    case 'w':
+	body = "[:alnum:]";
+	break;
+    case 'i':
+	body = "_:A-Za-z";
+	break;
+    case 'c':
+	body = "._:A-Za-z0-9-";
+	break;
+    case 'p':
+	if (*p != '{' || (end = strchr(p, '}')) == NULL)
+	    break;
+	p++;
+	for (i=0; xsd_categories[i].xc_category; i++)
+	    if (strlen(xsd_categories[i].xc_category) == end-p &&
+		strncmp(xsd_categories[i].xc_category, p, end-p) == 0){
+		body = xsd_categories[i].xc_class;
+		break;
+	    }
+	p = end+1;
+	break;
+    }
+    if (body)
+	*pp = p;
+    return body;
+}
+
+/*! Translate a YANG (XSD) character class to a POSIX bracket expression
+ * POSIX brackets have no escapes: ']' must come first, '-' last and '^' not
+ * first, so those are collected and placed accordingly.
+ * @param[in]  xsd   Pattern, pointing at the opening '['
+ * @param[out] cb    Translated bracket expression is appended here
+ * @retval     n     Characters of xsd consumed
+ * @retval     0     Not supported, eg class subtraction
+ */
+static int
+xsd_class2posix(char *xsd,
+		cbuf *cb)
+{
+    char *p = xsd+1;
+    char *esc;
+    int   neg = 0;
+    int   rbracket = 0;
+    int   lbracket = 0;
+    int   caret = 0;
+    int   dash = 0;
+    int   eneg;
+    int   len;
+    char  c;
+    cbuf *cbody = NULL;
+    int   retval = 0;
+
+    if ((cbody = cbuf_new()) == NULL)
+	goto done;
+    if (*p == '^'){
+	neg++;
+	p++;
+    }
+    while (*p != ']'){
+	if ((c = *p++) == '\0')
+	    goto done;
+	if (c == '-' && *p == '[')        /* class subtraction */
+	    goto done;
+	if (c == '\\'){
+	    if ((esc = xsd_class_escape(&p, &eneg)) != NULL){
+		if (eneg)     /* negated class within a class */
+		    goto done;
+		len = strlen(esc);
+		if (esc[len-1] == '-'){
+		    dash++;
+		    len--;
+		}
+		cprintf(cbody, "%.*s", len, esc);
+		continue;
+	    }
+	    if ((c = *p++) == '\0')
+		goto done;
+	    switch (c){
+	    case 'n': c = '\n'; break;
+	    case 'r': c = '\r'; break;
+	    case 't': c = '\t'; break;
+	    case '\\': case '|': case '.': case '-': case '^': case '?': 
+	    case '*': case '+': case '{': case '}': case '(': case ')': 
+	    case '[': case ']': case '$':
+		break;
+	    default:
+		goto done;
+	    }
+	}
+	else if (c == '[')
+	    goto done;
+	if (*p == '-' && p[1] != ']' && p[1] != '['){ /* range */
+	    if (c == ']' || c == '^' || c == '-' || c == '[' ||
+		p[1] == '\\' || p[1] == '\0')
+		goto done;
+	    cprintf(cbody, "%c-%c", c, p[1]);
+	    p += 2;
+	    continue;
+	}
+	switch (c){
+	case ']': rbracket++; break;
+	case '[': lbracket++; break;
+	case '^': caret++; break;
+	case '-': dash++; break;
+	default:
+	    cprintf(cbody, "%c", c);
+	    break;
+	}
+    }
+    if (!rbracket && cbuf_len(cbody) == 0 && !lbracket && !dash){
+	if (neg || !caret)    /* [^] or [] */
+	    goto done;
+	cprintf(cb, "\\^");
+    }
+    else
+	cprintf(cb, "[%s%s%s%s%s%s]", neg?"^":"", rbracket?"]":"", cbuf_get(cbody),
+		caret?"^":"", lbracket?"[":"", dash?"-":"");
+    retval = p + 1 - xsd;
+ done:
+    if (cbody)
+	cbuf_free(cbody);
+    return retval;
+}
+
+/*! Translate a YANG pattern (XSD regular expression) to POSIX extended regex
+ * XSD patterns are implicitly anchored and have no '^' or '$' anchors. The
+ * multi-character escapes \d, \s, \w, \i, \c, some categories \p{X} and
+ * their negations are mapped to bracket expressions.
+ * @param[in]  xsd   YANG pattern argument
+ * @param[out] cb    POSIX extended regular expression, anchored
+ * @retval     1     OK
+ * @retval     0     Pattern not supported
+ */
+static int
+yang_pattern2posix(char *xsd,
+		   cbuf *cb)
+{
+    char *p = xsd;
+    char *esc;
+    int   eneg;
+    char  c;
+    int   n;
+
+    cprintf(cb, "^(");
+    while ((c = *p++) != '\0'){
+	switch (c){
+	case '\\':
+	    if ((esc = xsd_class_escape(&p, &eneg)) != NULL){
+		cprintf(cb, "[%s%s]", eneg?"^":"", esc);
+		break;
+	    }
+	    if ((c = *p++) == '\0')
+		return 0;
+	    switch (c){
+	    case 'n': cprintf(cb, "\n"); break;
+	    case 'r': cprintf(cb, "\r"); break;
+	    case 't': cprintf(cb, "\t"); break;
+	    case '-': case ']': case '}':
+		cprintf(cb, "%c", c);
+		break;
+	    case '\\': case '|': case '.': case '^': case '?': case '*': 
+	    case '+': case '{': case '(': case ')': case '[': case '$':
+		cprintf(cb, "\\%c", c);
+		break;
+	    default:
+		return 0;
+	    }
+	    break;
+	case '^':
+	case '$':
+	    cprintf(cb, "\\%c", c);
+	    break;
+	case '[':
+	    if ((n = xsd_class2posix(p-1, cb)) == 0)
+		return 0;
+	    p += n-1;
+	    break;
+	default:
+	    cprintf(cb, "%c", c);
+	    break;
+	}
+    }
+    cprintf(cb, ")$");
+    return 1;
+}
+
+/*! Compile all patterns of a type cache to POSIX regular expressions
+ * If any of the patterns cannot be translated or compiled, none is cached,
+ * and values are matched with match_regexp() at validation time instead, see
+ * yang_type_cache_match().
+ * @param[in]  ycache  Type cache with yc_patterns set
+ * @retval     0       OK (also if not compiled)
+ * @retval    -1       Error
+ */
+static int
+yang_type_cache_regcomp(yang_type_cache *ycache)
+{
+    int      retval = -1;
+    regex_t *re = NULL;
+    cbuf    *cb = NULL;
+    char    *pattern;
+    int      len;
+    int      i = 0;
+
+    if ((len = cvec_len(ycache->yc_patterns)) == 0)
+	return 0;
+    if ((re = calloc(len, sizeof(regex_t))) == NULL){
+	clicon_err(OE_UNIX, errno, "calloc");
+	goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+	clicon_err(OE_UNIX, errno, "cbuf_new");
+	goto done;
+    }
+    for (i=0; i<len; i++){
+	pattern = cv_string_get(cvec_i(ycache->yc_patterns, i));
+	cbuf_reset(cb);
+	if (yang_pattern2posix(pattern, cb) == 0 ||
+	    regcomp(&re[i], cbuf_get(cb), REG_EXTENDED|REG_NOSUB) != 0){
+	    clicon_debug(1, "%s: pattern not compiled: %s", __FUNCTION__, pattern);
+	    break;
+	}
+    }
+    if (i == len){
+	ycache->yc_regex = re;
+	re = NULL;
+    }
+    retval = 0;
+ done:
+    if (re){
+	while (i-- > 0)
+	    regfree(&re[i]);
+	free(re);
+    }
+    if (cb)
+	cbuf_free(cb);
+    return retval;
+}
+
+/*! Match a string against all compiled patterns of a type cache
+ * @param[in]  ycache   Type cache with yc_regex set
+ * @param[in]  str      String to match
+ * @param[out] pattern  Pattern that did not match
+ * @retval     1        Match all patterns
+ * @retval     0        No match
+ * @retval    -1        Error
+ */
+static int
+yang_type_cache_regexec(yang_type_cache *ycache,
+			char            *str,
+			char           **pattern)
+{
+    regex_t *re = (regex_t *)ycache->yc_regex;
+    int      i;
+    int      ret;
+
+    for (i=0; i<cvec_len(ycache->yc_patterns); i++){
+	if ((ret = regexec(&re[i], str, 0, NULL, 0)) == 0)
+	    continue;
+	*pattern = cv_string_get(cvec_i(ycache->yc_patterns, i));
+	if (ret == REG_NOMATCH)
+	    return 0;
+	clicon_err(OE_DB, 0, "regexec: %s", *pattern);
+	return -1;
+    }
+    return 1;
+}
+
+/*! Match a string against all patterns of a type cache, not compiled
+ * Used if some pattern could not be translated to a POSIX regular expression,
+ * see yang_type_cache_regcomp(). All patterns of the type and the types it is
+ * derived from are checked, as with compiled patterns.
+ * @param[in]  ycache   Type cache with yc_patterns set
+ * @param[in]  str      String to match
+ * @param[out] pattern  Pattern that did not match
+ * @retval     1        Match all patterns
+ * @retval     0        No match
+ * @retval    -1        Error
+ */
+static int
+yang_type_cache_match(yang_type_cache *ycache,
+		      char            *str,
+		      char           **pattern)
+{
+    int i;
+    int ret;
+
+    for (i=0; i<cvec_len(ycache->yc_patterns); i++){
+	*pattern = cv_string_get(cvec_i(ycache->yc_patterns, i));
+	if ((ret = match_regexp(str, *pattern)) < 0){
+	    clicon_err(OE_DB, 0, "match_regexp: %s", *pattern);
+	    return -1;
+	}
+	if (ret == 0)
+	    return 0;
+    }
+    return 1;
+}
+
 /*! Set type cache for yang type
  */
 int
@@ -188,6 +529,15 @@ yang_type_cache_cp(yang_type_cache **ycnew,
     yang_type_cache_get(ycold, &resolved, &options, &mincv, &maxcv, &pattern, &fraction);
     if (yang_type_cache_set(ycnew, resolved, options, mincv, maxcv, pattern, fraction) < 0)
 	goto done;
+    if (ycold->yc_patterns){
+	if (((*ycnew)->yc_patterns = cvec_dup(ycold->yc_patterns)) == NULL){
+	    clicon_err(OE_UNIX, errno, "cvec_dup");
+	    goto done;
+	}
+	/* regex_t cannot be copied */
+	if (ycold->yc_regex && yang_type_cache_regcomp(*ycnew) < 0)
+	    goto done;
+    }
     retval = 0;
  done:
     return retval;
@@ -196,16 +546,28 @@ yang_type_cache_cp(yang_type_cache **ycnew,
 int
 yang_type_cache_free(yang_type_cache *ycache)
 {
+    int i;
+
     if (ycache->yc_mincv)
 	cv_free(ycache->yc_mincv);
     if (ycache->yc_maxcv)
 	cv_free(ycache->yc_maxcv);
     if (ycache->yc_pattern)
 	free(ycache->yc_pattern);
+    if (ycache->yc_regex){
+	for (i=0; i<cvec_len(ycache->yc_patterns); i++)
+	    regfree(&((regex_t *)ycache->yc_regex)[i]);
+	free(ycache->yc_regex);
+    }
+    if (ycache->yc_patterns)
+	cvec_free(ycache->yc_patterns);
     free(ycache);
     return 0;
 }
 
+/* Forward */
+static int yang_type_patterns(yang_stmt *ys, yang_stmt *ytype, cvec *patterns);
+
 /*! Resolve types: populate type caches 
  * @param[in]  ys  This is a type statement
  * @param[in]  arg Not used
@@ -234,10 +596,23 @@ ys_resolve_type(yang_stmt *ys,
     /* skip unions since they may have different sets of options, mincv, etc 
      * You would have to resolve all sub-types also recursively
      */
-    else
+    else{
 	if (yang_type_cache_set(&ys->ys_typecache, 
 				resolved, options, mincv, maxcv, pattern, fraction) < 0)
 	    goto done;
+	/* Values must match the patterns of all derived types, compile them once */
+	if ((options & YANG_OPTIONS_PATTERN) != 0){
+	    if ((ys->ys_typecache->yc_patterns = cvec_new(0)) == NULL){
+		clicon_err(OE_UNIX, errno, "cvec_new");
+		goto done;
+	    }
+	    if (yang_type_patterns((yang_stmt*)ys->ys_parent, ys, 
+				   ys->ys_typecache->yc_patterns) < 0)
+		goto done;
+	    if (yang_type_cache_regcomp(ys->ys_typecache) < 0)
+		goto done;
+	}
+    }
     retval = 0;
  done:
     return retval;
@@ -380,6 +755,8 @@ clicon_type2cv(char         *origtype,
 
 
 /*!
+ * @param[in]  ycache  Type cache of the type statement, with compiled patterns
+ *                     if any. If NULL, pattern is compiled on each call.
  * @retval -1  Error (fatal), with errno set to indicate error
  * @retval 0   Validation not OK, malloced reason is returned. Free reason with free()
  * @retval 1   Validation OK
@@ -391,6 +768,7 @@ cv_validate1(cg_var      *cv,
 	     cg_var      *range_min,
 	     cg_var      *range_max, 
 	     char        *pattern,
+	     yang_type_cache *ycache,
 	     yang_stmt   *yrestype,
 	     char        *restype,
 	     char       **reason)
@@ -537,7 +915,16 @@ cv_validate1(cg_var      *cv,
 	    }
 	}
 	if ((options & YANG_OPTIONS_PATTERN) != 0){
-	    if ((retval2 = match_regexp(str, pattern)) < 0){
+	    if (ycache && ycache->yc_regex){
+		if ((retval2 = yang_type_cache_regexec(ycache, str, &pattern)) < 0)
+		    return -1;
+	    }
+	    else if (ycache && ycache->yc_patterns &&
+		     cvec_len(ycache->yc_patterns)){
+		if ((retval2 = yang_type_cache_match(ycache, str, &pattern)) < 0)
+		    return -1;
+	    }
+	    else if ((retval2 = match_regexp(str, pattern)) < 0){
 		clicon_err(OE_DB, 0, "match_regexp: %s", pattern);
 		return -1;
 	    }
@@ -625,7 +1012,8 @@ ys_cv_validate_union_one(yang_stmt *ys,
 	    goto done;
 	}
 	if ((retval = cv_validate1(cvt, cvtype, options, range_min, range_max, 
-				   pattern, yrt, restype, reason)) < 0)
+				   pattern, yt->ys_typecache, yrt, restype, 
+				   reason)) < 0)
 	    goto done;
     }
  done:
@@ -685,6 +1073,7 @@ ys_cv_validate(cg_var    *cv,
     char           *pattern = NULL;
     enum cv_type    cvtype;
     char           *type;  /* orig type */
+    yang_stmt      *ytype;    /* type statement */
     yang_stmt      *yrestype; /* resolved type */
     char           *restype;
     uint8_t         fraction = 0; 
@@ -725,10 +1114,12 @@ ys_cv_validate(cg_var    *cv,
 	    goto done;
 	retval = retval2; /* invalid (0) with latest reason or valid 1 */
     }
-    else
+    else{
+	ytype = yang_find((yang_node*)ys, Y_TYPE, NULL);
 	if ((retval = cv_validate1(cv, cvtype, options, range_min, range_max, pattern,
-				yrestype, restype, reason)) < 0)
+				   ytype->ys_typecache, yrestype, restype, reason)) < 0)
 	    goto done;
+    }
   done:
     if (cvt)
 	cv_free(cvt);
@@ -862,6 +1253,103 @@ resolve_restrictions(yang_stmt   *yrange,
     return 0;
 }
 
+/*! Find the typedef of a derived type
+ * @param[in,out] ys        yang-stmt from where the search is based. If the
+ *                          typedef is found upwards in the hierarchy, the
+ *                          statement where it was found.
+ * @param[in]     type      Type name without prefix
+ * @param[in]     prefix    Type prefix or NULL
+ * @param[out]    ytypedef  Typedef statement, or NULL if not resolved
+ * @retval        0         OK
+ * @retval       -1         Error, clicon_err handles errors
+ */
+static int
+ytype_typedef(yang_stmt **ys0,
+	      char       *type,
+	      char       *prefix,
+	      yang_stmt **ytypedef)
+{
+    yang_stmt *ys = *ys0;
+    yang_stmt *ymod;
+    yang_node *yn;
+
+    *ytypedef = NULL;
+    if (prefix){ /* Go to top and find import that matches */
+	if ((ymod = yang_find_module_by_prefix(ys, prefix)) == NULL){
+	    clicon_err(OE_DB, 0, "Type not resolved: %s:%s", prefix, type);
+	    return -1;
+	}
+	*ytypedef = yang_find((yang_node*)ymod, Y_TYPEDEF, type);
+	return 0;
+    }
+    while (1){
+	/* Check upwards in hierarchy for matching typedefs */
+	if ((ys = ys_typedef_up(ys)) == NULL) /* If reach top */
+	    break;
+	/* Here find typedef */
+	if ((*ytypedef = yang_find((yang_node*)ys, Y_TYPEDEF, type)) != NULL)
+	    break;
+	/* Did not find a matching typedef there, proceed to next level */
+	yn = ys->ys_parent;
+	if (yn && yn->yn_keyword == Y_SPEC)
+	    yn = NULL;
+	ys = (yang_stmt*)yn;
+    }
+    *ys0 = ys;
+    return 0;
+}
+
+/*! Collect the patterns of a type and of all typedefs it is derived from
+ * A value must match all of them, see RFC 6020 Sec 9.4.6.
+ * @param[in]  ys        yang-stmt from where the current search is based
+ * @param[in]  ytype     yang-stmt object containing currently resolving type
+ * @param[out] patterns  Pattern strings are added to this vector
+ * @retval     0         OK
+ * @retval    -1         Error, clicon_err handles errors
+ */
+static int
+yang_type_patterns(yang_stmt *ys,
+		   yang_stmt *ytype,
+		   cvec      *patterns)
+{
+    int        retval = -1;
+    yang_stmt *yp = NULL;
+    yang_stmt *rytypedef;
+    yang_stmt *rytype;
+    cg_var    *cv;
+    char      *type;
+    char      *prefix = NULL;
+
+    while ((yp = yn_each((yang_node*)ytype, yp)) != NULL){
+	if (yp->ys_keyword != Y_PATTERN)
+	    continue;
+	if ((cv = cvec_add(patterns, CGV_STRING)) == NULL){
+	    clicon_err(OE_UNIX, errno, "cvec_add");
+	    goto done;
+	}
+	if (cv_string_set(cv, yp->ys_argument) == NULL){
+	    clicon_err(OE_UNIX, errno, "cv_string_set");
+	    goto done;
+	}
+    }
+    type   = ytype_id(ytype);
+    prefix = ytype_prefix(ytype);
+    if (prefix == NULL && yang_builtin(type))
+	goto ok;
+    if (ytype_typedef(&ys, type, prefix, &rytypedef) < 0)
+	goto done;
+    if (rytypedef != NULL &&
+	(rytype = yang_find((yang_node*)rytypedef, Y_TYPE, NULL)) != NULL)
+	if (yang_type_patterns(ys, rytype, patterns) < 0)
+	    goto done;
+ ok:
+    retval = 0;
+ done:
+    if (prefix)
+	free(prefix);
+    return retval;
+}
+
 /*! Recursively resolve a yang type to built-in type with optional restrictions
  * @param [in]  ys       yang-stmt from where the current search is based
  * @param [in]  ytype    yang-stmt object containing currently resolving type
@@ -899,8 +1387,6 @@ yang_type_resolve(yang_stmt   *ys,
     char        *type;
     char        *prefix = NULL;
     int          retval = -1;
-    yang_node   *yn;
-    yang_stmt   *ymod;
 
     if (options)
 	*options = 0x0;
@@ -927,31 +1413,9 @@ yang_type_resolve(yang_stmt   *ys,
 	goto ok;
     }
 
-    /* Not basic type. Now check if prefix which means we look in other module */
-    if (prefix){ /* Go to top and find import that matches */
-	if ((ymod = yang_find_module_by_prefix(ys, prefix)) == NULL){
-	    clicon_err(OE_DB, 0, "Type not resolved: %s:%s", prefix, type);
-	    goto done;
-	}
-	if ((rytypedef = yang_find((yang_node*)ymod, Y_TYPEDEF, type)) == NULL)
-	    goto ok; /* unresolved */
-    }
-    else
-	while (1){
-	    /* Check upwards in hierarchy for matching typedefs */
-	    if ((ys = ys_typedef_up(ys)) == NULL){ /* If reach top */
-		*yrestype = NULL;
-		break;
-	    }
-	    /* Here find typedef */
-	    if ((rytypedef = yang_find((yang_node*)ys, Y_TYPEDEF, type)) != NULL)
-		break;
-	    /* Did not find a matching typedef there, proceed to next level */
-	    yn = ys->ys_parent;
-	    if (yn && yn->yn_keyword == Y_SPEC)
-		yn = NULL;
-	    ys = (yang_stmt*)yn;
-	}
+    /* Not basic type. Find typedef, possibly in other module */
+    if (ytype_typedef(&ys, type, prefix, &rytypedef) < 0)
+	goto done;
     if (rytypedef != NULL){     /* We have found a typedef */
 	/* Find associated type statement */
 	if ((rytype = yang_find((yang_node*)rytypedef, Y_TYPE, NULL)) == NULL){
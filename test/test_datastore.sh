@@ -156,8 +156,83 @@ run(){
     rm -rf $mydir
 }
 
+# Text datastore with edit journal: edits are appended to a journal and
+# replayed on read until the datastore file is rewritten.
+journal(){
+    mydir=$dir/journal
+    if [ -d $mydir ]; then
+	rm -rf $mydir/*
+    else
+	mkdir $mydir
+    fi
+    conf="-d candidate -b $mydir -p ../datastore/text/text.so -y $dir -m ietf-ip"
+
+    new "datastore journal init"
+    expectfn "$datastore $conf init" ""
+
+    new "datastore journal put all replace"
+    expectfn "$datastore $conf -j put replace $db" ""
+
+    new "datastore journal file exists"
+    if [ ! -s $mydir/candidate_db.journal ]; then
+	err "$mydir/candidate_db.journal"
+    fi
+
+    new "datastore journal get"
+    expectfn "$datastore $conf get /" "^$db$"
+
+    new "datastore journal put leaf merge"
+    expectfn "$datastore $conf -j put merge <config><x><g>journal</g></x></config>" ""
+
+    new "datastore journal get leaf"
+    expectfn "$datastore $conf get /x/g" "^<config><x><g>journal</g></x></config>$"
+
+    new "datastore journal incomplete record"
+    printf '100 merge\n<config><x>' >> $mydir/candidate_db.journal
+    expectfn "$datastore $conf get /x/g" "^<config><x><g>journal</g></x></config>$"
+
+    new "datastore journal incomplete record removed"
+    if [ -n "$(tail -c 8 $mydir/candidate_db.journal | grep '<x>')" ]; then
+	err "no incomplete record"
+    fi
+
+    new "datastore journal malformed record"
+    cp $mydir/candidate_db.journal $mydir/journal.save
+    printf '8 kalle\n<config/>\n' >> $mydir/candidate_db.journal
+    ret=$($datastore $conf get /x/g 2>&1)
+    if [ -z "$(echo "$ret" | grep 'malformed record')" ]; then
+	err "malformed record" "$ret"
+    fi
+
+    new "datastore journal malformed record kept"
+    if [ -z "$(tail -c 20 $mydir/candidate_db.journal | grep kalle)" ]; then
+	err "malformed record kept"
+    fi
+    mv $mydir/journal.save $mydir/candidate_db.journal
+
+    new "datastore journal copy"
+    expectfn "$datastore $conf copy kalle" ""
+
+    new "datastore journal get copy"
+    expectfn "$datastore -d kalle -b $mydir -p ../datastore/text/text.so -y $dir -m ietf-ip get /x/g" "^<config><x><g>journal</g></x></config>$"
+
+    new "datastore put without journal"
+    expectfn "$datastore $conf put merge <config><x><g>nojournal</g></x></config>" ""
+
+    new "datastore journal removed"
+    if [ -f $mydir/candidate_db.journal ]; then
+	err "no $mydir/candidate_db.journal"
+    fi
+
+    new "datastore get after journal"
+    expectfn "$datastore $conf get /x/g" "^<config><x><g>nojournal</g></x></config>$"
+
+    rm -rf $mydir
+}
+
 #run keyvalue # cant get the put to work
 run text
+journal
 
 rm -rf $dir
 
@@ -43,6 +43,15 @@ new "netconf tests"
 
 expecteof "$clixon_netconf -qf $cfg" '<rpc message-id="101"><get-config><source><candidate/></source></get-config></rpc>]]>]]>' '^<rpc-reply message-id="101"><data/></rpc-reply>]]>]]>$'
 
+new "netconf get-config reply with all rpc attributes"
+expecteof "$clixon_netconf -qf $cfg" '<rpc message-id="102" user="me"><get-config><source><candidate/></source></get-config></rpc>]]>]]>' '^<rpc-reply message-id="102" user="me"><data/></rpc-reply>]]>]]>$'
+
+new "netconf hello base:1.1 and chunked framing"
+expecteof "$clixon_netconf -f $cfg" "$(printf '<hello><capabilities><capability>urn:ietf:params:netconf:base:1.1</capability></capabilities></hello>]]>]]>\n#82\n<rpc message-id="101"><get-config><source><candidate/></source></get-config></rpc>\n##\n')" '^<rpc-reply message-id="101"><data/></rpc-reply>$'
+
+new "netconf chunked framing in several chunks"
+expecteof "$clixon_netconf -f $cfg" "$(printf '<hello><capabilities><capability>urn:ietf:params:netconf:base:1.1</capability></capabilities></hello>]]>]]>\n#4\n<rpc\n#78\n message-id="101"><get-config><source><candidate/></source></get-config></rpc>\n##\n')" '^<rpc-reply message-id="101"><data/></rpc-reply>$'
+
 new "Add subtree eth/0/0 using none which should not change anything"
 expecteof "$clixon_netconf -qf $cfg" "<rpc><edit-config><default-operation>none</default-operation><target><candidate/></target><config><interfaces><interface><name>eth/0/0</name></interface></interfaces></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
 
@@ -76,6 +85,15 @@ expecteof "$clixon_netconf -qf $cfg" '<rpc><get-config><source><candidate/></sou
 new "netconf get config xpath parent"
 expecteof "$clixon_netconf -qf $cfg" '<rpc><get-config><source><candidate/></source><filter type="xpath" select="/interfaces/interface[name=eth1]/enabled/../.."/></get-config></rpc>]]>]]>' "^<rpc-reply><data><interfaces><interface><name>eth/0/0</name><enabled>true</enabled></interface><interface><name>eth1</name><enabled>true</enabled><ipv4><enabled>true</enabled><forwarding>false</forwarding><address><ip>9.2.3.4</ip><prefix-length>24</prefix-length></address></ipv4></interface></interfaces></data></rpc-reply>]]>]]>$"
 
+new "netconf get config subtree"
+expecteof "$clixon_netconf -qf $cfg" '<rpc><get-config><source><candidate/></source><filter type="subtree"><interfaces><interface><name>eth1</name><enabled/></interface></interfaces></filter></get-config></rpc>]]>]]>' "^<rpc-reply><data><interfaces><interface><name>eth1</name><enabled>true</enabled></interface></interfaces></data></rpc-reply>]]>]]>$"
+
+new "netconf get config subtree content match"
+expecteof "$clixon_netconf -qf $cfg" '<rpc><get-config><source><candidate/></source><filter type="subtree"><interfaces><interface><name>eth/0/0</name></interface></interfaces></filter></get-config></rpc>]]>]]>' "^<rpc-reply><data><interfaces><interface><name>eth/0/0</name><enabled>true</enabled></interface></interfaces></data></rpc-reply>]]>]]>$"
+
+new "netconf get config subtree no match"
+expecteof "$clixon_netconf -qf $cfg" '<rpc><get-config><source><candidate/></source><filter type="subtree"><interfaces><interface><name>eth9</name></interface></interfaces></filter></get-config></rpc>]]>]]>' "^<rpc-reply><data/></rpc-reply>]]>]]>$"
+
 new "netconf validate missing type"
 expecteof "$clixon_netconf -qf $cfg" "<rpc><validate><source><candidate/></source></validate></rpc>]]>]]>" "^<rpc-reply><rpc-error>"
 
@@ -115,6 +133,16 @@ expecteof "$clixon_netconf -qf $cfg" "<rpc><edit-config><target><candidate/></ta
 new "netconf get state operation"
 expecteof "$clixon_netconf -qf $cfg" "<rpc><get><filter type=\"xpath\" select=\"/interfaces-state\"/></get></rpc>]]>]]>" "^<rpc-reply><data><interfaces-state><interface><name>eth0</name><type>eth</type><if-index>42</if-index></interface></interfaces-state></data></rpc-reply>]]>]]>$"
 
+new "netconf get state subtree filter"
+expecteof "$clixon_netconf -qf $cfg" '<rpc><get><filter type="subtree"><interfaces-state><interface><name>eth0</name><if-index/></interface></interfaces-state></filter></get></rpc>]]>]]>' "^<rpc-reply><data><interfaces-state><interface><name>eth0</name><if-index>42</if-index></interface></interfaces-state></data></rpc-reply>]]>]]>$"
+
+new "netconf get state subtree filter no match"
+expecteof "$clixon_netconf -qf $cfg" '<rpc><get><filter type="subtree"><interfaces-state><interface><name>eth9</name></interface></interfaces-state></filter></get></rpc>]]>]]>' "^<rpc-reply><data/></rpc-reply>]]>]]>$"
+
+new "netconf input from file"
+echo "<rpc><discard-changes/></rpc>]]>]]><rpc><discard-changes/></rpc>]]>]]>" > $dir/rpc.xml
+expecteof_file "$clixon_netconf -qf $cfg" "$dir/rpc.xml" "^<rpc-reply><ok/></rpc-reply>]]>]]><rpc-reply><ok/></rpc-reply>]]>]]>$"
+
 new "netconf lock/unlock"
 expecteof "$clixon_netconf -qf $cfg" "<rpc><lock><target><candidate/></target></lock></rpc>]]>]]><rpc><unlock><target><candidate/></target></unlock></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]><rpc-reply><ok/></rpc-reply>]]>]]>$"
 
@@ -77,6 +77,20 @@ module example{
         type string;
       }   
     }
+    leaf-list y4 {
+      ordered-by system;
+      type int32;
+    }
+    list y5 {
+      ordered-by system;
+      key "k";
+      leaf k {
+        type int32;
+      }
+      leaf a {
+        type string;
+      }
+    }
 }
 EOF
 
@@ -167,6 +181,27 @@ expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candi
 new "verify list user order (as entered)"
 expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/y2\"/></get-config></rpc>]]>]]>" "^<rpc-reply><data><y2><k>c</k><a>bar</a></y2><y2><k>b</k><a>foo</a></y2><y2><k>a</k><a>fie</a></y2></data></rpc-reply>]]>]]>$"
 
+# NUMERIC
+
+new "add numeric entries to leaf-list system order"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><y4>10</y4><y4>9</y4><y4>-1</y4><y4>100</y4></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "verify numeric leaf-list sorted by value, not as strings"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/y4\"/></get-config></rpc>]]>]]>" "^<rpc-reply><data><y4>-1</y4><y4>9</y4><y4>10</y4><y4>100</y4></data></rpc-reply>]]>]]>$"
+
+new "add numeric list entries with an invalid key (not validated)"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><y5><k>10</k><a>ten</a></y5><y5><k>1a</k><a>bad</a></y5><y5><k>9</k><a>nine</a></y5></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "verify invalid key sorted after valid keys"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/y5\"/></get-config></rpc>]]>]]>" "^<rpc-reply><data><y5><k>9</k><a>nine</a></y5><y5><k>10</k><a>ten</a></y5><y5><k>1a</k><a>bad</a></y5></data></rpc-reply>]]>]]>$"
+
+new "find list entries by valid and invalid key"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/y5[k=9]/a\"/></get-config></rpc>]]>]]>" "^<rpc-reply><data><y5><k>9</k><a>nine</a></y5></data></rpc-reply>]]>]]>$"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/y5[k='1a']/a\"/></get-config></rpc>]]>]]>" "^<rpc-reply><data><y5><k>1a</k><a>bad</a></y5></data></rpc-reply>]]>]]>$"
+
+new "discard invalid entries"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><discard-changes/></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
 pid=`pgrep clixon_backend`
 if [ -z "$pid" ]; then
     err "backend already dead"
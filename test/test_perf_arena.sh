@@ -0,0 +1,96 @@
+#!/bin/bash
+# Allocator calls and time for parsing a large netconf message. The message
+# is parsed into an arena, see xml_new_arena(). The number of allocator
+# calls is reported by valgrind if it is installed.
+
+number=5000
+if [ $# = 0 ]; then
+    number=1000
+elif [ $# = 1 ]; then
+    number=$1
+else
+    echo "Usage: $0 [<number>]"
+    exit 1
+fi
+
+# include err() and new() functions and creates $dir
+. ./lib.sh
+
+cfg=$dir/scaling-conf.xml
+fyang=$dir/scaling.yang
+fconfig=$dir/config
+
+cat <<EOF > $fyang
+module ietf-ip{
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type string;
+      }
+      leaf b {
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<config>
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$fyang</CLICON_YANG_DIR>
+  <CLICON_YANG_MODULE_MAIN>ietf-ip</CLICON_YANG_MODULE_MAIN>
+  <CLICON_SOCK>/usr/local/var/routing/routing.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/routing/routing.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/routing</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PLUGIN>/usr/local/lib/xmldb/text.so</CLICON_XMLDB_PLUGIN>
+</config>
+EOF
+
+# kill old backend (if any)
+new "kill old backend"
+sudo clixon_backend -zf $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "start backend -s init -f $cfg -y $fyang"
+sudo clixon_backend -s init -f $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "generate config with $number list entries"
+echo -n "<rpc><edit-config><target><candidate/></target><config><x>" > $fconfig
+for (( i=0; i<$number; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $fconfig
+done
+echo "</x></config></edit-config></rpc>]]>]]>" >> $fconfig
+
+new "netconf write config with $number list entries"
+expecteof_file "time -f %e $clixon_netconf -qf $cfg -y $fyang" "$fconfig" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+if [ -n "$(type -p valgrind)" ]; then
+    new "netconf allocator calls of config with $number list entries"
+    valgrind $clixon_netconf -qf $cfg -y $fyang < $fconfig 2>&1 >/dev/null | grep "total heap usage"
+    if [ $? -ne 0 ]; then
+	err "total heap usage"
+    fi
+fi
+
+rm $fconfig
+
+new "Kill backend"
+# Check if still alive
+pid=`pgrep clixon_backend`
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err "kill backend"
+fi
+
+rm -rf $dir
@@ -0,0 +1,125 @@
+#!/bin/bash
+# Scaling test of leafref validation: <number> references to <number> interfaces
+
+number=5000
+if [ $# = 0 ]; then
+    number=1000
+elif [ $# = 1 ]; then
+    number=$1
+else
+    echo "Usage: $0 [<number>]"
+    exit 1
+fi
+
+# include err() and new() functions and creates $dir
+. ./lib.sh
+
+cfg=$dir/scaling-conf.xml
+fyang=$dir/scaling.yang
+fconfig=$dir/config
+
+cat <<EOF > $fyang
+module scaling{
+   container x {
+    list interface {
+      key "name";
+      leaf name {
+        type string;
+      }
+    }
+    list ref {
+      key "a";
+      leaf a {
+        type string;
+      }
+      leaf absif {
+        type leafref {
+          path "/x/interface/name";
+        }
+      }
+      leaf relif {
+        type leafref {
+          path "../../interface/name";
+        }
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<config>
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$fyang</CLICON_YANG_DIR>
+  <CLICON_YANG_MODULE_MAIN>scaling</CLICON_YANG_MODULE_MAIN>
+  <CLICON_SOCK>/usr/local/var/routing/routing.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/routing/routing.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/routing</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PLUGIN>/usr/local/lib/xmldb/text.so</CLICON_XMLDB_PLUGIN>
+</config>
+EOF
+
+# kill old backend (if any)
+new "kill old backend"
+sudo clixon_backend -zf $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "start backend  -s init -f $cfg -y $fyang"
+# start new backend
+sudo clixon_backend -s init -f $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "generate config with $number interfaces and $number references"
+echo -n "<rpc><edit-config><target><candidate/></target><config><x>" > $fconfig
+for (( i=0; i<$number; i++ )); do  
+    echo -n "<interface><name>eth$i</name></interface>" >> $fconfig
+done
+for (( i=0; i<$number; i++ )); do  
+    j=$(( ($i * 7) % $number ))
+    echo -n "<ref><a>$i</a><absif>eth$j</absif><relif>eth$i</relif></ref>" >> $fconfig
+done
+echo "</x></config></edit-config></rpc>]]>]]>" >> $fconfig
+
+new "netconf write leafref config"
+expecteof_file "time -f %e $clixon_netconf -qf $cfg -y $fyang" "$fconfig" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+rm $fconfig
+
+new "netconf validate leafref config"
+expecteof "time -f %e $clixon_netconf -qf $cfg -y $fyang" "<rpc><validate><source><candidate/></source></validate></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf commit leafref config"
+expecteof "time -f %e $clixon_netconf -qf $cfg -y $fyang" "<rpc><commit><source><candidate/></source></commit></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf delete referenced interface"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><x><interface operation=\"delete\"><name>eth0</name></interface></x></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf validate dangling leafref"
+expecteof "time -f %e $clixon_netconf -qf $cfg -y $fyang" "<rpc><validate><source><candidate/></source></validate></rpc>]]>]]>" "^<rpc-reply><rpc-error>"
+
+new "netconf discard-changes"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><discard-changes/></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf change one reference"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><x><ref><a>0</a><absif>eth1</absif></ref></x></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf commit one changed reference"
+expecteof "time -f %e $clixon_netconf -qf $cfg -y $fyang" "<rpc><commit><source><candidate/></source></commit></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "Kill backend"
+# Check if still alive
+pid=`pgrep clixon_backend`
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err "kill backend"
+fi
+
+rm -rf $dir
@@ -0,0 +1,94 @@
+#!/bin/bash
+# Requests per second to the backend: <requests> get-config rpcs in one
+# netconf session, which sends them on its backend session
+
+req=1000
+if [ $# = 0 ]; then
+    req=1000
+elif [ $# = 1 ]; then
+    req=$1
+else
+    echo "Usage: $0 [<requests>]"
+    exit 1
+fi
+
+# include err() and new() functions and creates $dir
+. ./lib.sh
+
+cfg=$dir/scaling-conf.xml
+fyang=$dir/scaling.yang
+fconfig=$dir/config
+
+cat <<EOF > $fyang
+module ietf-ip{
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type string;
+      }
+      leaf b {
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<config>
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$fyang</CLICON_YANG_DIR>
+  <CLICON_YANG_MODULE_MAIN>ietf-ip</CLICON_YANG_MODULE_MAIN>
+  <CLICON_SOCK>/usr/local/var/routing/routing.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/routing/routing.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/routing</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PLUGIN>/usr/local/lib/xmldb/text.so</CLICON_XMLDB_PLUGIN>
+</config>
+EOF
+
+# kill old backend (if any)
+new "kill old backend"
+sudo clixon_backend -zf $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "start backend -s init -f $cfg -y $fyang"
+sudo clixon_backend -s init -f $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "netconf add small config"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><x><y><a>0</a><b>0</b></y></x></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "generate $req get-config rpcs"
+for (( i=0; i<$req; i++ )); do
+    echo "<rpc><get-config><source><candidate/></source></get-config></rpc>]]>]]>"
+done > $fconfig
+
+new "netconf $req get-config rpcs in one session"
+t0=$(date +%s.%N)
+n=$($clixon_netconf -qf $cfg -y $fyang < $fconfig | grep -o "<rpc-reply" | wc -l)
+t1=$(date +%s.%N)
+if [ $n -ne $req ]; then
+    err "$req replies" "$n replies"
+fi
+echo "$req $t0 $t1" | awk '{printf "%d requests %.3fs %.0f requests/s\n", $1, $3-$2, $1/($3-$2)}'
+
+rm $fconfig
+
+new "Kill backend"
+# Check if still alive
+pid=`pgrep clixon_backend`
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err "kill backend"
+fi
+
+rm -rf $dir
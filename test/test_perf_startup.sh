@@ -0,0 +1,79 @@
+#!/bin/bash
+# Startup test of a large running_db: time for the backend to read, parse
+# and commit the datastore file, in MB/s of the file
+
+number=5000
+if [ $# = 0 ]; then
+    number=1000
+elif [ $# = 1 ]; then
+    number=$1
+else
+    echo "Usage: $0 [<number>]"
+    exit 1
+fi
+
+# include err() and new() functions and creates $dir
+. ./lib.sh
+
+cfg=$dir/scaling-conf.xml
+fyang=$dir/scaling.yang
+
+cat <<EOF > $fyang
+module ietf-ip{
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type string;
+      }
+      leaf b {
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<config>
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$fyang</CLICON_YANG_DIR>
+  <CLICON_YANG_MODULE_MAIN>ietf-ip</CLICON_YANG_MODULE_MAIN>
+  <CLICON_SOCK>/usr/local/var/routing/routing.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/routing/routing.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PLUGIN>/usr/local/lib/xmldb/text.so</CLICON_XMLDB_PLUGIN>
+</config>
+EOF
+
+# kill old backend (if any)
+new "kill old backend"
+sudo clixon_backend -zf $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "generate running_db with $number list entries"
+echo -n "<config><x>" > $dir/running_db
+for (( i=0; i<$number; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $dir/running_db
+done
+echo "</x></config>" >> $dir/running_db
+size=$(stat -c %s $dir/running_db)
+
+new "read running_db"
+t0=$(date +%s.%N)
+cat $dir/running_db > /dev/null
+t1=$(date +%s.%N)
+echo "$size $t0 $t1" | awk '{printf "read:    %d bytes %.3fs %.1f MB/s\n", $1, $3-$2, $1/($3-$2)/1000000}'
+
+new "backend startup from running_db"
+t0=$(date +%s.%N)
+sudo clixon_backend -1 -s running -f $cfg -y $fyang
+if [ $? -ne 0 ]; then
+    err
+fi
+t1=$(date +%s.%N)
+echo "$size $t0 $t1" | awk '{printf "startup: %d bytes %.3fs %.1f MB/s\n", $1, $3-$2, $1/($3-$2)/1000000}'
+
+sudo rm -rf $dir
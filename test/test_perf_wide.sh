@@ -0,0 +1,77 @@
+#!/bin/bash
+# Scaling test of wide xml nodes: a container with <number> leafs, each
+# with a default value. Adding defaults looks up each leaf among all
+# children of the container, see xml_default() and xml_find().
+# Example: test_perf_wide.sh 1000 10000 100000
+
+sizes=1000
+if [ $# -gt 0 ]; then
+    sizes=$*
+fi
+
+# include err() and new() functions and creates $dir
+. ./lib.sh
+
+cfg=$dir/scaling-conf.xml
+fyang=$dir/scaling.yang
+fconfig=$dir/config
+
+cat <<EOF > $cfg
+<config>
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$fyang</CLICON_YANG_DIR>
+  <CLICON_YANG_MODULE_MAIN>scaling</CLICON_YANG_MODULE_MAIN>
+  <CLICON_SOCK>/usr/local/var/routing/routing.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/routing/routing.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/routing</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PLUGIN>/usr/local/lib/xmldb/text.so</CLICON_XMLDB_PLUGIN>
+</config>
+EOF
+
+for number in $sizes; do
+    new "generate yang with $number leafs"
+    echo "module scaling{" > $fyang
+    echo "  container x {" >> $fyang
+    for (( i=0; i<$number; i++ )); do
+	echo "    leaf y$i { type string; default \"0\"; }" >> $fyang
+    done
+    echo "  }" >> $fyang
+    echo "}" >> $fyang
+
+    # kill old backend (if any)
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg -y $fyang
+    if [ $? -ne 0 ]; then
+	err
+    fi
+
+    new "start backend -s init -f $cfg -y $fyang"
+    sudo clixon_backend -s init -f $cfg -y $fyang
+    if [ $? -ne 0 ]; then
+	err
+    fi
+
+    new "generate config with $number leafs"
+    echo -n "<rpc><edit-config><target><candidate/></target><config><x>" > $fconfig
+    for (( i=0; i<$number; i++ )); do
+	echo -n "<y$i>$i</y$i>" >> $fconfig
+    done
+    echo "</x></config></edit-config></rpc>]]>]]>" >> $fconfig
+
+    new "netconf write config with $number leafs"
+    expecteof_file "time -f %e $clixon_netconf -qf $cfg -y $fyang" "$fconfig" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+    new "netconf get config with $number leafs"
+    expecteof "time -f %e $clixon_netconf -qf $cfg -y $fyang" "<rpc><get-config><source><candidate/></source></get-config></rpc>]]>]]>" "^<rpc-reply><data><x><y0>0</y0><y1>1</y1>"
+
+    new "netconf commit config with $number leafs"
+    expecteof "time -f %e $clixon_netconf -qf $cfg -y $fyang" "<rpc><commit><source><candidate/></source></commit></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+    new "Kill backend"
+    sudo clixon_backend -zf $cfg -y $fyang
+    if [ $? -ne 0 ]; then
+	err "kill backend"
+    fi
+done
+
+rm -rf $dir
@@ -85,6 +85,13 @@ new "restconf head"
 expectfn "curl -s -I http://localhost/restconf/data" "HTTP/1.1 200 OK"
 #Content-Type: application/yang-data+json"
 
+new "restconf head etag"
+expectfn "curl -s -I http://localhost/restconf/data" 'ETag: "'
+
+new "restconf get not modified with etag"
+etag=$(curl -s -I http://localhost/restconf/data | grep ETag | cut -d' ' -f2 | tr -d '\r')
+expectfn "curl -s -I -H If-None-Match:$etag http://localhost/restconf/data" "HTTP/1.1 304 Not Modified"
+
 new "restconf root discovery"
 expectfn "curl  -s -X GET http://localhost/.well-known/host-meta" "<Link rel='restconf' href='/restconf'/>"
 
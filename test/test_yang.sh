@@ -66,6 +66,28 @@ module example{
       description "testing of anyxml";
     }
   }
+  container ch {
+    description "Data nodes in a choice are siblings of the other children";
+    leaf a {
+      type int32 {
+        range "1..10";
+      }
+    }
+    choice c {
+      case c1 {
+        container b {
+          leaf e {
+            type string;
+          }
+        }
+      }
+      case c2 {
+        leaf q {
+          type string;
+        }
+      }
+    }
+  }
   container state {
     config false;
     leaf-list op {
@@ -137,6 +159,33 @@ expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candi
 new "netconf validate anyxml"
 expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><validate><source><candidate/></source></validate></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
 
+new "netconf discard-changes"
+expecteof "$clixon_netconf -qf $cfg" "<rpc><discard-changes/></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf edit choice"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><ch><b><e>x</e></b></ch></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf commit choice"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><commit/></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf replace choice with out of range leaf"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><ch><b operation=\"delete\"/><a>42</a></ch></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf validate out of range leaf (should fail)"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><validate><source><candidate/></source></validate></rpc>]]>]]>" "^<rpc-reply><rpc-error>"
+
+new "netconf edit leaf in range"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><edit-config><target><candidate/></target><config><ch><a>4</a></ch></config></edit-config></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf validate leaf in range"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><validate><source><candidate/></source></validate></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf commit leaf in range"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><commit/></rpc>]]>]]>" "^<rpc-reply><ok/></rpc-reply>]]>]]>$"
+
+new "netconf get choice replaced"
+expecteof "$clixon_netconf -qf $cfg -y $fyang" "<rpc><get-config><source><running/></source><filter type=\"xpath\" select=\"/ch\"/></get-config></rpc>]]>]]>" "^<rpc-reply><data><ch><a>4</a></ch></data></rpc-reply>]]>]]>$"
+
 # Check if still alive
 pid=`pgrep clixon_backend`
 if [ -z "$pid" ]; then